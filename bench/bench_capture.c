@@ -0,0 +1,198 @@
+#define _GNU_SOURCE
+#include "capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+
+// Escalado del backend TPACKET_V3 con PACKET_FANOUT: se inyectan tramas UDP por un
+// extremo de un par veth y se captura en el otro con 1, 2, 4 y 8 hilos.
+// Uso: bench_capture [bloques_totales]
+
+#define VETH_TX "nxbench0"
+#define VETH_RX "nxbench1"
+#define DURATION_SECONDS 2
+#define FLOWS 256               // puertos de origen distintos para repartir por hash
+#define FRAME_SIZE 106          // Ethernet + IPv4 + UDP + 64 bytes de carga
+#define BATCH 64
+
+static volatile int sending = 1;
+static uint64_t sent_packets = 0;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint16_t ip_checksum(const uint8_t* header, int length) {
+    uint32_t sum = 0;
+    for (int i = 0; i < length; i += 2) {
+        sum += (header[i] << 8) | header[i + 1];
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+// Trama Ethernet/IPv4/UDP 10.77.0.1:sport -> 10.77.0.2:9
+static void build_frame(uint8_t* frame, uint16_t sport) {
+    memset(frame, 0, FRAME_SIZE);
+    memset(frame, 0xff, 6);
+    frame[6] = 0x02;
+    frame[11] = 0x01;
+    frame[12] = 0x08;
+
+    uint8_t* ip = frame + 14;
+    uint16_t ip_length = FRAME_SIZE - 14;
+    ip[0] = 0x45;
+    ip[2] = ip_length >> 8;
+    ip[3] = ip_length & 0xff;
+    ip[8] = 64;
+    ip[9] = 17;
+    uint8_t src[4] = {10, 77, 0, 1}, dst[4] = {10, 77, 0, 2};
+    memcpy(ip + 12, src, 4);
+    memcpy(ip + 16, dst, 4);
+    uint16_t checksum = ip_checksum(ip, 20);
+    ip[10] = checksum >> 8;
+    ip[11] = checksum & 0xff;
+
+    uint8_t* udp = ip + 20;
+    uint16_t udp_length = ip_length - 20;
+    udp[0] = sport >> 8;
+    udp[1] = sport & 0xff;
+    udp[3] = 9;
+    udp[4] = udp_length >> 8;
+    udp[5] = udp_length & 0xff;
+}
+
+// Inyectar tramas por el extremo emisor en lotes con sendmmsg
+static void* sender_main(void* arg) {
+    int fd = *(int*)arg;
+    static uint8_t frames[FLOWS][FRAME_SIZE];
+    struct iovec iov[BATCH];
+    struct mmsghdr msgs[BATCH];
+
+    for (int i = 0; i < FLOWS; i++) {
+        build_frame(frames[i], (uint16_t)(20000 + i));
+    }
+    memset(msgs, 0, sizeof(msgs));
+
+    int next = 0;
+    while (sending) {
+        for (int i = 0; i < BATCH; i++) {
+            iov[i].iov_base = frames[next];
+            iov[i].iov_len = FRAME_SIZE;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            next = (next + 1) % FLOWS;
+        }
+        int result = sendmmsg(fd, msgs, BATCH, 0);
+        if (result > 0) {
+            __atomic_fetch_add(&sent_packets, result, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+static int open_sender(void) {
+    int fd = socket(AF_PACKET, SOCK_RAW, 0);   // protocolo 0: solo envía, no recibe
+    if (fd < 0) return -1;
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_ifindex = (int)if_nametoindex(VETH_TX);
+    if (addr.sll_ifindex == 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void run(int threads, int blocks, int sender) {
+    CaptureConfig config;
+    Capture cap;
+
+    capture_default_config(&config);
+    config.backend = CAPTURE_BACKEND_RING;
+    config.threads = threads;
+    config.block_count = blocks;
+
+    if (capture_start(&cap, VETH_RX, &config) < 0) {
+        printf("%-8d omitido: %s\n", threads, cap.error);
+        return;
+    }
+
+    sending = 1;
+    sent_packets = 0;
+    pthread_t thread;
+    pthread_create(&thread, NULL, sender_main, &sender);
+
+    double start = now_seconds();
+    int max_used = 0;
+    CaptureStats stats;
+    while (now_seconds() - start < DURATION_SECONDS) {
+        usleep(250000);
+        capture_update(&cap, NULL, 0);
+        capture_get_stats(&cap, &stats);
+        if (stats.ring_blocks_used > max_used) {
+            max_used = stats.ring_blocks_used;
+        }
+    }
+
+    sending = 0;
+    pthread_join(thread, NULL);
+    double elapsed = now_seconds() - start;
+    usleep(2 * config.block_timeout_ms * 1000);   // dejar que el kernel retire los últimos bloques
+    capture_update(&cap, NULL, 0);
+    capture_get_stats(&cap, &stats);
+    capture_stop(&cap);
+
+    printf("%-8d %12.0f %12.0f %10lu %8lu %6d/%-4d\n", threads,
+           sent_packets / elapsed, stats.packets / elapsed,
+           stats.kernel_drops, stats.ring_freezes, max_used, stats.ring_blocks_total);
+}
+
+int main(int argc, char** argv) {
+    int blocks = argc > 1 ? atoi(argv[1]) : CAPTURE_RING_BLOCK_COUNT;
+    int thread_counts[] = {1, 2, 4, 8};
+
+    printf("Escalado de captura TPACKET_V3 + PACKET_FANOUT (%s -> %s, %d flujos, %d bloques de %d KB)\n",
+           VETH_TX, VETH_RX, FLOWS, blocks, CAPTURE_RING_BLOCK_SIZE / 1024);
+    printf("CPUs en línea: %ld\n\n", sysconf(_SC_NPROCESSORS_ONLN));
+
+    if (system("ip link add " VETH_TX " type veth peer name " VETH_RX " 2>/dev/null && "
+               "ip link set " VETH_TX " up && ip link set " VETH_RX " up") != 0) {
+        // Sin CAP_NET_ADMIN no hay par veth que medir; no es un fallo del benchmark
+        printf("omitido: no se pudo crear el par veth\n");
+        return 0;
+    }
+
+    int sender = open_sender();
+    if (sender < 0) {
+        printf("omitido: no se pudo abrir el socket emisor\n");
+        system("ip link del " VETH_TX);
+        return 0;
+    }
+
+    printf("%-8s %12s %12s %10s %8s %11s\n", "Hilos", "Enviados/s", "Capturados/s", "Descartes", "Congel.", "Ocup. máx");
+    printf("-----------------------------------------------------------------\n");
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        run(thread_counts[i], blocks, sender);
+    }
+
+    close(sender);
+    if (system("ip link del " VETH_TX) != 0) {
+        printf("aviso: no se pudo borrar %s\n", VETH_TX);
+    }
+    return 0;
+}
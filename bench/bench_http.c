@@ -0,0 +1,164 @@
+#define _GNU_SOURCE
+#include "probe.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Motor HTTP contra un servidor HTTP/1.1 local con keep-alive: N URLs sondeadas
+// durante varias rondas con un tope de peticiones en vuelo. El caché de conexiones
+// de curl_multi se comparte entre URLs del mismo servidor, así que las conexiones
+// nuevas deberían ser como mucho tantas como peticiones en vuelo, no una por petición.
+// Uso: bench_http [urls] [en_vuelo]
+
+#define PORT 20080
+#define ROUNDS 5
+#define MAX_CLIENTS 1024
+
+static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Type: text/plain\r\n\r\nok";
+
+static volatile int stopping;
+static int accepted;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Un hilo con poll: acepta, y responde a cada petición completa ("\r\n\r\n")
+static void* serve(void* arg) {
+    int listener = *(int*)arg;
+    struct pollfd fds[MAX_CLIENTS + 1];
+    int count = 1;
+    char buffer[4096];
+
+    fds[0].fd = listener;
+    fds[0].events = POLLIN;
+
+    while (!stopping) {
+        if (poll(fds, count, 50) <= 0) {
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            int fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+            if (fd >= 0 && count <= MAX_CLIENTS) {
+                fds[count].fd = fd;
+                fds[count].events = POLLIN;
+                fds[count].revents = 0;
+                count++;
+                accepted++;
+            } else if (fd >= 0) {
+                close(fd);
+            }
+        }
+        for (int i = 1; i < count; i++) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            ssize_t n = recv(fds[i].fd, buffer, sizeof(buffer) - 1, 0);
+            if (n <= 0) {
+                close(fds[i].fd);
+                fds[i--] = fds[--count];
+                continue;
+            }
+            buffer[n] = '\0';
+            // Los GET de libcurl caben en un solo segmento en loopback
+            for (char* p = buffer; (p = strstr(p, "\r\n\r\n")) != NULL; p += 4) {
+                if (send(fds[i].fd, response, sizeof(response) - 1, MSG_NOSIGNAL) < 0) {
+                    break;
+                }
+            }
+        }
+    }
+
+    for (int i = 1; i < count; i++) {
+        close(fds[i].fd);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    int url_count = argc > 1 ? atoi(argv[1]) : 64;
+    int parallel = argc > 2 ? atoi(argv[2]) : PROBE_HTTP_MAX_IN_FLIGHT;
+    char url[64];
+    ProbeConfig config;
+    HttpProbeEngine engine;
+
+    if (url_count < 1 || url_count > MAX_CLIENTS) {
+        url_count = 64;
+    }
+
+    int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(PORT),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 4096) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    pthread_t server;
+    pthread_create(&server, NULL, serve, &listener);
+
+    probe_default_config(&config);
+    config.rounds = ROUNDS;
+    config.interval_ms = 100;
+    config.timeout_ms = 2000;
+    config.max_in_flight = parallel;
+    if (http_probe_init(&engine, &config) < 0) {
+        fprintf(stderr, "%s\n", engine.error);
+        return 1;
+    }
+
+    // Rutas distintas sobre el mismo servidor
+    for (int i = 0; i < url_count; i++) {
+        snprintf(url, sizeof(url), "http://127.0.0.1:%d/%d", PORT, i);
+        http_probe_add(&engine, url);
+    }
+
+    double start = now_ns();
+    if (http_probe_run(&engine) < 0) {
+        fprintf(stderr, "%s\n", engine.error);
+    }
+    double elapsed = now_ns() - start;
+
+    uint64_t sent = 0, received = 0, failed = 0, connections = 0;
+    double phases[HTTP_PHASES] = {0};
+    for (int i = 0; i < engine.count; i++) {
+        const HttpTarget* target = &engine.targets[i];
+        sent += target->sent;
+        received += target->received;
+        failed += target->timeouts + target->errors;
+        connections += target->connections;
+        for (int phase = 0; phase < HTTP_PHASES; phase++) {
+            phases[phase] += target->total_ms[phase];
+        }
+    }
+
+    printf("Peticiones HTTP concurrentes: %d URLs, %d rondas cada %d ms, máximo %d en vuelo\n",
+           engine.count, ROUNDS, config.interval_ms, engine.config.max_in_flight);
+    printf("%-10s %-10s %-8s %-12s %-12s %s\n", "enviadas", "recibidas", "fallos",
+           "conexiones", "aceptadas", "peticiones/s");
+    printf("--------------------------------------------------------------------\n");
+    printf("%-10lu %-10lu %-8lu %-12lu %-12d %.0f\n", (unsigned long)sent, (unsigned long)received,
+           (unsigned long)failed, (unsigned long)connections, accepted, sent / (elapsed / 1e9));
+    printf("\nMedia por petición:");
+    for (int phase = 0; phase < HTTP_PHASES; phase++) {
+        printf("  %s %.3f ms", http_phase_name(phase), received ? phases[phase] / received : 0.0);
+    }
+    printf("\n");
+
+    http_probe_free(&engine);
+    stopping = 1;
+    pthread_join(server, NULL);
+    close(listener);
+    return 0;
+}
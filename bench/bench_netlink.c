@@ -0,0 +1,204 @@
+#define _GNU_SOURCE
+#include "netlink.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+
+// Benchmark del colector RTM_GETLINK frente al escaneo de /proc/net/dev por interfaz.
+// Los volcados sintéticos permiten medir 10, 1k y 10k interfaces sin crear veths reales.
+
+#define CHUNK_SIZE (32 * 1024)
+#define FIXTURE_PATH "/tmp/nlx_bench_net_dev"
+
+typedef struct {
+    char* data;
+    size_t length;
+} Chunk;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Añadir un atributo rtattr al final de un mensaje
+static void add_attr(struct nlmsghdr* nlh, int type, const void* data, int length) {
+    struct rtattr* rta = (struct rtattr*)((char*)nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+    rta->rta_type = type;
+    rta->rta_len = RTA_LENGTH(length);
+    memcpy(RTA_DATA(rta), data, length);
+    nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + RTA_ALIGN(rta->rta_len);
+}
+
+// Construir un volcado RTM_NEWLINK sintético partido en bloques como los del kernel
+static Chunk* build_dump(int interfaces, int* chunk_count) {
+    int capacity = interfaces / 64 + 2;
+    Chunk* chunks = calloc(capacity, sizeof(Chunk));
+    int current = 0;
+    chunks[0].data = calloc(1, CHUNK_SIZE);
+
+    for (int i = 0; i <= interfaces; i++) {
+        if (chunks[current].length + 512 > CHUNK_SIZE) {
+            current++;
+            chunks[current].data = calloc(1, CHUNK_SIZE);
+        }
+
+        struct nlmsghdr* nlh = (struct nlmsghdr*)(chunks[current].data + chunks[current].length);
+
+        if (i == interfaces) {
+            nlh->nlmsg_type = NLMSG_DONE;
+            nlh->nlmsg_len = NLMSG_LENGTH(sizeof(int));
+        } else {
+            nlh->nlmsg_type = RTM_NEWLINK;
+            nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+            struct ifinfomsg* ifm = NLMSG_DATA(nlh);
+            ifm->ifi_index = i + 1;
+
+            char name[MAX_INTERFACE_NAME];
+            snprintf(name, sizeof(name), "veth%d", i);
+            add_attr(nlh, IFLA_IFNAME, name, strlen(name) + 1);
+
+            struct rtnl_link_stats64 stats;
+            memset(&stats, 0, sizeof(stats));
+            stats.rx_bytes = 1000000ULL * i;
+            stats.tx_bytes = 500000ULL * i;
+            stats.rx_packets = 1000ULL * i;
+            stats.tx_packets = 500ULL * i;
+            add_attr(nlh, IFLA_STATS64, &stats, sizeof(stats));
+        }
+
+        chunks[current].length += NLMSG_ALIGN(nlh->nlmsg_len);
+    }
+
+    *chunk_count = current + 1;
+    return chunks;
+}
+
+// Generar un /proc/net/dev sintético con el mismo número de interfaces
+static void write_fixture(int interfaces) {
+    FILE* file = fopen(FIXTURE_PATH, "w");
+    if (!file) return;
+
+    fprintf(file, "Inter-|   Receive                                                |  Transmit\n");
+    fprintf(file, " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n");
+    for (int i = 0; i < interfaces; i++) {
+        fprintf(file, "veth%d: %d %d 0 0 0 0 0 0 %d %d 0 0 0 0 0 0\n",
+                i, 1000000 * (i % 1000), 1000 * i, 500000 * (i % 1000), 500 * i);
+    }
+    fclose(file);
+}
+
+// Ruta anterior: abrir y escanear el fichero completo para una interfaz
+static uint64_t scan_fixture(const char* interface) {
+    FILE* file = fopen(FIXTURE_PATH, "r");
+    char line[512];
+    char name[64];
+    uint64_t rx_bytes = 0, rx_packets = 0, tx_bytes = 0, tx_packets = 0;
+
+    if (!file) return 0;
+
+    fgets(line, sizeof(line), file);
+    fgets(line, sizeof(line), file);
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%63s %lu %lu %*u %*u %*u %*u %*u %*u %lu %lu",
+                   name, &rx_bytes, &rx_packets, &tx_bytes, &tx_packets) >= 4) {
+            char* colon = strchr(name, ':');
+            if (colon) *colon = '\0';
+            if (strcmp(name, interface) == 0) break;
+        }
+    }
+
+    fclose(file);
+    return rx_bytes;
+}
+
+static void bench_size(int interfaces) {
+    int chunk_count;
+    Chunk* chunks = build_dump(interfaces, &chunk_count);
+    LinkStatsTable table;
+    link_stats_init(&table);
+
+    char (*names)[MAX_INTERFACE_NAME] = malloc(interfaces * sizeof(*names));
+    for (int i = 0; i < interfaces; i++) {
+        snprintf(names[i], MAX_INTERFACE_NAME, "veth%d", i);
+    }
+
+    // Muestra netlink: un volcado + una consulta por interfaz
+    int iterations = 2000000 / interfaces + 1;
+    uint64_t checksum = 0;
+    double start = now_ns();
+    for (int it = 0; it < iterations; it++) {
+        link_stats_begin(&table);
+        for (int c = 0; c < chunk_count; c++) {
+            link_stats_parse(&table, chunks[c].data, chunks[c].length);
+        }
+        link_stats_end(&table);
+        for (int i = 0; i < interfaces; i++) {
+            const NetworkStats* stats = link_stats_get(&table, link_stats_find(&table, names[i]));
+            if (stats) checksum += stats->rx_bytes;
+        }
+    }
+    double netlink_ns = (now_ns() - start) / iterations;
+
+    // Muestra procfs: un escaneo completo por interfaz (limitado y extrapolado)
+    write_fixture(interfaces);
+    int probes = interfaces < 100 ? interfaces : 100;
+    start = now_ns();
+    for (int i = 0; i < probes; i++) {
+        checksum += scan_fixture(names[(i * 7919) % interfaces]);
+    }
+    double procfs_ns = (now_ns() - start) / probes * interfaces;
+    unlink(FIXTURE_PATH);
+
+    printf("%-8d %16.1f %16.1f %10.1fx   (%lu)\n", interfaces, netlink_ns / 1000.0,
+           procfs_ns / 1000.0, procfs_ns / netlink_ns, (unsigned long)(checksum & 0xff));
+
+    for (int c = 0; c < chunk_count; c++) {
+        free(chunks[c].data);
+    }
+    free(chunks);
+    free(names);
+    link_stats_free(&table);
+}
+
+// Coste real de un volcado contra el kernel del host
+static void bench_live(void) {
+    int fd = nl_open(0);
+    LinkStatsTable table;
+
+    if (fd < 0 || link_stats_init(&table) < 0) {
+        printf("netlink no disponible\n");
+        return;
+    }
+
+    int iterations = 1000;
+    int count = 0;
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        count = link_stats_dump(&table, fd);
+    }
+    double elapsed = (now_ns() - start) / iterations;
+
+    printf("\nVolcado real del host: %d interfaces, %.1f us/muestra\n", count, elapsed / 1000.0);
+
+    link_stats_free(&table);
+    nl_close(fd);
+}
+
+int main(void) {
+    printf("Coste por muestra (todas las interfaces)\n");
+    printf("%-8s %16s %16s %11s\n", "ifaces", "netlink (us)", "procfs (us)", "mejora");
+    printf("--------------------------------------------------------------\n");
+
+    bench_size(10);
+    bench_size(1000);
+    bench_size(10000);
+
+    bench_live();
+    return 0;
+}
@@ -0,0 +1,117 @@
+#define _GNU_SOURCE
+#include "output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// Micro-benchmark de la salida de filas de conexiones: --format json/csv/binary
+// frente a la ruta printf de la tabla de texto, escribiendo en /dev/null
+
+#define ROWS 100000
+#define ROUNDS 10
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Conexiones sintéticas: tres de cada cuatro IPv4, la mitad con proceso
+static void fill_connections(Connection* rows) {
+    memset(rows, 0, ROWS * sizeof(Connection));
+    for (int i = 0; i < ROWS; i++) {
+        Connection* row = &rows[i];
+        row->family = i % 4 ? AF_INET : AF_INET6;
+        row->protocol = i % 5 ? IPPROTO_TCP : IPPROTO_UDP;
+        row->state = 1 + i % 11;
+        if (row->family == AF_INET) {
+            uint32_t local = htonl(0x0A000001 + i);
+            uint32_t remote = htonl(0xC0A80001 + i * 7);
+            memcpy(row->local_addr, &local, 4);
+            memcpy(row->remote_addr, &remote, 4);
+        } else {
+            row->local_addr[0] = 0x20;
+            row->local_addr[1] = 0x01;
+            memcpy(row->local_addr + 12, &i, sizeof(i));
+            row->remote_addr[0] = 0xfe;
+            row->remote_addr[1] = 0x80;
+            row->remote_addr[15] = (uint8_t)i;
+        }
+        row->local_port = 1024 + i % 60000;
+        row->remote_port = 443;
+        row->uid = 1000;
+        row->inode = 100000 + i;
+        if (i % 2) {
+            row->pid = 1000 + i % 300;
+            snprintf(row->process, sizeof(row->process), "worker-%d", i % 300);
+        }
+    }
+}
+
+// Ruta de la tabla de texto: una llamada a stdio por fila con printf y sus conversiones
+static long print_rows(FILE* file, const Connection* rows) {
+    long bytes = 0;
+    for (int i = 0; i < ROWS; i++) {
+        char local_ip[MAX_IP_ADDRESS];
+        char remote_ip[MAX_IP_ADDRESS];
+        bytes += fprintf(file, "%-5s %-39s %-6d %-39s %-6d %-12s %d/%s\n",
+                connection_protocol_name(&rows[i]),
+                format_ip_address(rows[i].family, rows[i].local_addr, local_ip, sizeof(local_ip)),
+                rows[i].local_port,
+                format_ip_address(rows[i].family, rows[i].remote_addr, remote_ip, sizeof(remote_ip)),
+                rows[i].remote_port, connection_state_name(rows[i].state), rows[i].pid, rows[i].process);
+    }
+    return bytes;
+}
+
+int main(void) {
+    static const char* names[] = { "text (printf)", "json", "csv", "binary" };
+    static Output output;
+    Connection* rows = malloc(ROWS * sizeof(Connection));
+    int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    FILE* file = fdopen(dup(fd), "w");
+
+    if (!rows || fd < 0 || !file) {
+        fprintf(stderr, "No se pudo preparar el benchmark\n");
+        return 1;
+    }
+    fill_connections(rows);
+
+    printf("Salida de %d conexiones a /dev/null (media de %d pasadas)\n", ROWS, ROUNDS);
+    printf("%-16s %10s %14s %12s %14s\n", "formato", "ns/fila", "filas/s", "bytes/fila", "writes/1k filas");
+    printf("------------------------------------------------------------------------\n");
+
+    long bytes = print_rows(file, rows);
+    double start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        print_rows(file, rows);
+    }
+    fflush(file);
+    double elapsed = (now_ns() - start) / ROUNDS;
+    printf("%-16s %10.1f %14.0f %12.1f %14s\n", names[0], elapsed / ROWS, ROWS / (elapsed / 1e9),
+           (double)bytes / ROWS, "-");
+
+    for (int format = OUTPUT_JSON; format <= OUTPUT_BINARY; format++) {
+        output_init(&output, fd, format);
+        start = now_ns();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = 0; i < ROWS; i++) {
+                output_connection(&output, &rows[i]);
+            }
+            output_flush(&output);
+        }
+        elapsed = (now_ns() - start) / ROUNDS;
+        printf("%-16s %10.1f %14.0f %12.1f %14.2f\n", names[format], elapsed / ROWS, ROWS / (elapsed / 1e9),
+               (double)output.bytes / ROUNDS / ROWS, (double)output.writes / ROUNDS / (ROWS / 1000.0));
+    }
+
+    fclose(file);
+    close(fd);
+    free(rows);
+    return 0;
+}
@@ -0,0 +1,149 @@
+#define _GNU_SOURCE
+#include "probe.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Motor de sondeos contra destinos locales: N oyentes TCP y N direcciones de
+// 127.0.0.0/8 para ICMP, todos sondeados a la vez desde un único bucle epoll. Con
+// privilegios se añade un espacio de red con netem como destino con retardo conocido.
+// Uso: bench_probe [destinos_por_tipo]
+
+#define BASE_PORT 20000
+#define ROUNDS 5
+#define NETNS "nxprobe"
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Oyente en 127.0.<i / 250>.<i % 250 + 2>:BASE_PORT
+static int open_listener(int index, char* spec, size_t size) {
+    char address[32];
+    snprintf(address, sizeof(address), "127.0.%d.%d", index / 250, index % 250 + 2);
+    snprintf(spec, size, "%s:%d", address, BASE_PORT);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(BASE_PORT) };
+    inet_pton(AF_INET, address, &addr.sin_addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4096) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void report(const char* label, const ProbeEngine* engine, int first, int count, double elapsed_ns) {
+    uint64_t sent = 0, received = 0, timeouts = 0, errors = 0;
+    double total = 0.0, min = 0.0, max = 0.0;
+
+    for (int i = first; i < first + count; i++) {
+        const ProbeTarget* target = &engine->targets[i];
+        sent += target->sent;
+        received += target->received;
+        timeouts += target->timeouts;
+        errors += target->errors;
+        total += target->total_ms;
+        if (target->received > 0 && (min == 0.0 || target->min_ms < min)) min = target->min_ms;
+        if (target->max_ms > max) max = target->max_ms;
+    }
+
+    printf("%-22s %8lu %8lu %8lu %8lu %9.3f %9.3f %9.3f %10.0f\n", label,
+           (unsigned long)sent, (unsigned long)received, (unsigned long)timeouts, (unsigned long)errors,
+           min, received ? total / received : 0.0, max, sent / (elapsed_ns / 1e9));
+}
+
+// Destino en otro espacio de red a través de un veth. Devuelve 1 si además se pudo
+// añadir un retardo conocido con netem, 0 sin retardo y -1 si no hay espacio de red
+static int setup_netns(void) {
+    if (system("ip netns add " NETNS " 2>/dev/null && "
+               "ip link add nxprobe0 type veth peer name nxprobe1 netns " NETNS " && "
+               "ip addr add 10.78.0.1/24 dev nxprobe0 && ip link set nxprobe0 up && "
+               "ip -n " NETNS " addr add 10.78.0.2/24 dev nxprobe1 && "
+               "ip -n " NETNS " link set nxprobe1 up && ip -n " NETNS " link set lo up") != 0) {
+        return -1;
+    }
+    return system("tc qdisc add dev nxprobe0 root netem delay 5ms 2>/dev/null") == 0 ? 1 : 0;
+}
+
+static void teardown_netns(void) {
+    int ignored = system("ip link del nxprobe0 2>/dev/null; ip netns del " NETNS " 2>/dev/null");
+    (void)ignored;
+}
+
+int main(int argc, char* argv[]) {
+    int per_type = argc > 1 ? atoi(argv[1]) : 256;
+    char spec[64];
+    ProbeConfig config;
+    ProbeEngine engine;
+
+    if (per_type < 1 || per_type > PROBE_MAX_TARGETS / 2) {
+        per_type = 256;
+    }
+
+    int* listeners = malloc(per_type * sizeof(int));
+    for (int i = 0; i < per_type; i++) {
+        listeners[i] = open_listener(i, spec, sizeof(spec));
+    }
+
+    probe_default_config(&config);
+    config.rounds = ROUNDS;
+    config.interval_ms = 100;
+    config.timeout_ms = 500;
+    if (probe_engine_init(&engine, &config) < 0) {
+        fprintf(stderr, "%s\n", probe_engine_error(&engine));
+        return 1;
+    }
+
+    // Primero los TCP y después los ICMP, para poder resumirlos por separado
+    for (int i = 0; i < per_type; i++) {
+        snprintf(spec, sizeof(spec), "127.0.%d.%d:%d", i / 250, i % 250 + 2, BASE_PORT);
+        probe_engine_add(&engine, spec);
+    }
+    for (int i = 0; i < per_type; i++) {
+        snprintf(spec, sizeof(spec), "127.1.%d.%d", i / 250, i % 250 + 2);
+        probe_engine_add(&engine, spec);
+    }
+
+    int netns = setup_netns();
+    if (netns >= 0) {
+        probe_engine_add(&engine, "10.78.0.2");
+    } else {
+        teardown_netns();
+    }
+
+    double start = now_ns();
+    probe_engine_run(&engine);
+    double elapsed = now_ns() - start;
+
+    printf("Sondeos concurrentes: %d TCP + %d ICMP, %d rondas cada %d ms\n",
+           per_type, per_type, ROUNDS, config.interval_ms);
+    printf("%-22s %8s %8s %8s %8s %9s %9s %9s %10s\n", "destinos", "enviados", "recibidos",
+           "timeouts", "errores", "min ms", "media ms", "max ms", "sondeos/s");
+    printf("-------------------------------------------------------------------------------------------------\n");
+    report("TCP 127.0.0.0/8", &engine, 0, per_type, elapsed);
+    report("ICMP 127.0.0.0/8", &engine, per_type, per_type, elapsed);
+    if (netns >= 0) {
+        report(netns ? "ICMP netns (netem 5ms)" : "ICMP netns", &engine, 2 * per_type, 1, elapsed);
+        teardown_netns();
+    } else {
+        printf("(sin espacio de red: hace falta CAP_NET_ADMIN)\n");
+    }
+
+    probe_engine_free(&engine);
+    for (int i = 0; i < per_type; i++) {
+        if (listeners[i] >= 0) close(listeners[i]);
+    }
+    free(listeners);
+    return 0;
+}
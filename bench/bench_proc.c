@@ -0,0 +1,471 @@
+#define _GNU_SOURCE
+#include "collector.h"
+#include "procnet.h"
+#include "ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+// Suite de benchmarks de la recolección sobre un /proc sintético (NX_PROC_ROOT):
+// read_interface_stats(), collect_connections(), get_connection_count(),
+// get_active_processes() y un fotograma de la TUI, con /proc/net/dev y /proc/net/tcp
+// de 10 a 1M filas. Por operación: ns, reservas de memoria (malloc/calloc/realloc
+// interpuestos en este ejecutable) y llamadas al sistema (ptrace de un hijo, contando
+// entre dos llamadas marca). Cada tamaño se mide en procesos nuevos, así que las cachés
+// (fds del registro, índice de sockets) solo duran lo que dura una medida.
+// Uso: bench_proc [filas máximas]   |   bench_proc --check (tamaños pequeños, valida)
+
+#define FIXTURE_DIR "/tmp/nlx_bench_proc"
+#define MAX_ROWS 1000000
+#define MAX_PIDS 100000             // directorios de proceso del fixture (pid_max típico)
+#define CHECK_ROWS 1000
+#define MIN_TIME_NS 200e6           // tiempo mínimo de medida por operación
+#define CHECK_TIME_NS 5e6
+#define SYSCALL_ROUNDS 3            // repeticiones contadas bajo ptrace
+#define MARKER SYS_getppid          // llamada que delimita la zona contada
+
+// ============================================================================
+// RESERVAS DE MEMORIA
+// ============================================================================
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* pointer, size_t size);
+extern void __libc_free(void* pointer);
+
+static uint64_t allocations = 0;
+
+void* malloc(size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+    __libc_free(pointer);
+}
+
+// ============================================================================
+// FIXTURES
+// ============================================================================
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int write_file(const char* root, const char* name, const char* header, int rows,
+                      void (*row)(FILE* file, int i)) {
+    char path[PROC_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/proc/net/%s", root, name);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return -1;
+    }
+    fputs(header, file);
+    for (int i = 0; i < rows; i++) {
+        row(file, i);
+    }
+    return fclose(file);
+}
+
+static void dev_row(FILE* file, int i) {
+    fprintf(file, "%7s%d: %llu %d 0 0 0 0 0 0 %llu %d 0 0 0 0 0 0\n", "n", i,
+            1000ULL * i + 7, i, 2000ULL * i + 9, 2 * i);
+}
+
+static void tcp_row(FILE* file, int i) {
+    fprintf(file, "%4d: %08X:%04X %08X:%04X %02X 00000000:00000000 00:00000000 00000000  1000        0 %d 1 0000000000000000 20 4 0 10 -1\n",
+            i, 0x0100000A + (i << 8), 1024 + i % 60000, 0x0100A8C0 + (i << 8), 443, 1 + i % 11, 100000 + i);
+}
+
+static const char* DEV_HEADER =
+    "Inter-|   Receive                                                |  Transmit\n"
+    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n";
+static const char* TCP_HEADER =
+    "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n";
+static const char* TCP6_HEADER =
+    "  sl  local_address                         remote_address                        st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n";
+
+// /proc/net/{dev,tcp} con rows filas (tcp6, udp y udp6 solo con cabecera) y hasta
+// MAX_PIDS directorios de proceso sin fds
+static int make_fixture(const char* root, int rows, int pids) {
+    char path[PROC_PATH_MAX];
+    if (mkdir(root, 0755) < 0 && errno != EEXIST) return -1;
+    snprintf(path, sizeof(path), "%s/proc", root);
+    if (mkdir(path, 0755) < 0 && errno != EEXIST) return -1;
+    snprintf(path, sizeof(path), "%s/proc/net", root);
+    if (mkdir(path, 0755) < 0 && errno != EEXIST) return -1;
+
+    if (write_file(root, "dev", DEV_HEADER, rows, dev_row) < 0 ||
+        write_file(root, "tcp", TCP_HEADER, rows, tcp_row) < 0 ||
+        write_file(root, "tcp6", TCP6_HEADER, 0, NULL) < 0 ||
+        write_file(root, "udp", TCP_HEADER, 0, NULL) < 0 ||
+        write_file(root, "udp6", TCP6_HEADER, 0, NULL) < 0) {
+        return -1;
+    }
+
+    for (int pid = 1; pid <= pids; pid++) {
+        snprintf(path, sizeof(path), "%s/proc/%d", root, pid);
+        if (mkdir(path, 0755) < 0 && errno != EEXIST) return -1;
+    }
+    return 0;
+}
+
+static void remove_fixture(const char* root) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execlp("rm", "rm", "-rf", root, (char*)NULL);
+        _exit(127);
+    }
+    if (pid > 0) {
+        waitpid(pid, NULL, 0);
+    }
+}
+
+// ============================================================================
+// OPERACIONES
+// ============================================================================
+
+static char last_interface[MAX_INTERFACE_NAME];
+static Snapshot frames[2];
+static int frame = 0;
+
+static void op_interface_stats(void) {
+    read_interface_stats(last_interface);
+}
+
+static void op_collect_connections(void) {
+    int count;
+    free(collect_connections(&count));
+}
+
+static void op_connection_count(void) {
+    get_connection_count();
+}
+
+static void op_active_processes(void) {
+    get_active_processes();
+}
+
+// Fotograma con muestra nueva (alterna dos con valores distintos) y sin cambios
+static void op_frame_changed(void) {
+    frame ^= 1;
+    draw_frame(&frames[frame], 0);
+}
+
+static void op_frame_unchanged(void) {
+    draw_frame(&frames[frame], 0);
+}
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+} Operation;
+
+static const Operation operations[] = {
+    { "read_interface_stats", op_interface_stats },
+    { "collect_connections", op_collect_connections },
+    { "get_connection_count", op_connection_count },
+    { "get_active_processes", op_active_processes },
+    { "tui frame (cambios)", op_frame_changed },
+    { "tui frame (igual)", op_frame_unchanged },
+};
+#define OPERATIONS (int)(sizeof(operations) / sizeof(operations[0]))
+
+typedef struct {
+    double ns[OPERATIONS];
+    double allocs[OPERATIONS];
+    double syscalls[OPERATIONS];    // < 0 = no disponible
+    char error[256];
+} Result;
+
+// Muestra para la TUI con lo que leen las operaciones, como la publicaría el muestreo
+static void fill_frames(int rows) {
+    Snapshot* snapshot = &frames[0];
+    memset(frames, 0, sizeof(frames));
+    snapshot->sequence = 1;
+    snapshot->has_interface = 1;
+    snprintf(snapshot->interface, sizeof(snapshot->interface), "%s", last_interface);
+    snprintf(snapshot->interface_ip, sizeof(snapshot->interface_ip), "10.0.0.1");
+    snapshot->stats = read_interface_stats(last_interface);
+    snapshot->has_speeds = 1;
+
+    int count = 0;
+    Connection* connections = collect_connections(&count);
+    snapshot->connection_count = count < SAMPLER_MAX_CONNECTIONS ? count : SAMPLER_MAX_CONNECTIONS;
+    if (connections) {
+        memcpy(snapshot->connections, connections, snapshot->connection_count * sizeof(Connection));
+    }
+    free(connections);
+    snapshot->connection_total = count;
+    snapshot->tcp_connections = count;
+    snapshot->processes = get_active_processes();
+
+    int interfaces = rows < SAMPLER_MAX_INTERFACES ? rows : SAMPLER_MAX_INTERFACES;
+    for (int i = 0; i < interfaces; i++) {
+        snprintf(snapshot->interfaces[i], MAX_INTERFACE_NAME, "n%d", rows - interfaces + i);
+        snapshot->interface_active[i] = 1;
+    }
+    snapshot->interface_count = interfaces;
+    uint64_t now = monotonic_ns();
+    for (int i = 0; i < SAMPLE_SECTIONS; i++) {
+        snapshot->collected_ns[i] = now;
+    }
+
+    frames[1] = frames[0];
+    frames[1].sequence = 2;
+    frames[1].stats.rx_speed = 12.5;
+    frames[1].stats.tx_speed = 3.25;
+    frames[1].stats.total_speed = 15.75;
+    frames[1].connection_total = count + 1;
+    frames[1].processes = snapshot->processes + 1;
+}
+
+// Preparar la raíz y la TUI (sobre /dev/null, 46x120) y ejecutar cada operación una vez
+static void setup(const char* root, int rows) {
+    proc_set_root(root);
+    snprintf(last_interface, sizeof(last_interface), "n%d", rows - 1);
+    fill_frames(rows);
+
+    int null = open("/dev/null", O_RDWR | O_CLOEXEC);
+    if (null >= 0) {
+        dup2(null, STDIN_FILENO);
+        dup2(null, STDOUT_FILENO);
+        close(null);
+    }
+    setenv("TERM", "xterm", 1);
+    setenv("LINES", "46", 1);
+    setenv("COLUMNS", "120", 1);
+    init_ui();
+    draw_frame(&frames[frame], 1);
+
+    for (int i = 0; i < OPERATIONS; i++) {
+        operations[i].run();
+    }
+}
+
+// Las funciones devuelven 0 en vez de fallar: comprobar que leen lo que hay
+static int validate(int rows, int pids, char* error, size_t size) {
+    NetworkStats stats = read_interface_stats(last_interface);
+    int count = 0;
+    Connection* connections = collect_connections(&count);
+    int ports_ok = connections && count > 0 && connections[count - 1].remote_port == 443;
+    free(connections);
+    int connection_count = get_connection_count();
+    int processes = get_active_processes();
+
+    if (stats.rx_bytes != 1000ULL * (rows - 1) + 7 || stats.tx_bytes != 2000ULL * (rows - 1) + 9) {
+        snprintf(error, size, "read_interface_stats(%s): rx %llu tx %llu", last_interface,
+                 (unsigned long long)stats.rx_bytes, (unsigned long long)stats.tx_bytes);
+    } else if (count != rows || !ports_ok) {
+        snprintf(error, size, "collect_connections: %d conexiones de %d", count, rows);
+    } else if (connection_count != rows) {
+        snprintf(error, size, "get_connection_count: %d de %d", connection_count, rows);
+    } else if (processes != pids) {
+        snprintf(error, size, "get_active_processes: %d de %d", processes, pids);
+    } else {
+        return 0;
+    }
+    return -1;
+}
+
+// Hijo cronometrado: ns y reservas por operación
+static void measure(const char* root, int rows, int pids, double min_time_ns, Result* result) {
+    setup(root, rows);
+    if (validate(rows, pids, result->error, sizeof(result->error)) < 0) {
+        return;
+    }
+
+    for (int i = 0; i < OPERATIONS; i++) {
+        long rounds = 0;
+        uint64_t before = __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+        double start = now_ns();
+        double elapsed;
+        do {
+            operations[i].run();
+            rounds++;
+            elapsed = now_ns() - start;
+        } while (elapsed < min_time_ns);
+        result->ns[i] = elapsed / rounds;
+        result->allocs[i] = (double)(__atomic_load_n(&allocations, __ATOMIC_RELAXED) - before) / rounds;
+    }
+    cleanup_ui();
+}
+
+// Hijo trazado: SYSCALL_ROUNDS repeticiones de cada operación entre dos marcas
+static void traced(const char* root, int rows) {
+    if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) < 0) {
+        _exit(2);
+    }
+    raise(SIGSTOP);
+    setup(root, rows);
+    for (int i = 0; i < OPERATIONS; i++) {
+        syscall(MARKER);
+        for (int round = 0; round < SYSCALL_ROUNDS; round++) {
+            operations[i].run();
+        }
+        syscall(MARKER);
+    }
+    cleanup_ui();
+    _exit(0);
+}
+
+// Contar las entradas al kernel de todos los hilos del hijo entre cada par de marcas
+static int count_syscalls(const char* root, int rows, Result* result) {
+    pid_t child = fork();
+    if (child < 0) {
+        return -1;
+    }
+    if (child == 0) {
+        traced(root, rows);
+    }
+
+    int status;
+    if (waitpid(child, &status, 0) < 0 || !WIFSTOPPED(status) ||
+        ptrace(PTRACE_SETOPTIONS, child, NULL,
+               PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_EXITKILL) < 0) {
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+        return -1;
+    }
+    ptrace(PTRACE_SYSCALL, child, NULL, NULL);
+
+    int operation = 0;
+    int counting = 0;
+    long count = 0;
+    pid_t task;
+    while ((task = waitpid(-1, &status, __WALL)) > 0) {
+        if (!WIFSTOPPED(status)) {
+            if (task == child) break;
+            continue;
+        }
+
+        int signal = 0;
+        if (WSTOPSIG(status) == (SIGTRAP | 0x80)) {
+            struct __ptrace_syscall_info info;
+            if (ptrace(PTRACE_GET_SYSCALL_INFO, task, (void*)sizeof(info), &info) > 0 &&
+                info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+                if (info.entry.nr == MARKER) {
+                    if (counting && operation < OPERATIONS) {
+                        result->syscalls[operation++] = (double)count / SYSCALL_ROUNDS;
+                    }
+                    counting = !counting;
+                    count = 0;
+                } else if (counting) {
+                    count++;
+                }
+            }
+        } else if (WSTOPSIG(status) != SIGTRAP && WSTOPSIG(status) != SIGSTOP) {
+            signal = WSTOPSIG(status);   // señales propias del hijo: entregarlas
+        }
+        ptrace(PTRACE_SYSCALL, task, NULL, (void*)(long)signal);
+    }
+    return operation == OPERATIONS ? 0 : -1;
+}
+
+// ============================================================================
+// INFORME
+// ============================================================================
+
+static int run_size(int rows, double min_time_ns) {
+    char root[PROC_ROOT_MAX];
+    int pids = rows < MAX_PIDS ? rows : MAX_PIDS;
+    snprintf(root, sizeof(root), "%s_%d", FIXTURE_DIR, rows);
+
+    double start = now_ns();
+    if (make_fixture(root, rows, pids) < 0) {
+        fprintf(stderr, "No se pudo crear el fixture en %s: %s\n", root, strerror(errno));
+        remove_fixture(root);
+        return -1;
+    }
+    double generated = now_ns() - start;
+
+    // El hijo cronometrado deja su resultado en memoria compartida
+    Result* result = mmap(NULL, sizeof(Result), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (result == MAP_FAILED) {
+        remove_fixture(root);
+        return -1;
+    }
+    memset(result, 0, sizeof(*result));
+    for (int i = 0; i < OPERATIONS; i++) {
+        result->syscalls[i] = -1.0;
+    }
+    snprintf(result->error, sizeof(result->error), "el proceso de medida terminó antes de tiempo");
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        result->error[0] = '\0';
+        measure(root, rows, pids, min_time_ns, result);
+        _exit(0);
+    }
+    int status = 0;
+    if (child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        snprintf(result->error, sizeof(result->error), "el proceso de medida terminó antes de tiempo");
+    }
+    int traced_ok = !result->error[0] && count_syscalls(root, rows, result) == 0;
+    remove_fixture(root);
+
+    if (result->error[0]) {
+        fprintf(stderr, "%d filas: %s\n", rows, result->error);
+        munmap(result, sizeof(Result));
+        return -1;
+    }
+
+    printf("%d filas en /proc/net/dev y /proc/net/tcp, %d procesos (fixture: %.0f ms)\n",
+           rows, pids, generated / 1e6);
+    for (int i = 0; i < OPERATIONS; i++) {
+        char syscalls[32] = "n/d";
+        if (traced_ok) {
+            snprintf(syscalls, sizeof(syscalls), "%.1f", result->syscalls[i]);
+        }
+        printf("  %-24s %14.0f %12.1f %12s\n", operations[i].name, result->ns[i], result->allocs[i], syscalls);
+    }
+    printf("\n");
+    munmap(result, sizeof(Result));
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int check = argc > 1 && strcmp(argv[1], "--check") == 0;
+    int max_rows = check ? CHECK_ROWS : MAX_ROWS;
+    if (!check && argc > 1) {
+        max_rows = atoi(argv[1]);
+    }
+    if (max_rows < 10) {
+        fprintf(stderr, "Uso: bench_proc [filas máximas >= 10] | bench_proc --check\n");
+        return 1;
+    }
+
+    printf("Recolección sobre un /proc sintético (%s_N), por operación\n", FIXTURE_DIR);
+    printf("  %-24s %14s %12s %12s\n", "operación", "ns/op", "allocs/op", "syscalls/op");
+    printf("---------------------------------------------------------------------\n");
+
+    for (int rows = 10; rows <= max_rows; rows *= 10) {
+        if (run_size(rows, check ? CHECK_TIME_NS : MIN_TIME_NS) < 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+#define _GNU_SOURCE
+#include "procnet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Micro-benchmark del parser de /proc/net frente a la ruta fgets + sscanf + inet_ntoa
+
+#define LINES 100000
+#define FIXTURE_TCP "/tmp/nlx_bench_tcp"
+#define FIXTURE_TCP6 "/tmp/nlx_bench_tcp6"
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Generar un fichero con el formato de /proc/net/tcp o /proc/net/tcp6
+static void write_fixture(const char* path, int ipv6) {
+    FILE* file = fopen(path, "w");
+    if (!file) return;
+
+    if (ipv6) {
+        fprintf(file, "  sl  local_address                         remote_address                        st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n");
+    } else {
+        fprintf(file, "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n");
+    }
+
+    for (int i = 0; i < LINES; i++) {
+        int state = 1 + i % 11;
+        if (ipv6) {
+            fprintf(file, "%4d: 0000000000000000FFFF0000%08X:%04X 00000000000000000000000001%06X:%04X %02X 00000000:00000000 00:00000000 00000000  1000        0 %d 1 0000000000000000 20 4 0 10 -1\n",
+                    i, 0x0100007F + i, 1024 + i % 60000, i, 443, state, 100000 + i);
+        } else {
+            fprintf(file, "%4d: %08X:%04X %08X:%04X %02X 00000000:00000000 00:00000000 00000000  1000        0 %d 1 0000000000000000 20 4 0 10 -1\n",
+                    i, 0x0100007F + i, 1024 + i % 60000, 0x0A000001 + i, 443, state, 100000 + i);
+        }
+    }
+    fclose(file);
+}
+
+// Ruta anterior: una línea por fgets, sscanf con formato y cadenas por fila
+static int parse_sscanf(const char* path, Connection* rows) {
+    FILE* file = fopen(path, "r");
+    char line[512];
+    int count = 0;
+
+    if (!file) return 0;
+    fgets(line, sizeof(line), file);
+
+    while (fgets(line, sizeof(line), file) && count < LINES) {
+        unsigned int local_addr, remote_addr;
+        int local_port, remote_port, state;
+        char local_ip[MAX_IP_ADDRESS], remote_ip[MAX_IP_ADDRESS], state_str[16];
+
+        if (sscanf(line, "%*d: %x:%x %x:%x %x", &local_addr, &local_port, &remote_addr, &remote_port, &state) >= 5) {
+            struct in_addr ip;
+            ip.s_addr = local_addr;
+            strncpy(local_ip, inet_ntoa(ip), sizeof(local_ip) - 1);
+            ip.s_addr = remote_addr;
+            strncpy(remote_ip, inet_ntoa(ip), sizeof(remote_ip) - 1);
+            strcpy(state_str, connection_state_name(state));
+            strcpy(rows[count].process, "unknown");
+            rows[count].local_port = local_port;
+            rows[count].remote_port = remote_port;
+            rows[count].local_addr[0] = local_ip[0] + remote_ip[0] + state_str[0];
+            count++;
+        }
+    }
+
+    fclose(file);
+    return count;
+}
+
+// Ruta anterior de los ficheros pequeños: fopen + fgets + fclose en cada muestra
+static int read_stdio(const char* path) {
+    char line[512];
+    int lines = 0;
+    FILE* file = fopen(path, "r");
+
+    if (!file) return -1;
+    while (fgets(line, sizeof(line), file)) {
+        lines++;
+    }
+    fclose(file);
+    return lines;
+}
+
+// Relecturas de ficheros pequeños de procfs/sysfs: fopen por muestra frente al registro
+static void bench_rereads(void) {
+    static const char* paths[] = {"/proc/net/dev", "/sys/class/net/lo/operstate", "/proc/self/comm"};
+    int iterations = 20000;
+    ProcRegistry registry = {0};
+
+    printf("\nRelectura de ficheros pequeños (%d veces cada uno)\n", iterations);
+    printf("%-30s %12s %12s %12s\n", "fichero", "stdio ns", "pread ns", "syscalls/op");
+    printf("------------------------------------------------------------------------\n");
+
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        if (read_stdio(paths[i]) < 0) {
+            continue;
+        }
+
+        double start = now_ns();
+        for (int j = 0; j < iterations; j++) {
+            read_stdio(paths[i]);
+        }
+        double stdio_ns = (now_ns() - start) / iterations;
+
+        proc_registry_read(&registry, paths[i], NULL);
+        uint64_t syscalls = registry.syscalls;
+        start = now_ns();
+        for (int j = 0; j < iterations; j++) {
+            proc_registry_read(&registry, paths[i], NULL);
+        }
+        double pread_ns = (now_ns() - start) / iterations;
+
+        printf("%-30s %12.0f %12.0f %12.1f\n", paths[i], stdio_ns, pread_ns,
+               (double)(registry.syscalls - syscalls) / iterations);
+    }
+
+    proc_registry_free(&registry);
+}
+
+int main(void) {
+    int iterations = 20;
+    ProcBuffer buffer = {0};
+    ConnectionList list = {0};
+    Connection* rows = malloc(LINES * sizeof(Connection));
+
+    write_fixture(FIXTURE_TCP, 0);
+    write_fixture(FIXTURE_TCP6, 1);
+
+    // Calentar caché de páginas y reservar memoria
+    parse_sscanf(FIXTURE_TCP, rows);
+    proc_buffer_read(&buffer, FIXTURE_TCP);
+    procnet_parse(buffer.data, buffer.length, AF_INET, IPPROTO_TCP, CONN_STATES_ALL, 0, &list);
+
+    double start = now_ns();
+    int parsed = 0;
+    for (int i = 0; i < iterations; i++) {
+        parsed = parse_sscanf(FIXTURE_TCP, rows);
+    }
+    double sscanf_ns = (now_ns() - start) / iterations;
+
+    start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        list.count = 0;
+        proc_buffer_read(&buffer, FIXTURE_TCP);
+        procnet_parse(buffer.data, buffer.length, AF_INET, IPPROTO_TCP, CONN_STATES_ALL, 0, &list);
+    }
+    double tcp_ns = (now_ns() - start) / iterations;
+    int parsed_tcp = list.count;
+
+    start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        list.count = 0;
+        proc_buffer_read(&buffer, FIXTURE_TCP6);
+        procnet_parse(buffer.data, buffer.length, AF_INET6, IPPROTO_TCP, CONN_STATES_ALL, 0, &list);
+    }
+    double tcp6_ns = (now_ns() - start) / iterations;
+    int parsed_tcp6 = list.count;
+
+    printf("Parseo de %d líneas de /proc/net (ns por línea)\n", LINES);
+    printf("%-32s %10s %10s\n", "ruta", "filas", "ns/línea");
+    printf("------------------------------------------------------\n");
+    printf("%-32s %10d %10.1f\n", "fgets + sscanf + inet_ntoa (tcp)", parsed, sscanf_ns / LINES);
+    printf("%-32s %10d %10.1f\n", "procnet (tcp)", parsed_tcp, tcp_ns / LINES);
+    printf("%-32s %10d %10.1f\n", "procnet (tcp6)", parsed_tcp6, tcp6_ns / LINES);
+    printf("Mejora tcp: %.1fx\n", sscanf_ns / tcp_ns);
+
+    bench_rereads();
+
+    unlink(FIXTURE_TCP);
+    unlink(FIXTURE_TCP6);
+    proc_buffer_free(&buffer);
+    free(list.items);
+    free(rows);
+    return 0;
+}
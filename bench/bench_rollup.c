@@ -0,0 +1,79 @@
+#define _GNU_SOURCE
+#include "rollup.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Agregados del gráfico de ancho de banda: coste de añadir una muestra a los cuatro
+// niveles y del máximo de ventana con la cola monótona frente a recorrer los cubos.
+// Uso: bench_rollup [días]
+
+#define QUERIES 1000000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Referencia: recorrer los cubos de la ventana
+static double scan_max(const Rollup* rollup, int tier, int buckets) {
+    double max = 0.0;
+    for (int age = 0; age < buckets; age++) {
+        const RollupBucket* bucket = rollup_bucket(rollup, tier, age);
+        if (!bucket) break;
+        if (bucket->count > 0 && bucket->max > max) max = bucket->max;
+    }
+    return max;
+}
+
+int main(int argc, char* argv[]) {
+    int days = argc > 1 ? atoi(argv[1]) : 2;
+    static Rollup rollup;
+    uint64_t samples = (uint64_t)(days > 0 ? days : 2) * 86400;
+    int mismatches = 0;
+    volatile double sink = 0.0;
+
+    rollup_init(&rollup);
+
+    // Una muestra por segundo con ráfagas; se comprueba la escala a lo largo del camino
+    srand(7);
+    double start = now_ns();
+    for (uint64_t i = 0; i < samples; i++) {
+        double value = rand() % 100 == 0 ? rand() % 1000 : (rand() % 100) / 10.0;
+        rollup_add(&rollup, i * NS_PER_SECOND, value);
+    }
+    double add_ns = (now_ns() - start) / samples;
+
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+        for (int width = 1; width <= ROLLUP_SLOTS; width += 7) {
+            if (rollup_window_max(&rollup, tier, width) != scan_max(&rollup, tier, width)) {
+                mismatches++;
+            }
+        }
+    }
+
+    start = now_ns();
+    for (int i = 0; i < QUERIES; i++) {
+        sink += rollup_window_max(&rollup, i % ROLLUP_TIERS, 76);
+    }
+    double deque_ns = (now_ns() - start) / QUERIES;
+
+    start = now_ns();
+    for (int i = 0; i < QUERIES; i++) {
+        sink += scan_max(&rollup, i % ROLLUP_TIERS, 76);
+    }
+    double scan_ns = (now_ns() - start) / QUERIES;
+    (void)sink;
+
+    printf("Agregados de %lu muestras de 1 s (%d días), %d niveles x %d cubos, %zu bytes\n",
+           (unsigned long)samples, (int)(samples / 86400), ROLLUP_TIERS, ROLLUP_SLOTS, sizeof(Rollup));
+    printf("%-34s %10s\n", "operación", "ns/op");
+    printf("-----------------------------------------------\n");
+    printf("%-34s %10.1f\n", "añadir muestra (4 niveles)", add_ns);
+    printf("%-34s %10.1f\n", "máximo de 76 cubos (cola)", deque_ns);
+    printf("%-34s %10.1f\n", "máximo de 76 cubos (recorrido)", scan_ns);
+    printf("%-34s %10d\n", "discrepancias con el recorrido", mismatches);
+    return mismatches != 0;
+}
@@ -0,0 +1,110 @@
+#define _GNU_SOURCE
+#include "tsdb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Historial en fichero: un día de muestras de 1 s por interfaz con tráfico sintético,
+// midiendo el coste de añadir, los bytes de disco por muestra y la velocidad de
+// recorrido del día completo y de una hora.
+// Uso: bench_tsdb [interfaces]
+
+#define FIXTURE_PATH "/tmp/nlx_bench_history"
+#define DAY_SECONDS 86400
+#define START_MS 1700000000000ULL
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef struct {
+    uint64_t samples;
+    uint64_t checksum;
+} ScanTotals;
+
+static void sum_sample(const TsdbSample* sample, void* context) {
+    ScanTotals* totals = context;
+    totals->samples++;
+    totals->checksum += sample->timestamp_ms ^ sample->rx_bytes ^ sample->tx_bytes;
+}
+
+int main(int argc, char* argv[]) {
+    int interfaces = argc > 1 ? atoi(argv[1]) : 1;
+    char names[TSDB_MAX_SERIES][MAX_INTERFACE_NAME];
+    uint64_t rx[TSDB_MAX_SERIES] = {0};
+    uint64_t tx[TSDB_MAX_SERIES] = {0};
+    uint64_t expected = 0;
+    Tsdb db;
+
+    if (interfaces < 1 || interfaces > TSDB_MAX_SERIES) {
+        interfaces = 1;
+    }
+    for (int i = 0; i < interfaces; i++) {
+        snprintf(names[i], MAX_INTERFACE_NAME, "eth%d", i);
+    }
+
+    unlink(FIXTURE_PATH);
+    if (tsdb_open(&db, FIXTURE_PATH, 1, TSDB_DEFAULT_BLOCKS) < 0) {
+        fprintf(stderr, "%s\n", db.error);
+        return 1;
+    }
+
+    // Tick de 1 s con unos ms de variación y tráfico a ráfagas (a veces nulo)
+    srand(42);
+    double start = now_ns();
+    for (int second = 0; second < DAY_SECONDS; second++) {
+        uint64_t timestamp = START_MS + (uint64_t)second * 1000 + rand() % 3;
+        for (int i = 0; i < interfaces; i++) {
+            if (rand() % 4 != 0) {
+                rx[i] += rand() % 2000000;
+                tx[i] += rand() % 200000;
+            }
+            TsdbSample sample = { timestamp, rx[i], tx[i] };
+            tsdb_append(&db, names[i], &sample);
+            if (i == 0) expected += timestamp ^ rx[i] ^ tx[i];
+        }
+    }
+    double append_ns = (now_ns() - start) / ((double)DAY_SECONDS * interfaces);
+    uint64_t blocks = db.header->sequence;
+    tsdb_close(&db);
+
+    if (tsdb_open(&db, FIXTURE_PATH, 0, 0) < 0) {
+        fprintf(stderr, "%s\n", db.error);
+        return 1;
+    }
+
+    ScanTotals day = {0, 0};
+    start = now_ns();
+    tsdb_scan(&db, names[0], 0, UINT64_MAX, sum_sample, &day);
+    double day_ns = now_ns() - start;
+
+    ScanTotals hour = {0, 0};
+    uint64_t from = START_MS + 12 * 3600 * 1000ULL;
+    start = now_ns();
+    tsdb_scan(&db, names[0], from, from + 3600 * 1000ULL, sum_sample, &hour);
+    double hour_ns = now_ns() - start;
+    tsdb_close(&db);
+
+    printf("Historial: %d interfaz(es) x %d muestras de 1 s, bloques de %d B\n",
+           interfaces, DAY_SECONDS, TSDB_BLOCK_SIZE);
+    printf("%-28s %12s\n", "métrica", "valor");
+    printf("-----------------------------------------\n");
+    printf("%-28s %12.1f\n", "añadir (ns/muestra)", append_ns);
+    printf("%-28s %12lu\n", "bloques usados", (unsigned long)blocks);
+    printf("%-28s %12.2f\n", "bytes de disco/muestra", blocks * (double)TSDB_BLOCK_SIZE / ((double)DAY_SECONDS * interfaces));
+    printf("%-28s %12.2f\n", "sin comprimir (bytes)", (double)sizeof(TsdbSample));
+    printf("%-28s %12.2f\n", "días en el fichero",
+           TSDB_DEFAULT_BLOCKS / (blocks / (double)interfaces) / interfaces);
+    printf("%-28s %12.1f\n", "recorrer un día (ms)", day_ns / 1e6);
+    printf("%-28s %12.1f\n", "muestras/s al recorrer (M)", day.samples / (day_ns / 1e9) / 1e6);
+    printf("%-28s %12.3f\n", "recorrer una hora (ms)", hour_ns / 1e6);
+    printf("%-28s %12s\n", "muestras íntegras",
+           day.samples == DAY_SECONDS && day.checksum == expected ? "sí" : "NO");
+
+    unlink(FIXTURE_PATH);
+    return 0;
+}
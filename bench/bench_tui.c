@@ -0,0 +1,115 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Tráfico de la TUI hacia la terminal: ejecuta build/nx tui en una pseudoterminal del
+// tamaño pedido y cuenta los bytes que escribe. Un fotograma es una ráfaga de
+// escrituras sin pausas de más de FRAME_GAP_MS; el primero incluye el marco estático.
+// Es el coste que importa por SSH: bytes por fotograma y por segundo en régimen estable.
+// Uso: bench_tui [filas] [columnas] [segundos]
+
+#define NX_PATH "./build/nx"
+#define HISTORY_PATH "/tmp/nlx_bench_tui_history"
+#define STARTUP_MS 3000
+#define FRAME_GAP_MS 20
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int rows = argc > 1 ? atoi(argv[1]) : 46;
+    int cols = argc > 2 ? atoi(argv[2]) : 120;
+    int seconds = argc > 3 ? atoi(argv[3]) : 15;
+    struct winsize size = { (unsigned short)rows, (unsigned short)cols, 0, 0 };
+    int master;
+
+    if (access(NX_PATH, X_OK) < 0) {
+        fprintf(stderr, "Falta %s: ejecutar make antes\n", NX_PATH);
+        return 1;
+    }
+
+    pid_t pid = forkpty(&master, NULL, NULL, &size);
+    if (pid < 0) {
+        perror("forkpty");
+        return 1;
+    }
+    if (pid == 0) {
+        setenv("TERM", "xterm", 1);
+        setenv("NX_HISTORY", HISTORY_PATH, 1);
+        execl(NX_PATH, "nx", "tui", (char*)NULL);
+        _exit(127);
+    }
+
+    char buffer[65536];
+    unsigned long first_bytes = 0, steady_bytes = 0, steady_writes = 0, frames = 0;
+    unsigned long largest_frame = 0, frame_bytes = 0;
+    double start = now_ms();
+    double last_read = 0.0;
+    double end = start + seconds * 1000.0;
+
+    while (now_ms() < end) {
+        struct pollfd pfd = { master, POLLIN, 0 };
+        if (poll(&pfd, 1, 10) <= 0) {
+            continue;
+        }
+        ssize_t n = read(master, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+
+        double now = now_ms();
+        if (now - start < STARTUP_MS) {
+            first_bytes += n;
+        } else {
+            // Ráfaga nueva tras una pausa: fotograma nuevo
+            if (frames == 0 || now - last_read > FRAME_GAP_MS) {
+                if (frame_bytes > largest_frame) largest_frame = frame_bytes;
+                frame_bytes = 0;
+                frames++;
+            }
+            frame_bytes += n;
+            steady_bytes += n;
+            steady_writes++;
+        }
+        last_read = now;
+    }
+    if (frame_bytes > largest_frame) largest_frame = frame_bytes;
+
+    // Salir con 'q' y vaciar la salida final para que el hijo no se bloquee
+    if (write(master, "q", 1) < 0) {
+        kill(pid, SIGTERM);
+    }
+    for (double limit = now_ms() + 2000; now_ms() < limit;) {
+        struct pollfd pfd = { master, POLLIN, 0 };
+        if (poll(&pfd, 1, 100) <= 0 || read(master, buffer, sizeof(buffer)) <= 0) {
+            break;
+        }
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    close(master);
+    unlink(HISTORY_PATH);
+
+    double steady_s = (seconds * 1000.0 - STARTUP_MS) / 1000.0;
+    printf("TUI en pseudoterminal de %dx%d durante %d s (arranque: %d ms)\n", rows, cols, seconds, STARTUP_MS);
+    printf("%-30s %10s\n", "métrica", "valor");
+    printf("-----------------------------------------\n");
+    printf("%-30s %10lu\n", "bytes del primer dibujo", first_bytes);
+    printf("%-30s %10lu\n", "fotogramas en régimen", frames);
+    printf("%-30s %10.1f\n", "fotogramas/s", frames / steady_s);
+    printf("%-30s %10.0f\n", "bytes/fotograma (media)", frames ? (double)steady_bytes / frames : 0.0);
+    printf("%-30s %10lu\n", "bytes/fotograma (máximo)", largest_frame);
+    printf("%-30s %10.0f\n", "bytes/s", steady_bytes / steady_s);
+    printf("%-30s %10lu\n", "lecturas del pty", steady_writes);
+    return 0;
+}
@@ -0,0 +1,158 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "utils.h"
+#include "flowtable.h"
+#include <pthread.h>
+
+// Parámetros de captura
+#define CAPTURE_SNAPLEN 128                     // solo cabeceras L2-L4
+#define CAPTURE_BUFFER_SIZE (64 * 1024 * 1024)  // buffer del kernel para ráfagas
+#define CAPTURE_TIMEOUT_MS 100
+#define CAPTURE_FLOW_SLOTS (1 << 16)            // flujos simultáneos por hilo de captura
+#define CAPTURE_FLOW_IDLE_SECONDS 30            // expulsar flujos sin tráfico tras este tiempo
+
+// Backends de captura
+#define CAPTURE_BACKEND_PCAP 0
+#define CAPTURE_BACKEND_RING 1                  // AF_PACKET + TPACKET_V3 mapeado en memoria
+
+// Valores por defecto del anillo TPACKET_V3
+#define CAPTURE_RING_BLOCK_SIZE (1 << 20)
+#define CAPTURE_RING_BLOCK_COUNT 64
+#define CAPTURE_RING_TIMEOUT_MS 100
+#define CAPTURE_RING_MIN_BLOCKS 8               // mínimo por anillo al repartir entre hilos
+#define CAPTURE_MAX_THREADS 16
+
+// Tipos de enlace soportados (valores DLT_* de libpcap en Linux)
+#define CAPTURE_LINK_ETHERNET 1
+#define CAPTURE_LINK_RAW 12
+#define CAPTURE_LINK_SLL 113
+#define CAPTURE_LINK_SLL2 276
+
+// Tráfico atribuido a un proceso
+typedef struct {
+    int pid;
+    char comm[MAX_PROCESS_NAME];
+    uint64_t rx_bytes;          // acumulados desde el inicio de la captura
+    uint64_t tx_bytes;
+    double rx_speed;            // MB/s en el último intervalo
+    double tx_speed;
+    uint64_t last_rx;           // acumulados en el intervalo anterior
+    uint64_t last_tx;
+} ProcessTraffic;
+
+// Estadísticas de la captura
+typedef struct {
+    uint64_t packets;           // paquetes procesados
+    uint64_t bytes;             // bytes en el cable de esos paquetes
+    uint64_t kernel_drops;      // descartados por falta de buffer (ps_drop)
+    uint64_t interface_drops;   // descartados por la interfaz (ps_ifdrop)
+    uint64_t flow_overflows;    // bytes que no cupieron en la tabla de flujos
+    uint64_t flow_evictions;    // flujos inactivos expulsados
+    int flow_occupied;          // flujos vivos en las tablas de todos los hilos
+    int flow_capacity;
+    uint64_t unattributed;      // bytes sin socket local conocido
+    uint64_t ring_freezes;      // veces que el anillo se llenó (tp_freeze_q_cnt)
+    int ring_blocks_used;       // bloques del anillo pendientes de procesar
+    int ring_blocks_total;
+    int threads;                // hilos de captura en marcha
+} CaptureStats;
+
+// Configuración de la captura (NULL en capture_start usa los valores por defecto)
+typedef struct {
+    int backend;                // CAPTURE_BACKEND_*
+    int threads;                // anillos e hilos con PACKET_FANOUT (0 = uno por núcleo; libpcap usa 1)
+    int block_size;             // tamaño de bloque del anillo (múltiplo del tamaño de página)
+    int block_count;            // bloques en total, repartidos entre los anillos
+    int block_timeout_ms;       // tiempo máximo antes de entregar un bloque incompleto
+} CaptureConfig;
+
+// Anillo TPACKET_V3 mapeado en memoria
+typedef struct {
+    int fd;
+    int wake_fd;                // eventfd para despertar al hilo de captura
+    uint8_t* map;
+    size_t map_size;
+    int block_size;
+    int block_count;
+    int current;                // siguiente bloque a procesar
+} CaptureRing;
+
+struct Capture;
+
+// Hilo de captura con su propio anillo (o handle de libpcap) y su propia tabla de
+// flujos: el camino caliente solo suma contadores atómicos, sin cerrojos
+typedef struct {
+    struct Capture* cap;
+    int index;
+    void* handle;               // pcap_t*
+    CaptureRing ring;
+    int linktype;
+    pthread_t thread;
+    int started;
+    int running;
+
+    FlowTable flows;
+
+    // Sincronización con el consumidor en cada intervalo (protegido por cap->lock)
+    int sync_requested;
+    CaptureStats backend_stats; // descartes leídos por el hilo en cada sincronización
+} CaptureWorker;
+
+// Motor de captura
+typedef struct Capture {
+    char interface[MAX_INTERFACE_NAME];
+    char error[256];
+    CaptureConfig config;
+    int fanout_group;           // grupo PACKET_FANOUT compartido por los anillos
+
+    CaptureWorker workers[CAPTURE_MAX_THREADS];
+    int worker_count;
+    int running;                // hilos de captura en marcha
+    int stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t synced;
+
+    // Totales y atribución por proceso (solo el consumidor)
+    CaptureStats totals;
+    uint64_t drained_packets;   // retirados de las tablas de flujos
+    uint64_t drained_bytes;
+    ProcessTraffic* processes;  // ordenados por pid
+    int process_count;
+    int process_capacity;
+    double last_update;
+} Capture;
+
+// Ciclo de vida (interface NULL o "any" captura todas las interfaces)
+void capture_default_config(CaptureConfig* config);
+int capture_start(Capture* cap, const char* interface, const CaptureConfig* config);
+void capture_stop(Capture* cap);
+
+// Contabilizar un paquete capturado (llamado por los backends desde su hilo)
+void capture_account_packet(CaptureWorker* worker, const uint8_t* data, uint32_t caplen, uint32_t wire_len);
+
+// Extraer la 5-tupla de un paquete según el tipo de enlace
+int capture_parse_packet(const uint8_t* data, uint32_t caplen, int linktype, FlowKey* key);
+
+// Retirar los contadores de flujos de todos los hilos y atribuirlos a procesos a partir de las conexiones
+int capture_update(Capture* cap, const Connection* connections, int count);
+
+// Consultas sobre el último intervalo
+const ProcessTraffic* capture_get_process(const Capture* cap, int pid);
+void capture_get_stats(Capture* cap, CaptureStats* stats);
+
+// Backend libpcap
+int pcap_backend_open(CaptureWorker* worker);
+int pcap_backend_dispatch(CaptureWorker* worker);
+void pcap_backend_break(CaptureWorker* worker);
+void pcap_backend_stats(CaptureWorker* worker, CaptureStats* stats);
+void pcap_backend_close(CaptureWorker* worker);
+
+// Backend AF_PACKET con anillo TPACKET_V3
+int ring_backend_open(CaptureWorker* worker);
+int ring_backend_dispatch(CaptureWorker* worker);
+void ring_backend_break(CaptureWorker* worker);
+void ring_backend_stats(CaptureWorker* worker, CaptureStats* stats);
+void ring_backend_close(CaptureWorker* worker);
+
+#endif // CAPTURE_H
@@ -2,11 +2,16 @@
 #define COLLECTOR_H
 
 #include "utils.h"
+#include "capture.h"
+#include "histogram.h"
 
 // Funciones de recolección de métricas de red
 NetworkStats collect_network_stats(const char* interface);
+int refresh_network_stats(void);
 Connection* collect_connections(int* count);
+Connection* collect_connections_by_state(uint32_t states, int* count);
 LatencyTest* collect_latency_tests(int* count);
+void latency_test_percentiles(LatencyTest* test, const LatencyHistogram* histogram);
 
 // Funciones específicas de recolección
 NetworkStats read_interface_stats(const char* interface);
@@ -14,15 +19,25 @@ int get_connection_count(void);
 int get_active_processes(void);
 
 // Funciones de cálculo de velocidades
-void calculate_speeds(NetworkStats* current, NetworkStats* previous, double time_diff);
+void calculate_speeds(NetworkStats* current, const NetworkStats* previous);
 double calculate_bandwidth_usage(const char* interface);
 
 // Funciones de detección de interfaces
 char** get_available_interfaces(int* count);
+int list_interfaces(char names[][MAX_INTERFACE_NAME], int* active, int max);
 int is_interface_active(const char* interface);
+int get_interface_address(const char* interface, char* buffer, int size);
+char* get_interface_ip(const char* interface);
 
 // Funciones de monitoreo de procesos
+int start_process_monitor(const char* interface, const CaptureConfig* config);
+void stop_process_monitor(void);
+int update_process_monitor(void);
+const char* process_monitor_error(void);
+ProcessTraffic* collect_process_traffic(int* count);
+int get_capture_stats(CaptureStats* stats);
 int get_process_network_usage(int pid, uint64_t* rx_bytes, uint64_t* tx_bytes);
-char* get_process_connections(int pid, int* count);
+Connection* get_process_connections(int pid, int* count);
+void resolve_connection_owners(Connection* connections, int count);
 
 #endif // COLLECTOR_H 
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+// `nx daemon`: un solo hilo de muestreo para todos los visores de la máquina. Cada
+// muestra publicada se copia al segmento compartido (shared.h); tui, status y
+// connections la leen de ahí en lugar de recolectar por su cuenta
+#define DAEMON_LINKS_PERIOD_MS 1000     // igual que REFRESH_RATE de la TUI
+
+// Bloquea hasta SIGINT o SIGTERM. Devuelve el código de salida del proceso
+int run_daemon(void);
+
+#endif // DAEMON_H
@@ -0,0 +1,63 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include "openmetrics.h"
+#include "shared.h"
+
+// `nx exporter`: servidor HTTP de un solo hilo (epoll) que sirve /metrics en formato
+// OpenMetrics. Los datos los recoge el hilo de muestreo (o un `nx daemon` en marcha),
+// así que una petición solo copia la última muestra publicada y nunca espera a /proc
+#define EXPORTER_DEFAULT_LISTEN "127.0.0.1:9469"
+#define EXPORTER_DEFAULT_CLIENTS 64
+#define EXPORTER_LINKS_PERIOD_MS 1000
+#define EXPORTER_REQUEST_SIZE 4096      // cabeceras de una petición
+#define EXPORTER_HEADER_SIZE 256        // hueco delante del cuerpo para la cabecera HTTP
+
+typedef struct {
+    char listen[128];               // "host:puerto", "[::1]:puerto" o ":puerto" (todas)
+    int max_clients;                // conexiones abiertas a la vez (se cierra la más inactiva)
+} ExporterConfig;
+
+// Un cliente: petición recibida y respuesta en curso. Los búferes se reservan una vez
+// por hueco y se reutilizan entre peticiones y clientes
+typedef struct {
+    int fd;                         // -1 = hueco libre
+    char request[EXPORTER_REQUEST_SIZE];
+    size_t received;
+    MetricsBuffer response;
+    size_t start;                   // primer byte de la respuesta (la cabecera va pegada al cuerpo)
+    size_t sent;
+    int writing;                    // esperando EPOLLOUT para terminar de enviar
+    int keep_alive;
+    uint64_t active_ns;             // última actividad, para elegir a quién cerrar
+} ExporterClient;
+
+typedef struct {
+    ExporterConfig config;
+    int listen_fd;
+    int epoll_fd;
+    ExporterClient* clients;
+    uint64_t scrapes;
+
+    // Origen de las muestras: el segmento de un daemon o un hilo de muestreo propio
+    int attached;
+    Sampler sampler;
+    SharedSnapshot shared;
+    Snapshot shared_copy;
+    int orphaned;                   // el daemon terminó y no arrancó el muestreo propio
+
+    char error[256];
+} Exporter;
+
+void exporter_default_config(ExporterConfig* config);
+
+// Abrir el socket de escucha, el epoll y los huecos de clientes (no arranca el
+// muestreo). Devuelve -1 con el motivo en exporter->error
+int exporter_init(Exporter* exporter, const ExporterConfig* config);
+void exporter_free(Exporter* exporter);
+
+// Punto de entrada de `nx exporter`: bloquea hasta SIGINT o SIGTERM y devuelve el
+// código de salida del proceso
+int run_exporter(const ExporterConfig* config);
+
+#endif // EXPORTER_H
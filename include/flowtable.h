@@ -0,0 +1,90 @@
+#ifndef FLOWTABLE_H
+#define FLOWTABLE_H
+
+#include <stdint.h>
+
+// Límites de la tabla de flujos
+#define FLOW_TABLE_MAX_PROBE 32         // sondeos antes de dar el paquete por desbordado
+#define FLOW_TABLE_MAX_LOAD_PERCENT 75  // ocupación máxima para que los sondeos sigan cortos
+
+// Estados de una entrada
+#define FLOW_EMPTY 0
+#define FLOW_BUSY 1                     // reservada, escribiendo la clave
+#define FLOW_LIVE 2
+#define FLOW_TOMBSTONE 3                // expulsada; reutilizable por inserciones
+
+// Clave binaria de 5-tupla (IPv4 en los 4 primeros bytes de cada dirección)
+typedef struct {
+    uint8_t src[16];
+    uint8_t dst[16];
+    uint16_t sport;
+    uint16_t dport;
+    uint8_t family;
+    uint8_t protocol;
+    uint8_t pad[2];
+} FlowKey;
+
+// Entrada de la tabla: exactamente una línea de caché
+typedef struct {
+    FlowKey key;
+    uint64_t bytes;             // pendientes de retirar por el consumidor
+    uint64_t packets;
+    uint32_t last_seen;         // reloj de la tabla en el último paquete
+    uint32_t state;             // FLOW_*
+} __attribute__((aligned(64))) FlowEntry;
+
+// Contadores retirados de un flujo
+typedef struct {
+    FlowKey key;
+    uint64_t bytes;
+    uint64_t packets;
+} FlowCounter;
+
+// Estadísticas de ocupación
+typedef struct {
+    int capacity;
+    int occupied;               // entradas vivas
+    int peak;                   // máximo de entradas vivas
+    uint64_t inserts;
+    uint64_t evictions;         // flujos inactivos expulsados
+    uint64_t overflow_packets;  // paquetes sin hueco en la tabla o llegados tras expulsar su flujo
+    uint64_t overflow_bytes;
+} FlowTableStats;
+
+// Tabla de direccionamiento abierto de tamaño fijo. Los escritores (hilos de captura)
+// nunca bloquean ni reservan memoria: reservan huecos con CAS y suman con operaciones
+// atómicas. El consumidor retira los contadores y expulsa los flujos inactivos
+typedef struct {
+    FlowEntry* entries;
+    uint32_t mask;              // capacidad - 1 (potencia de 2)
+    uint32_t max_occupied;
+    uint32_t clock;             // segundos, avanzado por flow_table_expire
+    int occupied;
+    int peak;
+    uint64_t inserts;
+    uint64_t evictions;
+    uint64_t overflow_packets;
+    uint64_t overflow_bytes;
+} FlowTable;
+
+// Hash de una clave (también lo usan otros índices por 5-tupla)
+uint32_t flow_key_hash(const FlowKey* key);
+
+// Ciclo de vida (capacity se redondea a potencia de 2)
+int flow_table_init(FlowTable* table, int capacity);
+void flow_table_free(FlowTable* table);
+
+// Sumar un paquete a su flujo (camino caliente, seguro con varios escritores)
+void flow_table_add(FlowTable* table, const FlowKey* key, uint32_t bytes);
+
+// Retirar los contadores pendientes de la siguiente entrada con tráfico a partir de
+// position. Devuelve la posición desde la que seguir o -1 al terminar
+int flow_table_drain_next(FlowTable* table, int position, FlowCounter* out);
+
+// Avanzar el reloj y expulsar flujos sin tráfico desde hace idle_seconds.
+// Devuelve el número de flujos expulsados
+int flow_table_expire(FlowTable* table, uint32_t now, uint32_t idle_seconds);
+
+void flow_table_get_stats(const FlowTable* table, FlowTableStats* stats);
+
+#endif // FLOWTABLE_H
@@ -0,0 +1,48 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// Cubetas logarítmicas al estilo HDR: cada potencia de dos se parte en
+// HISTOGRAM_SUB_BUCKETS cubetas lineales, así que el error relativo de cualquier
+// percentil es como mucho 1/32 (~3%) en todo el rango, de 1 µs a ~134 s
+#define HISTOGRAM_SUB_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_MAX_SHIFT 21
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_SHIFT + 2) * HISTOGRAM_SUB_BUCKETS)
+#define HISTOGRAM_MAX_US ((1ULL << (HISTOGRAM_MAX_SHIFT + HISTOGRAM_SUB_BITS + 1)) - 1)
+
+// Histograma de latencias de memoria fija (sin reservas): registrar es O(1) y dos
+// histogramas se suman cubeta a cubeta para unir ventanas de tiempo o destinos
+typedef struct {
+    uint32_t counts[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t sum_us;
+    uint32_t min_us;
+    uint32_t max_us;
+} LatencyHistogram;
+
+void histogram_init(LatencyHistogram* histogram);
+
+// Registrar una latencia en ms (por encima de HISTOGRAM_MAX_US cuenta en la última cubeta)
+void histogram_record(LatencyHistogram* histogram, double ms);
+
+// Sumar src en dst
+void histogram_merge(LatencyHistogram* dst, const LatencyHistogram* src);
+
+// Percentil (0-100) en ms: el mayor valor equivalente de la cubeta que lo contiene,
+// sin pasar del máximo registrado. -1 si el histograma está vacío
+double histogram_percentile(const LatencyHistogram* histogram, double percentile);
+double histogram_mean(const LatencyHistogram* histogram);
+
+// Repartir las cubetas entre el mínimo y el máximo en bins columnas (eje logarítmico)
+// para draw_histogram(). Devuelve el número de columnas escritas y deja en
+// *max_ms el límite superior del eje
+int histogram_distribution(const LatencyHistogram* histogram, double values[], int bins, double* max_ms);
+
+// Cuentas acumuladas para límites crecientes bounds_ms[] (estilo Prometheus "le"): una
+// cubeta cuenta en el primer límite que alcanza su mayor valor, así que el error en
+// la frontera es el de la cubeta (~3%)
+void histogram_cumulative(const LatencyHistogram* histogram, const double bounds_ms[], uint64_t counts[], int bounds);
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,99 @@
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include "utils.h"
+#include <stddef.h>
+
+// Tamaño del buffer de recepción para volcados de netlink
+#define NETLINK_RX_BUFFER (64 * 1024)
+
+// Tabla de enlaces indexada por ifindex: estadísticas, nombre y estado. Se llena con
+// volcados RTM_GETLINK y, si el socket está suscrito a RTMGRP_LINK, se mantiene al
+// día con las notificaciones de altas, bajas y cambios de estado
+typedef struct {
+    NetworkStats* stats;                    // stats[ifindex]
+    char (*names)[MAX_INTERFACE_NAME];      // names[ifindex]
+    uint8_t* operstate;                     // IF_OPER_* de cada ifindex
+    uint32_t* flags;                        // IFF_* de cada ifindex
+    uint32_t* seen;                         // generación en la que apareció cada ifindex (0 = baja)
+    int capacity;                           // ifindex máximo + 1 reservado
+    int count;                              // interfaces en el último volcado
+    uint32_t generation;                    // último volcado completo
+    uint32_t pending;                       // volcado en curso
+    int* hash;                              // nombre -> ifindex + 1 (0 = vacío)
+    int hash_size;                          // potencia de 2
+    int hash_dirty;                         // reconstruir el hash al terminar el volcado
+    int seq;                                // número de secuencia de netlink
+    uint64_t timestamp_ns;                  // CLOCK_MONOTONIC del lote en curso
+    uint64_t notifications;                 // RTM_NEWLINK/RTM_DELLINK fuera de volcados
+    char* rx_buffer;                        // buffer de recepción reutilizable
+} LinkStatsTable;
+
+// Dirección de una interfaz (RTM_NEWADDR)
+typedef struct {
+    int ifindex;
+    uint8_t family;                         // AF_INET o AF_INET6
+    uint8_t prefix_len;
+    uint8_t scope;                          // RT_SCOPE_* (0 = global)
+    uint8_t addr[16];
+} InterfaceAddress;
+
+// Caché de direcciones: un volcado RTM_GETADDR inicial y después solo las
+// notificaciones de los grupos IFADDR, así que consultar es leer memoria
+typedef struct {
+    InterfaceAddress* addresses;
+    int count;
+    int capacity;
+    int fd;                                 // suscrito a RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR
+    int seq;
+    int synced;                             // 0 = hace falta un volcado completo
+    uint64_t dumps;
+    uint64_t changes;                       // altas, bajas y cambios aplicados
+    char* rx_buffer;
+} AddressCache;
+
+// Sockets NETLINK_ROUTE
+int nl_open(unsigned int groups);
+void nl_close(int fd);
+
+// Ciclo de vida de la tabla
+int link_stats_init(LinkStatsTable* table);
+void link_stats_free(LinkStatsTable* table);
+
+// Volcado RTM_GETLINK completo (una sola petición para todas las interfaces)
+int link_stats_dump(LinkStatsTable* table, int fd);
+
+// Aplicar las notificaciones de RTMGRP_LINK pendientes sin bloquear; si el socket
+// perdió mensajes (ENOBUFS) se repite el volcado. Devuelve las notificaciones
+// aplicadas o -1 en error
+int link_stats_update(LinkStatsTable* table, int fd);
+
+// Parseo de un volcado por partes (expuesto para benchmarks)
+void link_stats_begin(LinkStatsTable* table);
+int link_stats_parse(LinkStatsTable* table, const void* buffer, size_t length);
+void link_stats_end(LinkStatsTable* table);
+
+// Consultas sobre la tabla
+int link_stats_find(const LinkStatsTable* table, const char* name);
+const NetworkStats* link_stats_get(const LinkStatsTable* table, int ifindex);
+int link_stats_next(const LinkStatsTable* table, int ifindex);    // siguiente ifindex vivo o -1
+const char* link_stats_name(const LinkStatsTable* table, int ifindex);
+int link_stats_is_up(const LinkStatsTable* table, int ifindex);   // operstate == IF_OPER_UP
+
+// Ciclo de vida de la caché de direcciones (init abre el socket y hace el volcado)
+int address_cache_init(AddressCache* cache);
+void address_cache_free(AddressCache* cache);
+
+// Aplicar las notificaciones pendientes sin bloquear; si el socket perdió mensajes
+// (ENOBUFS) se repite el volcado. Devuelve los cambios aplicados o -1 en error
+int address_cache_update(AddressCache* cache);
+
+// Aplicar mensajes RTM_NEWADDR/RTM_DELADDR de un bloque (expuesto para benchmarks).
+// Devuelve 1 si el bloque cierra un volcado, 0 si no, -1 en error
+int address_cache_parse(AddressCache* cache, const void* buffer, size_t length);
+
+// Dirección preferida de una interfaz para una familia: la primera global, o la
+// primera de cualquier ámbito. Devuelve NULL si no tiene
+const InterfaceAddress* address_cache_find(const AddressCache* cache, int ifindex, int family);
+
+#endif // NETLINK_H
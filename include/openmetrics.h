@@ -0,0 +1,32 @@
+#ifndef OPENMETRICS_H
+#define OPENMETRICS_H
+
+#include "sampler.h"
+#include <stddef.h>
+
+#define OPENMETRICS_CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+// Búfer de texto reutilizable: crece (duplicando) solo cuando una respuesta no cabe,
+// así que tras las primeras peticiones renderizar no reserva memoria. offset deja
+// sitio delante para que el servidor escriba la cabecera HTTP sin mover el cuerpo
+typedef struct {
+    char* data;
+    size_t capacity;
+    size_t offset;                  // inicio del cuerpo
+    size_t length;                  // fin del cuerpo
+    int failed;                     // sin memoria: el contenido está incompleto
+} MetricsBuffer;
+
+void metrics_buffer_init(MetricsBuffer* buffer, size_t offset);
+void metrics_buffer_free(MetricsBuffer* buffer);
+void metrics_buffer_reset(MetricsBuffer* buffer);
+void metrics_buffer_printf(MetricsBuffer* buffer, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// Escribir la muestra en formato OpenMetrics: contadores de cada interfaz, conexiones
+// TCP por estado, sockets UDP, procesos, histogramas de latencia por destino (de las
+// últimas ventanas, por eso gaugehistogram) y antigüedad de cada sección.
+// Devuelve -1 si no hubo memoria
+int metrics_render(const Snapshot* snapshot, MetricsBuffer* buffer);
+
+#endif // OPENMETRICS_H
@@ -0,0 +1,94 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "utils.h"
+#include <stddef.h>
+
+// Salida legible por máquinas de los comandos (--format) y repetición periódica
+// (--interval). Los registros se escriben en un búfer fijo y salen con un write(2)
+// cada OUTPUT_BUFFER_SIZE bytes o al final de cada intervalo: sin reservas de memoria
+// ni stdio por fila
+//
+//   json    un objeto por línea: {"type":"connection","time_ms":...,"proto":"tcp",...}
+//   csv     una cabecera "type,time_ms,..." la primera vez que aparece cada tipo
+//   binary  "NXB1" y después tramas [tipo de trama u8][tipo u8][longitud u16 LE][datos]:
+//           'S' esquema (nombre del tipo, número de campos y por campo clase y nombre),
+//           una vez por tipo antes de su primera fila, y 'R' fila (valores en el orden
+//           del esquema: u64 y f64 en 8 bytes LE, cadenas con longitud u16 LE delante)
+typedef enum {
+    OUTPUT_TEXT,                    // tablas para personas (por defecto)
+    OUTPUT_JSON,
+    OUTPUT_CSV,
+    OUTPUT_BINARY
+} OutputFormat;
+
+typedef struct {
+    OutputFormat format;
+    int interval_ms;                // 0 = una sola vez
+} OutputConfig;
+
+#define OUTPUT_BUFFER_SIZE 65536
+#define OUTPUT_RECORD_MAX 8192      // margen tras el búfer para el registro en curso
+#define OUTPUT_STRING_MAX 255       // las cadenas más largas se recortan
+#define OUTPUT_MAX_TYPES 8
+#define OUTPUT_BINARY_MAGIC "NXB1"
+
+// Clases de campo del esquema binario
+#define OUTPUT_FIELD_U64 1
+#define OUTPUT_FIELD_F64 2
+#define OUTPUT_FIELD_STRING 3
+
+typedef struct {
+    char name[32];
+    int described;                  // cabecera CSV o esquema binario ya escritos
+} OutputType;
+
+typedef struct {
+    int fd;
+    OutputFormat format;
+    uint64_t time_ms;               // marca de tiempo de los registros (CLOCK_REALTIME)
+    size_t length;
+    size_t record;                  // inicio del registro en curso
+    int type;                       // índice en types del registro en curso
+    int fields;
+    OutputType types[OUTPUT_MAX_TYPES];
+    int type_count;
+    char schema[OUTPUT_RECORD_MAX]; // cabecera o esquema del tipo en curso si falta escribirlo
+    size_t schema_length;
+    uint64_t records;
+    uint64_t writes;                // llamadas a write(2)
+    uint64_t bytes;                 // bytes escritos
+    int failed;                     // la salida se cerró (EPIPE) o falló un write
+    char data[OUTPUT_BUFFER_SIZE + OUTPUT_RECORD_MAX];
+} Output;
+
+void output_default_config(OutputConfig* config);
+
+// Reconocer --format e --interval en argv[*i] (avanza *i si consume el valor).
+// Devuelve 1 si era una de ellas, 0 si no y -1 si el valor no es válido
+int output_parse_option(OutputConfig* config, int argc, char** argv, int* i);
+
+void output_init(Output* output, int fd, OutputFormat format);
+
+// Escribir lo acumulado. Devuelve -1 si la salida ya no admite datos
+int output_flush(Output* output);
+
+// Un registro: output_begin, sus campos en el mismo orden en todos los registros
+// del tipo, y output_end
+void output_begin(Output* output, const char* type);
+void output_string(Output* output, const char* name, const char* value);
+void output_u64(Output* output, const char* name, uint64_t value);
+void output_double(Output* output, const char* name, double value);
+void output_end(Output* output);
+
+// Registro "connection" con los campos de una conexión
+void output_connection(Output* output, const Connection* connection);
+
+// Ejecutar una vista una vez o, con interval_ms, en cada tick hasta SIGINT/SIGTERM o
+// hasta que se cierre la salida. SIGINT y SIGTERM se bloquean antes de la primera
+// llamada, así que los hilos que cree la vista las heredan bloqueadas. La vista
+// escribe con printf en formato texto y en output en el resto; devuelve -1 para parar
+typedef int (*OutputView)(Output* output, void* context);
+int output_run(const OutputConfig* config, OutputView view, void* context);
+
+#endif // OUTPUT_H
@@ -0,0 +1,149 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "utils.h"
+#include "histogram.h"
+#include <sys/socket.h>
+
+// Límites y valores por defecto
+#define PROBE_MAX_TARGETS 4096
+#define PROBE_DEFAULT_INTERVAL_MS 1000
+#define PROBE_DEFAULT_TIMEOUT_MS 1000
+#define PROBE_DEFAULT_ROUNDS 1
+#define PROBE_DEFAULT_TARGETS "google.com", "github.com", "cloudflare.com", "8.8.8.8"
+#define PROBE_HTTP_DEFAULT_TARGETS "https://www.google.com/", "https://github.com/", "https://www.cloudflare.com/"
+#define PROBE_HTTP_MAX_IN_FLIGHT 16
+
+// Fases de una petición HTTP (a partir de CURLINFO_*_TIME_T)
+#define HTTP_PHASE_DNS 0
+#define HTTP_PHASE_CONNECT 1            // TCP
+#define HTTP_PHASE_TLS 2
+#define HTTP_PHASE_FIRST_BYTE 3         // desde la conexión lista hasta el primer byte
+#define HTTP_PHASE_TOTAL 4
+#define HTTP_PHASES 5
+
+// Tipos de sondeo
+#define PROBE_ICMP 0                // eco ICMP/ICMPv6 (socket de ping sin privilegios si se permite)
+#define PROBE_TCP 1                 // tiempo hasta completar connect()
+
+// Resultado del último sondeo (mismos valores que LatencyTest.status)
+#define PROBE_OK 0
+#define PROBE_TIMEOUT 1
+#define PROBE_ERROR 2
+
+// Configuración del motor
+typedef struct {
+    int interval_ms;            // entre sondeos al mismo destino
+    int timeout_ms;
+    int rounds;                 // sondeos por destino (0 = sin fin)
+    int max_in_flight;          // peticiones HTTP simultáneas como máximo
+} ProbeConfig;
+
+// Destino con su sondeo en curso y sus resultados acumulados
+typedef struct {
+    char name[MAX_SERVER_NAME];
+    int type;                   // PROBE_ICMP o PROBE_TCP
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+
+    // Sondeo en curso
+    int fd;                     // socket TCP en vuelo (-1 = ninguno)
+    int in_flight;
+    uint32_t round;             // identifica la respuesta ICMP del sondeo en curso
+    uint64_t next_send_ns;
+    uint64_t sent_ns;
+    uint64_t deadline_ns;
+
+    // Resultados
+    int status;                 // PROBE_* del último sondeo
+    int error;                  // errno del último fallo
+    double last_ms;
+    double min_ms;
+    double max_ms;
+    double total_ms;
+    LatencyHistogram histogram; // todos los RTT, para percentiles
+    uint64_t sent;
+    uint64_t received;
+    uint64_t timeouts;
+    uint64_t errors;
+} ProbeTarget;
+
+// Motor de sondeos: un solo hilo y un solo bucle epoll para todos los destinos. Los
+// ecos ICMP comparten un socket por familia y se reconocen por la carga útil; cada
+// connect() TCP en vuelo tiene su socket. Un timerfd en tiempo absoluto despierta el
+// bucle en el siguiente envío o vencimiento, y los tiempos son CLOCK_MONOTONIC en ns
+typedef struct {
+    ProbeConfig config;
+    ProbeTarget* targets;
+    int count;
+    int capacity;
+    int epoll_fd;
+    int timer_fd;
+    int icmp_fd[2];             // AF_INET, AF_INET6 (-1 = sin abrir, -2 = no disponible)
+    int icmp_raw[2];            // 1 si es SOCK_RAW (sin sockets de ping sin privilegios)
+    uint16_t echo_id;
+    char error[256];
+} ProbeEngine;
+
+// Destino HTTP: una petición GET por ronda sobre un handle persistente, de modo que
+// las rondas siguientes reutilizan la conexión
+typedef struct {
+    char url[256];
+    void* handle;               // CURL* (curl.h queda fuera de las cabeceras públicas)
+    int in_flight;
+    uint64_t next_send_ns;
+
+    // Resultados
+    int status;                 // PROBE_* de la última petición
+    long http_code;
+    char error[128];
+    double last_ms[HTTP_PHASES];
+    double total_ms[HTTP_PHASES];   // sumas para las medias
+    LatencyHistogram histogram;     // tiempo total de cada petición
+    uint64_t sent;
+    uint64_t received;
+    uint64_t timeouts;
+    uint64_t errors;
+    uint64_t connections;       // conexiones nuevas (el resto reutilizaron una abierta)
+} HttpTarget;
+
+// Motor HTTP sobre curl_multi: todas las peticiones avanzan en el mismo hilo con
+// curl_multi_poll, con un máximo de config.max_in_flight en vuelo
+typedef struct {
+    ProbeConfig config;
+    HttpTarget* targets;
+    int count;
+    int capacity;
+    int in_flight;
+    void* multi;                // CURLM*
+    char error[256];
+} HttpProbeEngine;
+
+void probe_default_config(ProbeConfig* config);
+
+// Ciclo de vida
+int probe_engine_init(ProbeEngine* engine, const ProbeConfig* config);
+void probe_engine_free(ProbeEngine* engine);
+
+// Añadir un destino: "host" para ICMP, "host:puerto" o "[ipv6]:puerto" para TCP.
+// Resuelve el nombre al añadirlo. Devuelve su índice o -1 (ver probe_engine_error)
+int probe_engine_add(ProbeEngine* engine, const char* spec);
+
+// Sondear todos los destinos hasta completar config.rounds por destino
+int probe_engine_run(ProbeEngine* engine);
+
+// Un sondeo más a cada destino, todos a la vez, para quien sondea periódicamente
+// con el mismo motor (los resultados y los histogramas se acumulan)
+int probe_engine_round(ProbeEngine* engine);
+
+const char* probe_engine_error(const ProbeEngine* engine);
+const char* probe_type_name(int type);
+
+// Motor HTTP (probe_http.c)
+int http_probe_init(HttpProbeEngine* engine, const ProbeConfig* config);
+void http_probe_free(HttpProbeEngine* engine);
+int http_probe_add(HttpProbeEngine* engine, const char* url);
+int http_probe_run(HttpProbeEngine* engine);
+const char* http_phase_name(int phase);
+
+#endif // PROBE_H
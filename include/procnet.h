@@ -0,0 +1,79 @@
+#ifndef PROCNET_H
+#define PROCNET_H
+
+#include "utils.h"
+#include <stddef.h>
+
+// Tamaño inicial y de cada lectura del buffer de procfs
+#define PROC_BUFFER_CHUNK (256 * 1024)
+
+// Límites del registro de fuentes abiertas
+#define PROC_SOURCE_MAX 64
+#define PROC_SOURCE_PATH 96
+
+// Raíz de /proc: vacía salvo que NX_PROC_ROOT (o proc_set_root) indique un directorio
+// con la misma estructura, como los ficheros sintéticos de los benchmarks. Con una raíz
+// propia las conexiones salen de sus ficheros y no de sock_diag
+#define PROC_ROOT_MAX 160
+#define PROC_PATH_MAX (PROC_ROOT_MAX + PROC_SOURCE_PATH)
+
+const char* proc_root(void);
+void proc_set_root(const char* root);   // cierra las fuentes abiertas del registro compartido
+
+// Ruta con la raíz delante, en el buffer del llamador (path tal cual si no hay raíz)
+const char* proc_path(const char* path, char* buffer, size_t size);
+
+// Buffer reutilizable para leer ficheros de procfs completos
+typedef struct {
+    char* data;
+    size_t capacity;
+    size_t length;
+} ProcBuffer;
+
+// Leer un fichero completo con read() grandes, reutilizando la memoria del buffer
+int proc_buffer_read(ProcBuffer* buffer, const char* path);
+void proc_buffer_free(ProcBuffer* buffer);
+
+// Fichero de procfs/sysfs que se mantiene abierto entre lecturas
+typedef struct {
+    char path[PROC_SOURCE_PATH];
+    int fd;                     // -1 = se abre en la próxima lectura
+    uint64_t last_used;         // para reciclar la fuente menos usada si no caben más
+} ProcSource;
+
+// Registro de fuentes: cada fichero se abre una vez y se relee con pread desde el
+// offset 0 en un buffer compartido, sin fopen/fclose ni buffers de stdio por muestra.
+// Si la lectura falla (interfaz eliminada, PID terminado) se reabre una vez. No es
+// seguro entre hilos: cada registro pertenece a un único hilo recolector
+typedef struct {
+    ProcSource sources[PROC_SOURCE_MAX];
+    int count;
+    uint64_t clock;
+    ProcBuffer buffer;
+    uint64_t syscalls;          // open, pread y close hechos por el registro
+    uint64_t reopens;           // fuentes reabiertas tras perder su fichero
+} ProcRegistry;
+
+// Registro compartido por los recolectores del proceso
+ProcRegistry* proc_registry_shared(void);
+
+// Leer un fichero completo; el contenido (terminado en NUL) es válido hasta la
+// siguiente lectura del registro. Devuelve NULL si no existe o no se puede leer
+const char* proc_registry_read(ProcRegistry* registry, const char* path, size_t* length);
+
+// Cerrar una fuente que ya no interesa (p. ej. el PID ya no se sigue)
+void proc_registry_forget(ProcRegistry* registry, const char* path);
+void proc_registry_free(ProcRegistry* registry);
+
+// Parsear el contenido de /proc/net/{tcp,tcp6,udp,udp6} sin sscanf ni cadenas por fila.
+// Devuelve el número de filas añadidas a la lista, o -1 si no hay memoria
+int procnet_parse(const char* data, size_t length, int family, int protocol,
+                  uint32_t states, uint64_t timestamp_ns, ConnectionList* list);
+
+// Leer y parsear los cuatro ficheros de /proc/net
+int procnet_collect(ProcRegistry* registry, uint32_t states, ConnectionList* list);
+
+// Contar filas de un fichero de /proc/net sin parsearlas
+int procnet_count(ProcRegistry* registry, const char* path);
+
+#endif // PROCNET_H
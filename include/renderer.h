@@ -43,7 +43,7 @@ void draw_processes_table(int y, int x, TableData* table);
 // Funciones de barras de progreso
 void draw_progress_bar_advanced(int y, int x, int width, double percentage, 
                                const char* label, const char* value);
-void draw_latency_bars(int y, int x, const char* servers[], double latencies[], int count);
+void draw_latency_bars(int y, int x, int width, const LatencyTest tests[], int count);
 
 // Funciones de utilidad para renderizado
 void draw_horizontal_line(int y, int x, int width, char character);
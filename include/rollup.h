@@ -0,0 +1,60 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stdint.h>
+
+// Niveles de agregación: cubos de 1 s, 10 s, 1 min y 1 h, con ROLLUP_SLOTS cubos por
+// nivel (4 min, 40 min, 4 h y 10 días)
+#define ROLLUP_TIERS 4
+#define ROLLUP_SLOTS 240
+
+// Resumen de las muestras que cayeron en un cubo (count = 0: sin muestras)
+typedef struct {
+    double min;
+    double max;
+    double sum;
+    double last;
+    uint32_t count;
+} RollupBucket;
+
+// Candidato a máximo de una ventana que termina en el cubo actual
+typedef struct {
+    uint64_t time;              // índice de tiempo del cubo
+    double value;
+} RollupPeak;
+
+// Un nivel: anillo de cubos y cola monótona de máximos por cubo. La cola guarda los
+// cubos en orden de tiempo con máximos estrictamente decrecientes, así que el máximo
+// de cualquier ventana que acaba ahora es el primer candidato dentro de la ventana
+typedef struct {
+    uint64_t resolution_ns;
+    uint64_t current;           // índice de tiempo del cubo actual (marca / resolución)
+    int head;                   // posición del cubo actual en el anillo
+    int filled;                 // cubos con historia (hasta ROLLUP_SLOTS)
+    RollupBucket buckets[ROLLUP_SLOTS];
+    RollupPeak peaks[ROLLUP_SLOTS];
+    int peak_first;
+    int peak_count;
+} RollupTier;
+
+// Agregados de varias resoluciones en memoria constante: cada muestra actualiza un cubo
+// por nivel en O(1), sin guardar las muestras originales
+typedef struct {
+    RollupTier tiers[ROLLUP_TIERS];
+    uint64_t samples;
+} Rollup;
+
+void rollup_init(Rollup* rollup);
+
+// Añadir una muestra con su marca CLOCK_MONOTONIC en ns
+void rollup_add(Rollup* rollup, uint64_t timestamp_ns, double value);
+
+// Cubo de un nivel, age = 0 el actual y 1 el anterior. NULL si es más antiguo que la historia
+const RollupBucket* rollup_bucket(const Rollup* rollup, int tier, int age);
+
+// Máximo de los últimos buckets cubos del nivel (0 si no hay muestras)
+double rollup_window_max(const Rollup* rollup, int tier, int buckets);
+
+const char* rollup_tier_name(int tier);
+
+#endif // ROLLUP_H
@@ -0,0 +1,173 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "utils.h"
+#include "scheduler.h"
+#include "probe.h"
+#include "tsdb.h"
+#include <pthread.h>
+
+// Límites de una muestra (tamaño fijo: publicar una muestra no reserva memoria)
+#define SAMPLER_MAX_CONNECTIONS 64      // las primeras: la TUI dibuja 5, nx connections 10
+#define SAMPLER_MAX_INTERFACES 32
+#define SAMPLER_SLOTS 3             // publicada, en lectura y en escritura
+#define SAMPLER_MIN_PERIOD_MS 10
+
+// Secciones de la muestra, una por recolector y en su orden de ejecución
+#define SAMPLE_INTERFACES 0         // lista de interfaces y elección de la principal
+#define SAMPLE_LINKS 1              // contadores de la interfaz principal
+#define SAMPLE_ADDRESS 2            // IP de la interfaz principal
+#define SAMPLE_SOCKETS 3            // conexiones y sus procesos
+#define SAMPLE_PROCESSES 4          // número de procesos
+#define SAMPLE_LATENCY 5            // ecos a PROBE_DEFAULT_TARGETS
+#define SAMPLE_SECTIONS 6
+
+// Periodo y presupuesto de coste de cada recolector (ms). Lo que cambia despacio
+// se relee despacio; los contadores de enlace usan el periodo de sampler_start
+#define SAMPLER_LINKS_BUDGET_MS 5
+#define SAMPLER_INTERFACES_PERIOD_MS 500  // lectura de la tabla de enlaces de netlink
+#define SAMPLER_INTERFACES_BUDGET_MS 2
+#define SAMPLER_ADDRESS_PERIOD_MS 1000    // lectura de la caché de direcciones de netlink
+#define SAMPLER_ADDRESS_BUDGET_MS 1
+#define SAMPLER_SOCKETS_PERIOD_MS 2000
+#define SAMPLER_SOCKETS_BUDGET_MS 100
+#define SAMPLER_PROCESSES_PERIOD_MS 10000
+#define SAMPLER_PROCESSES_BUDGET_MS 50
+#define SAMPLER_LATENCY_PERIOD_MS 5000  // entre rondas del hilo de latencia
+#define SAMPLER_LATENCY_TIMEOUT_MS 500    // la ronda bloquea como mucho esto al hilo de latencia
+#define SAMPLER_LATENCY_BUDGET_MS 1       // el recolector solo copia la última ronda
+
+// Percentiles de latencia sobre las últimas SAMPLER_LATENCY_WINDOWS ventanas: cada
+// ventana tiene su histograma y al rotar se vacía la más antigua
+#define SAMPLER_LATENCY_TARGETS 8
+#define SAMPLER_LATENCY_WINDOWS 5
+#define SAMPLER_LATENCY_WINDOW_MS 60000
+#define SAMPLER_LATENCY_BINS 64
+
+// Límites (ms) de las cubetas acumuladas por destino que se exportan (nx exporter)
+#define SAMPLER_LATENCY_BOUNDS 12
+extern const double sampler_latency_bounds_ms[SAMPLER_LATENCY_BOUNDS];
+
+// Estados TCP del kernel (índice = estado, 1 = ESTABLISHED ... 12 = NEW_SYN_RECV)
+#define SAMPLER_TCP_STATES 13
+
+// Muestra inmutable de todo lo que dibuja la TUI
+typedef struct {
+    uint64_t sequence;              // 0 = todavía no hay muestra
+    uint64_t collected_ns[SAMPLE_SECTIONS];   // CLOCK_MONOTONIC de cada sección (0 = nunca)
+    double cost_ms[SAMPLE_SECTIONS];          // coste de la última recolección de cada sección
+    uint64_t proc_syscalls;         // llamadas a procfs/sysfs de la última ronda de recolección
+
+    // Ancho de banda de la interfaz principal
+    char interface[MAX_INTERFACE_NAME];
+    int has_interface;
+    char interface_ip[MAX_IP_ADDRESS];
+    NetworkStats stats;             // con velocidades sobre el intervalo medido
+    int has_speeds;
+
+    // Conexiones
+    Connection connections[SAMPLER_MAX_CONNECTIONS];
+    int connection_count;
+    int connection_total;           // TCP y UDP, aunque no quepan en connections
+    int tcp_states[SAMPLER_TCP_STATES];   // todas las conexiones TCP por estado
+    int udp_sockets;
+    int tcp_connections;
+    int processes;
+
+    // Interfaces
+    char interfaces[SAMPLER_MAX_INTERFACES][MAX_INTERFACE_NAME];
+    int interface_active[SAMPLER_MAX_INTERFACES];
+    NetworkStats interface_stats[SAMPLER_MAX_INTERFACES];  // contadores (sin velocidades)
+    int interface_count;
+    uint64_t history_errors;        // muestras que no se pudieron guardar en el historial
+
+    // Latencia (percentiles de las últimas ventanas)
+    LatencyTest latency[SAMPLER_LATENCY_TARGETS];
+    int latency_count;
+    double latency_distribution[SAMPLER_LATENCY_BINS];  // todos los destinos, para draw_histogram
+    int latency_bins;
+    double latency_max_ms;
+    uint64_t latency_buckets[SAMPLER_LATENCY_TARGETS][SAMPLER_LATENCY_BOUNDS];  // acumuladas
+    double latency_sum_ms[SAMPLER_LATENCY_TARGETS];
+} Snapshot;
+
+// Resultado de una ronda de latencia con los campos de latencia de Snapshot: lo deja
+// el hilo de latencia y el recolector de latencia lo copia en la muestra
+typedef struct {
+    LatencyTest latency[SAMPLER_LATENCY_TARGETS];
+    int latency_count;
+    double latency_distribution[SAMPLER_LATENCY_BINS];
+    int latency_bins;
+    double latency_max_ms;
+    uint64_t latency_buckets[SAMPLER_LATENCY_TARGETS][SAMPLER_LATENCY_BOUNDS];
+    double latency_sum_ms[SAMPLER_LATENCY_TARGETS];
+    uint64_t collected_ns;          // CLOCK_MONOTONIC de la ronda (0 = aún ninguna)
+} SamplerLatency;
+
+// Hilo de muestreo que conduce un planificador de varias frecuencias y publica por
+// triple buffer: el hilo copia los últimos valores en una ranura libre y la publica
+// con un único almacenamiento atómico; el lector marca la ranura que está leyendo
+// para que nunca se sobrescriba bajo sus pies
+// Los sondeos de latencia tienen su propio hilo: resolver los nombres y esperar los
+// ecos (hasta SAMPLER_LATENCY_TIMEOUT_MS) nunca retrasa a los demás recolectores
+typedef struct {
+    Snapshot slots[SAMPLER_SLOTS];
+    int published;                  // ranura publicada (-1 = ninguna)
+    int reading;                    // ranura marcada por el lector (-1 = ninguna)
+
+    pthread_t thread;
+    int timer_fd;                   // timerfd armado al siguiente recolector vencido
+    int wake_fd;                    // eventfd para refrescar o detener al momento
+    int publish_fd;                 // eventfd que se señala en cada publicación (para poll del lector)
+    int refresh_requested;
+    int stopping;
+    int running;
+
+    // Estado privado del hilo de muestreo
+    Scheduler scheduler;
+    Snapshot current;               // últimos valores de cada sección
+    NetworkStats previous;
+    int has_previous;
+    Tsdb history;                   // contadores de cada interfaz en cada lectura de enlaces
+    int history_ready;              // 0 si otro proceso ya graba el historial o no hay ruta
+
+    // Hilo de latencia y lo que comparte con el de muestreo (bajo latency_lock)
+    pthread_t latency_thread;
+    int latency_started;
+    pthread_mutex_t latency_lock;
+    pthread_cond_t latency_wake;    // despierta al hilo de latencia para detenerse
+    int latency_fd;                 // eventfd que se señala al terminar cada ronda
+    SamplerLatency latency_result;  // última ronda terminada
+
+    // Estado privado del hilo de latencia
+    ProbeEngine latency_engine;     // se abre (y resuelve nombres) al arrancar el hilo
+    int latency_ready;              // 0 = sin abrir, 1 = abierto, -1 = no disponible
+    int latency_targets[SAMPLER_LATENCY_TARGETS];   // índice en el motor (-1 = no resuelto)
+    LatencyHistogram latency_windows[SAMPLER_LATENCY_WINDOWS][SAMPLER_LATENCY_TARGETS];
+    int latency_window;
+    uint64_t latency_window_ns;     // inicio de la ventana actual
+    SamplerLatency latency_round;   // ronda en preparación
+} Sampler;
+
+// Ciclo de vida (links_period_ms: periodo de los contadores de enlace, desde
+// SAMPLER_MIN_PERIOD_MS)
+int sampler_start(Sampler* sampler, int links_period_ms);
+void sampler_stop(Sampler* sampler);
+
+// Pedir una muestra inmediata (p. ej. al pulsar R)
+void sampler_refresh(Sampler* sampler);
+
+// Descriptor legible cuando hay una muestra nueva publicada; el lector lo vacía con
+// sampler_drain antes de llamar a sampler_acquire
+int sampler_publish_fd(const Sampler* sampler);
+void sampler_drain(Sampler* sampler);
+
+// Obtener la última muestra publicada (NULL si aún no hay). Sigue siendo válida
+// hasta la siguiente llamada a sampler_acquire o sampler_release; un solo lector
+const Snapshot* sampler_acquire(Sampler* sampler);
+void sampler_release(Sampler* sampler);
+
+// Segundos desde que se recolectó una sección de la muestra (-1 si nunca)
+double snapshot_age(const Snapshot* snapshot, int section);
+
+#endif // SAMPLER_H
@@ -0,0 +1,54 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#define SCHEDULER_MAX_COLLECTORS 16
+#define SCHEDULER_MAX_BACKOFF 8         // un recolector caro se espacia como mucho 8x
+
+// Recolector: devuelve < 0 si falló (se reintenta en el siguiente periodo)
+typedef int (*CollectorFunction)(void* context);
+
+// Recolector registrado con su periodo y su presupuesto de coste
+typedef struct {
+    const char* name;
+    CollectorFunction collect;
+    void* context;
+    uint64_t period_ns;
+    uint64_t budget_ns;         // coste máximo por ejecución (0 = sin límite)
+    uint64_t next_due_ns;
+    uint64_t last_run_ns;       // última ejecución correcta (0 = nunca)
+    uint64_t last_cost_ns;
+    uint64_t total_cost_ns;
+    uint64_t runs;
+    uint64_t failures;
+    uint64_t over_budget;       // ejecuciones que superaron el presupuesto
+} ScheduledCollector;
+
+// Planificador de varias frecuencias: cada recolector corre a su propio ritmo y, si
+// supera su presupuesto, su periodo se alarga en proporción para limitar la CPU
+// que consume (presupuesto / periodo). No crea hilos: lo conduce quien lo llama
+typedef struct {
+    ScheduledCollector collectors[SCHEDULER_MAX_COLLECTORS];
+    int count;
+} Scheduler;
+
+void scheduler_init(Scheduler* scheduler);
+
+// Registrar un recolector; devuelve su índice o -1 si no caben más
+int scheduler_register(Scheduler* scheduler, const char* name, CollectorFunction collect,
+                       void* context, int period_ms, int budget_ms);
+
+// Ejecutar los recolectores vencidos en now_ns; devuelve cuántos se ejecutaron
+int scheduler_run_due(Scheduler* scheduler, uint64_t now_ns);
+
+// Ejecutar todos ya (p. ej. al pulsar R), sin esperar a su periodo
+int scheduler_run_all(Scheduler* scheduler, uint64_t now_ns);
+
+// Adelantar un recolector a now_ns (p. ej. cuando otro hilo dejó datos nuevos para él)
+void scheduler_trigger(Scheduler* scheduler, int index, uint64_t now_ns);
+
+// Instante del siguiente recolector vencido
+uint64_t scheduler_next_due(const Scheduler* scheduler);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,59 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#include "sampler.h"
+#include <stddef.h>
+
+// Segmento POSIX de memoria compartida donde `nx daemon` publica cada muestra. Los
+// visores (tui, status, connections) lo proyectan en solo lectura y copian la muestra
+// con un seqlock: el daemon nunca espera por ellos y diez visores cuestan lo que uno
+#define SHARED_MAGIC "NXSH"
+#define SHARED_VERSION 3
+#define SHARED_DEFAULT_NAME "/nx_snapshot"  // salvo que NX_SHM indique otro nombre
+#define SHARED_POLL_MS 250                  // cada cuánto mira un visor si hay muestra nueva
+#define SHARED_READ_RETRIES 1000            // copias descartadas antes de rendirse
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;                  // sizeof(SharedSegment): descarta binarios con otra disposición
+    int32_t pid;                    // proceso del daemon
+    uint32_t closed;                // 1 si el daemon salió de forma ordenada
+    uint64_t sequence;              // seqlock: impar mientras el daemon escribe
+    Snapshot snapshot;
+} SharedSegment;
+
+typedef struct {
+    int fd;
+    int writable;
+    SharedSegment* segment;
+    char name[64];
+    uint64_t copied;                // lector: secuencia de la última copia
+    char error[256];
+} SharedSnapshot;
+
+// Nombre por defecto: $NX_SHM o SHARED_DEFAULT_NAME
+int shared_default_name(char* buffer, size_t size);
+
+// Daemon: crear (o reutilizar tras una caída) el segmento. Un solo daemon por nombre
+// (flock); devuelve -1 con el motivo en shared->error
+int shared_create(SharedSnapshot* shared, const char* name);
+
+// Visor: proyectar en solo lectura el segmento de un daemon vivo. Devuelve -1 si no
+// hay daemon, si ya terminó o si lo compiló otra versión
+int shared_attach(SharedSnapshot* shared, const char* name);
+
+// El daemon marca el segmento como cerrado y lo elimina; el visor solo lo desproyecta
+void shared_close(SharedSnapshot* shared);
+
+// Publicar una muestra (solo el daemon)
+void shared_publish(SharedSnapshot* shared, const Snapshot* snapshot);
+
+// Copiar la última muestra si cambió desde la copia anterior: 1 = copia nueva,
+// 0 = sin cambios (o el daemon aún no publicó ninguna)
+int shared_read(SharedSnapshot* shared, Snapshot* snapshot);
+
+// El daemon sigue en marcha
+int shared_alive(const SharedSnapshot* shared);
+
+#endif // SHARED_H
@@ -0,0 +1,20 @@
+#ifndef SOCKDIAG_H
+#define SOCKDIAG_H
+
+#include "utils.h"
+
+// Tamaño del buffer de recepción (el kernel entrega como máximo 32 KB por lectura)
+#define SOCK_DIAG_RX_BUFFER (32 * 1024)
+
+// Socket NETLINK_SOCK_DIAG
+int sock_diag_open(void);
+void sock_diag_close(int fd);
+
+// Volcar los sockets de una familia y protocolo filtrando por estado en el kernel.
+// Devuelve el número de sockets añadidos a la lista, o -1 en error
+int sock_diag_collect(int fd, int family, int protocol, uint32_t states, ConnectionList* list);
+
+// Volcar TCP y UDP sobre IPv4 e IPv6
+int sock_diag_collect_all(int fd, uint32_t states, ConnectionList* list);
+
+#endif // SOCKDIAG_H
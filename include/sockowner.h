@@ -0,0 +1,75 @@
+#ifndef SOCKOWNER_H
+#define SOCKOWNER_H
+
+#include "utils.h"
+#include <pthread.h>
+
+// Límites del pool de escaneo de /proc/<pid>/fd
+#define SOCK_OWNER_MAX_THREADS 8
+#define SOCK_OWNER_COMM_LEN 16
+
+// Cada cuántos refrescos se reescanean todos los PIDs (detecta PIDs reutilizados,
+// fds reemplazados sin cambiar el total y kernels que no informan del número de fds)
+#define SOCK_OWNER_FULL_EVERY 10
+
+// Propietario de un socket
+typedef struct {
+    int pid;
+    char comm[SOCK_OWNER_COMM_LEN];
+} SocketOwner;
+
+// Estado de un PID en el índice
+typedef struct {
+    SocketOwner owner;
+    long long fd_signature;     // número de fds abiertos (st_size de /proc/<pid>/fd)
+    uint64_t* inodes;           // inodos de sockets abiertos por el proceso
+    int inode_count;
+    int inode_capacity;
+    int needs_scan;
+} PidEntry;
+
+// Índice inodo de socket -> (pid, comm) construido en paralelo
+typedef struct {
+    PidEntry* entries;          // ordenados por pid
+    int entry_count;
+    int entry_capacity;
+
+    int* slots;                 // tabla hash inodo -> índice de entrada + 1
+    uint64_t* keys;
+    int slot_count;             // potencia de 2
+    int socket_count;
+
+    int refreshes;              // número de refrescos realizados
+    int scanned_last;           // PIDs escaneados en el último refresco
+
+    // Pool de hilos
+    pthread_t threads[SOCK_OWNER_MAX_THREADS];
+    int thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    int queue_length;           // entradas a revisar en el trabajo actual
+    int queue_next;             // siguiente entrada (acceso atómico)
+    int full_scan;              // el trabajo actual reescanea todos los PIDs
+    int workers_busy;
+    int job_id;
+    int stopping;
+} SocketOwnerIndex;
+
+// Ciclo de vida (threads = 0 usa el número de CPUs)
+int sock_owner_init(SocketOwnerIndex* index, int threads);
+void sock_owner_free(SocketOwnerIndex* index);
+
+// Refrescar el índice reescaneando solo PIDs nuevos o con cambios en sus fds
+int sock_owner_refresh(SocketOwnerIndex* index);
+
+// Forzar un escaneo completo en el próximo refresco
+void sock_owner_invalidate(SocketOwnerIndex* index);
+
+// Consultar el propietario de un inodo (NULL si no se conoce)
+const SocketOwner* sock_owner_lookup(const SocketOwnerIndex* index, uint64_t inode);
+
+// Rellenar pid y proceso de un array de conexiones
+void sock_owner_resolve(const SocketOwnerIndex* index, Connection* connections, int count);
+
+#endif // SOCKOWNER_H
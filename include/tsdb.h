@@ -0,0 +1,100 @@
+#ifndef TSDB_H
+#define TSDB_H
+
+#include "utils.h"
+#include <stddef.h>
+
+// Formato del fichero: una página de cabecera y un anillo de bloques de tamaño fijo.
+// Al llenarse el anillo se recicla el bloque más antiguo, así que el disco ocupado
+// no pasa de TSDB_BLOCK_SIZE * (bloques + 1)
+#define TSDB_MAGIC "NXTS"
+#define TSDB_VERSION 1
+#define TSDB_BLOCK_SIZE 4096
+#define TSDB_DEFAULT_BLOCKS 4096        // 16 MiB: unas semanas de muestras de 1 s de una interfaz
+#define TSDB_MAX_SERIES 32              // series con bloque abierto a la vez por escritor (una por interfaz del muestreador)
+#define TSDB_DEFAULT_FILE ".nx_history" // en $HOME salvo que NX_HISTORY indique otra ruta
+
+// Cabecera de cada bloque. Las muestras van comprimidas a continuación: marcas de
+// tiempo en ms con delta de deltas y contadores con XOR respecto al anterior
+typedef struct {
+    uint64_t sequence;              // orden de creación (0 = libre)
+    char series[MAX_INTERFACE_NAME];
+    uint64_t first_ms;              // CLOCK_REALTIME de la primera muestra
+    uint64_t last_ms;
+    uint32_t count;                 // muestras publicadas (lo último que escribe el escritor)
+    uint32_t bits;                  // bits usados de data
+} TsdbBlockHeader;
+
+#define TSDB_BLOCK_DATA (TSDB_BLOCK_SIZE - sizeof(TsdbBlockHeader))
+
+typedef struct {
+    TsdbBlockHeader header;
+    uint8_t data[TSDB_BLOCK_DATA];
+} TsdbBlock;
+
+// Página 0 del fichero
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint64_t sequence;              // último número de secuencia asignado
+    uint32_t next_block;            // siguiente bloque del anillo que se recicla
+} TsdbFileHeader;
+
+// Muestra de una serie (contadores acumulados de la interfaz)
+typedef struct {
+    uint64_t timestamp_ms;
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+} TsdbSample;
+
+// Estado del compresor de una serie (solo en memoria del escritor)
+typedef struct {
+    char series[MAX_INTERFACE_NAME];
+    int block;                      // bloque abierto (-1 = ninguno)
+    uint64_t last_ms;
+    int64_t last_delta;
+    uint64_t last_values[2];
+    int leading[2];                 // ventana de bits significativos del último XOR
+    int trailing[2];
+} TsdbSeries;
+
+// Fichero de series temporales proyectado con mmap. Un solo escritor (flock) añade
+// muestras directamente sobre la proyección; los lectores la recorren sin copiarla
+// y descartan el bloque si el escritor lo recicla mientras lo leen
+typedef struct {
+    int fd;
+    int writable;
+    uint8_t* base;
+    size_t size;
+    TsdbFileHeader* header;
+    TsdbBlock* blocks;              // block_count bloques, desde la página 1
+    TsdbSeries series[TSDB_MAX_SERIES];
+    int series_count;
+    char error[256];
+} Tsdb;
+
+// Ruta por defecto: $NX_HISTORY o $HOME/TSDB_DEFAULT_FILE
+int tsdb_default_path(char* buffer, size_t size);
+
+// Abrir para leer, o para escribir (crea el fichero con blocks bloques si no existe;
+// si ya existe conserva su tamaño). Devuelve -1 con el motivo en db->error
+int tsdb_open(Tsdb* db, const char* path, int writable, int blocks);
+void tsdb_close(Tsdb* db);
+
+// Añadir una muestra a una serie (marcas de tiempo crecientes)
+int tsdb_append(Tsdb* db, const char* series, const TsdbSample* sample);
+
+// Recorrer en orden las muestras de una serie en [from_ms, to_ms]. Devuelve cuántas
+// se visitaron, o -1 si no hay memoria
+typedef void (*TsdbVisitor)(const TsdbSample* sample, void* context);
+int tsdb_scan(Tsdb* db, const char* series, uint64_t from_ms, uint64_t to_ms,
+              TsdbVisitor visit, void* context);
+
+// Hora actual en ms (CLOCK_REALTIME) y lectura de "now", "-30m", "-2h", "-1d",
+// segundos Unix o "AAAA-MM-DD[ HH:MM[:SS]]" en hora local
+uint64_t tsdb_now_ms(void);
+int tsdb_parse_time(const char* text, uint64_t now_ms, uint64_t* result_ms);
+
+#endif // TSDB_H
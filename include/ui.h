@@ -2,11 +2,13 @@
 #define UI_H
 
 #include "utils.h"
+#include "sampler.h"
 
 // Constantes para la interfaz
 #define MAX_WIDTH 80
 #define MAX_HEIGHT 24
-#define REFRESH_RATE 1000  // milisegundos
+#define REFRESH_RATE 1000  // milisegundos entre lecturas de contadores de enlace
+#define TUI_TICK_MS 1000   // tick de la línea de estado (edades en segundos enteros)
 
 // Colores disponibles
 #define COLOR_NORMAL 1
@@ -21,11 +23,17 @@ void cleanup_ui(void);
 void setup_colors(void);
 
 // Funciones de dibujo
+void draw_chrome(void);
+
+// Un fotograma completo con la muestra dada (NULL = aún no hay): el marco si chrome, las
+// secciones cuyos valores cambiaron y doupdate(). Devuelve las secciones redibujadas
+int draw_frame(const Snapshot* frame, int chrome);
 void draw_header(void);
 void draw_footer(void);
 void draw_bandwidth_section(void);
 void draw_connections_section(void);
 void draw_interfaces_section(void);
+void draw_latency_section(void);
 void draw_stats_section(void);
 
 // Funciones de actualización
@@ -6,12 +6,13 @@
 
 // Constantes para límites de tamaño
 #define MAX_INTERFACE_NAME 32
-#define MAX_IP_ADDRESS 16
+#define MAX_IP_ADDRESS 46   // INET6_ADDRSTRLEN
 #define MAX_PROCESS_NAME 64
 #define MAX_SERVER_NAME 64
 #define MAX_ALERT_MESSAGE 256
 #define MAX_CONNECTIONS 1000
 #define MAX_LATENCY_SERVERS 10
+#define MAX_FORMATTED 32    // resultado de format_speed y format_bytes
 
 // Estructura para estadísticas de red
 typedef struct {
@@ -22,27 +23,48 @@ typedef struct {
     double rx_speed;        // velocidad de descarga (MB/s)
     double tx_speed;        // velocidad de subida (MB/s)
     double total_speed;     // velocidad total
-    time_t timestamp;       // timestamp de la medición
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC en ns, tomado junto a la lectura de contadores
 } NetworkStats;
 
-// Estructura para conexiones de red
+// Estados TCP del kernel más usados y máscara para filtrar conexiones (1 << estado)
+#define CONN_STATE_ESTABLISHED 1
+#define CONN_STATE_LISTEN 10
+#define CONN_STATES_ALL 0xffffffffu
+
+// Estructura para conexiones de red (direcciones en binario, IPv4 en los 4 primeros bytes)
 typedef struct {
-    char local_ip[MAX_IP_ADDRESS];
-    int local_port;
-    char remote_ip[MAX_IP_ADDRESS];
-    int remote_port;
-    char state[16];
+    uint8_t local_addr[16];
+    uint8_t remote_addr[16];
+    uint8_t family;         // AF_INET o AF_INET6
+    uint8_t protocol;       // IPPROTO_TCP o IPPROTO_UDP
+    uint8_t state;          // estado TCP del kernel (1 = ESTABLISHED ... 12 = NEW_SYN_RECV)
+    uint16_t local_port;
+    uint16_t remote_port;
+    uint32_t uid;
+    uint64_t inode;         // inodo del socket
     char process[MAX_PROCESS_NAME];
     int pid;
-    time_t timestamp;
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC de la lectura
 } Connection;
 
+// Lista de conexiones que crece sin límite fijo
+typedef struct {
+    Connection* items;
+    int count;
+    int capacity;
+} ConnectionList;
+
 // Estructura para pruebas de latencia
 typedef struct {
     char server[MAX_SERVER_NAME];
     double latency;         // en milisegundos
     int status;             // 0 = OK, 1 = timeout, 2 = error
     time_t timestamp;
+    double p50;             // percentiles de todos los sondeos (ms, -1 = sin datos)
+    double p99;
+    double p999;
+    double max;
+    uint64_t samples;
 } LatencyTest;
 
 // Estructura para alertas
@@ -55,14 +77,27 @@ typedef struct {
 
 // Funciones de utilidad básicas
 double bytes_to_mbps(uint64_t bytes, double time_diff);
-char* format_speed(double speed);
-char* format_bytes(uint64_t bytes);
+char* format_speed(double speed, char* buffer, int size);
+char* format_bytes(uint64_t bytes, char* buffer, int size);
 char* get_process_name(int pid);
 char* get_interface_name(void);
 time_t get_current_timestamp(void);
 void sleep_ms(int milliseconds);
 
-// Funciones de interfaz
-char* get_interface_ip(const char* interface);
+// Reloj monotónico para medir intervalos (nunca retrocede con ajustes de hora)
+#define NS_PER_SECOND 1000000000ULL
+uint64_t monotonic_ns(void);
+double elapsed_seconds(uint64_t start_ns, uint64_t end_ns);
+
+// Temporizador periódico con timerfd (periodos desde 1 ms, sin deriva acumulada)
+int ticker_open(int period_ms);
+uint64_t ticker_wait(int fd);   // bloquea hasta el siguiente tick; devuelve ticks vencidos
+void ticker_close(int fd);
+
+// Funciones de conexiones
+Connection* connection_list_append(ConnectionList* list);
+const char* connection_state_name(int state);
+const char* connection_protocol_name(const Connection* conn);
+char* format_ip_address(int family, const uint8_t* addr, char* buffer, int size);
 
 #endif // UTILS_H
@@ -0,0 +1,570 @@
+#define _GNU_SOURCE
+#include "capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <netinet/in.h>
+
+// ============================================================================
+// PARSEO DE CABECERAS
+// ============================================================================
+
+static uint16_t read_be16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Extraer la 5-tupla. Devuelve 0 si el paquete es IPv4/IPv6, -1 en otro caso
+int capture_parse_packet(const uint8_t* data, uint32_t caplen, int linktype, FlowKey* key) {
+    uint32_t offset;
+    uint16_t ethertype;
+
+    switch (linktype) {
+        case CAPTURE_LINK_ETHERNET:
+            if (caplen < 14) return -1;
+            ethertype = read_be16(data + 12);
+            offset = 14;
+            // Saltar etiquetas VLAN (802.1Q y 802.1ad)
+            while ((ethertype == 0x8100 || ethertype == 0x88a8) && caplen >= offset + 4) {
+                ethertype = read_be16(data + offset + 2);
+                offset += 4;
+            }
+            break;
+        case CAPTURE_LINK_SLL:
+            if (caplen < 16) return -1;
+            ethertype = read_be16(data + 14);
+            offset = 16;
+            break;
+        case CAPTURE_LINK_SLL2:
+            if (caplen < 20) return -1;
+            ethertype = read_be16(data);
+            offset = 20;
+            break;
+        case CAPTURE_LINK_RAW:
+            if (caplen < 1) return -1;
+            ethertype = (data[0] >> 4) == 6 ? 0x86dd : 0x0800;
+            offset = 0;
+            break;
+        default:
+            return -1;
+    }
+
+    memset(key, 0, sizeof(FlowKey));
+    const uint8_t* ip = data + offset;
+    uint32_t remaining = caplen - offset;
+    uint32_t l4_offset;
+
+    if (ethertype == 0x0800) {
+        if (remaining < 20 || (ip[0] >> 4) != 4) return -1;
+        l4_offset = (ip[0] & 0x0f) * 4;
+        key->family = AF_INET;
+        key->protocol = ip[9];
+        memcpy(key->src, ip + 12, 4);
+        memcpy(key->dst, ip + 16, 4);
+        // Los fragmentos que no son el primero no llevan cabecera L4
+        if (read_be16(ip + 6) & 0x1fff) return 0;
+    } else if (ethertype == 0x86dd) {
+        if (remaining < 40) return -1;
+        uint8_t next = ip[6];
+        l4_offset = 40;
+        key->family = AF_INET6;
+        memcpy(key->src, ip + 8, 16);
+        memcpy(key->dst, ip + 24, 16);
+        // Cabeceras de extensión habituales: hop-by-hop, routing, destino
+        while ((next == 0 || next == 43 || next == 60) && remaining >= l4_offset + 8) {
+            next = ip[l4_offset];
+            l4_offset += (ip[l4_offset + 1] + 1) * 8;
+        }
+        key->protocol = next;
+    } else {
+        return -1;
+    }
+
+    if ((key->protocol == IPPROTO_TCP || key->protocol == IPPROTO_UDP) && remaining >= l4_offset + 4) {
+        key->sport = read_be16(ip + l4_offset);
+        key->dport = read_be16(ip + l4_offset + 2);
+    }
+
+    return 0;
+}
+
+void capture_account_packet(CaptureWorker* worker, const uint8_t* data, uint32_t caplen, uint32_t wire_len) {
+    FlowKey key;
+    if (capture_parse_packet(data, caplen, worker->linktype, &key) == 0) {
+        flow_table_add(&worker->flows, &key, wire_len);
+    }
+}
+
+// ============================================================================
+// SELECCIÓN DE BACKEND
+// ============================================================================
+
+static int backend_open(CaptureWorker* worker) {
+    if (worker->cap->config.backend == CAPTURE_BACKEND_RING) {
+        return ring_backend_open(worker);
+    }
+    return pcap_backend_open(worker);
+}
+
+static int backend_dispatch(CaptureWorker* worker) {
+    if (worker->cap->config.backend == CAPTURE_BACKEND_RING) {
+        return ring_backend_dispatch(worker);
+    }
+    return pcap_backend_dispatch(worker);
+}
+
+static void backend_break(CaptureWorker* worker) {
+    if (worker->cap->config.backend == CAPTURE_BACKEND_RING) {
+        ring_backend_break(worker);
+    } else {
+        pcap_backend_break(worker);
+    }
+}
+
+static void backend_stats(CaptureWorker* worker, CaptureStats* stats) {
+    if (worker->cap->config.backend == CAPTURE_BACKEND_RING) {
+        ring_backend_stats(worker, stats);
+    } else {
+        pcap_backend_stats(worker, stats);
+    }
+}
+
+static void backend_close(CaptureWorker* worker) {
+    if (worker->cap->config.backend == CAPTURE_BACKEND_RING) {
+        ring_backend_close(worker);
+    } else {
+        pcap_backend_close(worker);
+    }
+}
+
+// ============================================================================
+// HILOS DE CAPTURA
+// ============================================================================
+
+static void* capture_main(void* arg) {
+    CaptureWorker* worker = arg;
+    Capture* cap = worker->cap;
+
+    while (!__atomic_load_n(&cap->stopping, __ATOMIC_ACQUIRE)) {
+        if (backend_dispatch(worker) < 0) {
+            break;
+        }
+
+        // Confirmar al consumidor entre lotes que todo lo despachado ya está en la tabla
+        if (__atomic_load_n(&worker->sync_requested, __ATOMIC_ACQUIRE)) {
+            pthread_mutex_lock(&cap->lock);
+            backend_stats(worker, &worker->backend_stats);
+            worker->sync_requested = 0;
+            pthread_cond_broadcast(&cap->synced);
+            pthread_mutex_unlock(&cap->lock);
+        }
+    }
+
+    pthread_mutex_lock(&cap->lock);
+    worker->running = 0;
+    cap->running--;
+    pthread_cond_broadcast(&cap->synced);
+    pthread_mutex_unlock(&cap->lock);
+    return NULL;
+}
+
+void capture_default_config(CaptureConfig* config) {
+    config->backend = CAPTURE_BACKEND_PCAP;
+    config->threads = 1;
+    config->block_size = CAPTURE_RING_BLOCK_SIZE;
+    config->block_count = CAPTURE_RING_BLOCK_COUNT;
+    config->block_timeout_ms = CAPTURE_RING_TIMEOUT_MS;
+}
+
+// Número de hilos a usar: libpcap no expone PACKET_FANOUT, así que solo el anillo escala
+static int capture_thread_count(const CaptureConfig* config) {
+    int threads = config->threads;
+    if (config->backend != CAPTURE_BACKEND_RING) {
+        return 1;
+    }
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) threads = 1;
+    if (threads > CAPTURE_MAX_THREADS) threads = CAPTURE_MAX_THREADS;
+    return threads;
+}
+
+// Detener y liberar los hilos abiertos (también tras un arranque parcial)
+static void release_workers(Capture* cap) {
+    __atomic_store_n(&cap->stopping, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < cap->worker_count; i++) {
+        if (cap->workers[i].started) {
+            backend_break(&cap->workers[i]);
+        }
+    }
+
+    for (int i = 0; i < cap->worker_count; i++) {
+        CaptureWorker* worker = &cap->workers[i];
+        if (worker->started) {
+            pthread_join(worker->thread, NULL);
+        }
+        backend_close(worker);
+        flow_table_free(&worker->flows);
+    }
+
+    cap->worker_count = 0;
+    pthread_mutex_destroy(&cap->lock);
+    pthread_cond_destroy(&cap->synced);
+}
+
+int capture_start(Capture* cap, const char* interface, const CaptureConfig* config) {
+    static int fanout_sequence = 0;
+
+    memset(cap, 0, sizeof(Capture));
+    if (config) {
+        cap->config = *config;
+    } else {
+        capture_default_config(&cap->config);
+    }
+    if (interface && strcmp(interface, "any") != 0) {
+        strncpy(cap->interface, interface, MAX_INTERFACE_NAME - 1);
+    }
+
+    int threads = capture_thread_count(&cap->config);
+    cap->config.threads = threads;
+    cap->fanout_group = (getpid() + fanout_sequence++) & 0xffff;
+    pthread_mutex_init(&cap->lock, NULL);
+    pthread_cond_init(&cap->synced, NULL);
+
+    // Abrir todos los anillos antes de arrancar hilos: el grupo de fanout debe estar
+    // completo para que el reparto por hash sea estable desde el primer paquete
+    for (int i = 0; i < threads; i++) {
+        CaptureWorker* worker = &cap->workers[i];
+        worker->cap = cap;
+        worker->index = i;
+        worker->ring.fd = -1;
+        worker->ring.wake_fd = -1;
+        cap->worker_count++;
+
+        if (flow_table_init(&worker->flows, CAPTURE_FLOW_SLOTS) < 0) {
+            snprintf(cap->error, sizeof(cap->error), "sin memoria para la tabla de flujos");
+            release_workers(cap);
+            return -1;
+        }
+        if (backend_open(worker) < 0) {
+            release_workers(cap);
+            return -1;
+        }
+    }
+
+    cap->last_update = (double)monotonic_ns() / NS_PER_SECOND;
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 0; i < threads; i++) {
+        CaptureWorker* worker = &cap->workers[i];
+        worker->running = 1;
+        cap->running++;
+
+        if (pthread_create(&worker->thread, NULL, capture_main, worker) != 0) {
+            snprintf(cap->error, sizeof(cap->error), "no se pudo crear el hilo de captura %d", i);
+            worker->running = 0;
+            cap->running--;
+            release_workers(cap);
+            return -1;
+        }
+        worker->started = 1;
+
+        // Un hilo por núcleo: fijarlo evita que dos anillos compitan por la misma CPU
+        if (threads > 1 && cpus > 1) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % cpus, &set);
+            pthread_setaffinity_np(worker->thread, sizeof(set), &set);
+        }
+    }
+
+    return 0;
+}
+
+void capture_stop(Capture* cap) {
+    if (cap->worker_count == 0) {
+        return;
+    }
+
+    release_workers(cap);
+    free(cap->processes);
+    cap->processes = NULL;
+    cap->process_count = 0;
+}
+
+// ============================================================================
+// ATRIBUCIÓN A PROCESOS
+// ============================================================================
+
+// Índice temporal de sockets locales: clave (local -> remoto) -> conexión
+typedef struct {
+    FlowKey* keys;
+    int* slots;                 // índice de conexión + 1
+    int size;                   // potencia de 2
+} SocketMap;
+
+// Clave de un extremo local; las direcciones IPv4 mapeadas en IPv6 se normalizan a IPv4
+static void make_key(FlowKey* key, int family, int protocol, const uint8_t* local, uint16_t lport,
+                     const uint8_t* remote, uint16_t rport) {
+    static const uint8_t v4_mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+    memset(key, 0, sizeof(FlowKey));
+    key->protocol = protocol;
+    key->sport = lport;
+    key->dport = rport;
+
+    if (family == AF_INET6 && memcmp(local, v4_mapped, 12) == 0 &&
+        (memcmp(remote, v4_mapped, 12) == 0 || rport == 0)) {
+        key->family = AF_INET;
+        memcpy(key->src, local + 12, 4);
+        if (rport != 0) memcpy(key->dst, remote + 12, 4);
+        return;
+    }
+
+    int length = family == AF_INET6 ? 16 : 4;
+    key->family = family;
+    memcpy(key->src, local, length);
+    memcpy(key->dst, remote, length);
+}
+
+static int socket_map_build(SocketMap* map, const Connection* connections, int count) {
+    map->size = 1024;
+    while (map->size < count * 2) {
+        map->size *= 2;
+    }
+    map->keys = malloc(map->size * sizeof(FlowKey));
+    map->slots = calloc(map->size, sizeof(int));
+    if (!map->keys || !map->slots) {
+        free(map->keys);
+        free(map->slots);
+        return -1;
+    }
+
+    uint32_t mask = map->size - 1;
+    for (int i = 0; i < count; i++) {
+        const Connection* conn = &connections[i];
+        if (conn->pid <= 0) continue;
+
+        FlowKey key;
+        make_key(&key, conn->family, conn->protocol, conn->local_addr, conn->local_port,
+                 conn->remote_addr, conn->remote_port);
+
+        uint32_t slot = flow_key_hash(&key) & mask;
+        while (map->slots[slot] != 0 && memcmp(&map->keys[slot], &key, sizeof(FlowKey)) != 0) {
+            slot = (slot + 1) & mask;
+        }
+        if (map->slots[slot] == 0) {
+            map->keys[slot] = key;
+            map->slots[slot] = i + 1;
+        }
+    }
+
+    return 0;
+}
+
+static int socket_map_find(const SocketMap* map, const FlowKey* key) {
+    uint32_t mask = map->size - 1;
+    uint32_t slot = flow_key_hash(key) & mask;
+    while (map->slots[slot] != 0) {
+        if (memcmp(&map->keys[slot], key, sizeof(FlowKey)) == 0) {
+            return map->slots[slot] - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// Buscar el socket local de un extremo del flujo: conexión exacta, socket sin
+// conectar en la dirección local y socket escuchando en todas las direcciones
+static int find_local_socket(const SocketMap* map, const FlowKey* flow, int outgoing) {
+    static const uint8_t any[16] = {0};
+    const uint8_t* local = outgoing ? flow->src : flow->dst;
+    const uint8_t* remote = outgoing ? flow->dst : flow->src;
+    uint16_t lport = outgoing ? flow->sport : flow->dport;
+    uint16_t rport = outgoing ? flow->dport : flow->sport;
+    FlowKey key;
+    int index;
+
+    make_key(&key, flow->family, flow->protocol, local, lport, remote, rport);
+    if ((index = socket_map_find(map, &key)) >= 0) return index;
+
+    make_key(&key, flow->family, flow->protocol, local, lport, any, 0);
+    if ((index = socket_map_find(map, &key)) >= 0) return index;
+
+    make_key(&key, flow->family, flow->protocol, any, lport, any, 0);
+    if ((index = socket_map_find(map, &key)) >= 0) return index;
+
+    // Socket IPv6 de doble pila escuchando en [::]
+    if (flow->family == AF_INET) {
+        make_key(&key, AF_INET6, flow->protocol, any, lport, any, 0);
+        if ((index = socket_map_find(map, &key)) >= 0) return index;
+    }
+
+    return -1;
+}
+
+// Buscar o insertar un proceso en el array ordenado por pid
+static ProcessTraffic* process_slot(Capture* cap, const Connection* conn) {
+    int low = 0, high = cap->process_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (cap->processes[mid].pid < conn->pid) low = mid + 1;
+        else high = mid;
+    }
+
+    if (low < cap->process_count && cap->processes[low].pid == conn->pid) {
+        return &cap->processes[low];
+    }
+
+    if (cap->process_count == cap->process_capacity) {
+        int capacity = cap->process_capacity > 0 ? cap->process_capacity * 2 : 64;
+        ProcessTraffic* processes = realloc(cap->processes, capacity * sizeof(ProcessTraffic));
+        if (!processes) return NULL;
+        cap->processes = processes;
+        cap->process_capacity = capacity;
+    }
+
+    memmove(&cap->processes[low + 1], &cap->processes[low],
+            (cap->process_count - low) * sizeof(ProcessTraffic));
+    cap->process_count++;
+
+    ProcessTraffic* process = &cap->processes[low];
+    memset(process, 0, sizeof(ProcessTraffic));
+    process->pid = conn->pid;
+    memcpy(process->comm, conn->process, MAX_PROCESS_NAME);
+    process->comm[MAX_PROCESS_NAME - 1] = '\0';
+    return process;
+}
+
+// Atribuir un flujo retirado al proceso dueño de su socket local
+static void attribute_flow(Capture* cap, const FlowCounter* flow, const SocketMap* map, const Connection* connections) {
+    int index = find_local_socket(map, &flow->key, 1);
+    int outgoing = index >= 0;
+    if (!outgoing) {
+        index = find_local_socket(map, &flow->key, 0);
+    }
+
+    ProcessTraffic* process = index >= 0 ? process_slot(cap, &connections[index]) : NULL;
+    if (!process) {
+        cap->totals.unattributed += flow->bytes;
+        return;
+    }
+
+    if (outgoing) {
+        process->tx_bytes += flow->bytes;
+    } else {
+        process->rx_bytes += flow->bytes;
+    }
+}
+
+int capture_update(Capture* cap, const Connection* connections, int count) {
+    // Pedir a cada hilo que termine su lote actual y esperar a todos
+    pthread_mutex_lock(&cap->lock);
+    for (int i = 0; i < cap->worker_count; i++) {
+        CaptureWorker* worker = &cap->workers[i];
+        if (worker->running) {
+            __atomic_store_n(&worker->sync_requested, 1, __ATOMIC_RELEASE);
+            backend_break(worker);
+        }
+    }
+    for (int i = 0; i < cap->worker_count; i++) {
+        CaptureWorker* worker = &cap->workers[i];
+        while (worker->sync_requested && worker->running) {
+            pthread_cond_wait(&cap->synced, &cap->lock);
+        }
+    }
+
+    // Los descartes y la ocupación son la suma de todos los anillos
+    CaptureStats* totals = &cap->totals;
+    totals->kernel_drops = 0;
+    totals->interface_drops = 0;
+    totals->ring_freezes = 0;
+    totals->ring_blocks_used = 0;
+    totals->ring_blocks_total = 0;
+    for (int i = 0; i < cap->worker_count; i++) {
+        const CaptureStats* backend = &cap->workers[i].backend_stats;
+        totals->kernel_drops += backend->kernel_drops;
+        totals->interface_drops += backend->interface_drops;
+        totals->ring_freezes += backend->ring_freezes;
+        totals->ring_blocks_used += backend->ring_blocks_used;
+        totals->ring_blocks_total += backend->ring_blocks_total;
+    }
+    totals->threads = cap->running;
+    int running = cap->running > 0;
+    pthread_mutex_unlock(&cap->lock);
+
+    SocketMap map;
+    int mapped = socket_map_build(&map, connections, count) == 0;
+    double now = (double)monotonic_ns() / NS_PER_SECOND;
+    uint64_t overflow_packets = 0;
+
+    totals->flow_overflows = 0;
+    totals->flow_evictions = 0;
+    totals->flow_occupied = 0;
+    totals->flow_capacity = 0;
+
+    // Los hilos siguen escribiendo mientras se retiran sus contadores
+    for (int i = 0; i < cap->worker_count; i++) {
+        FlowTable* flows = &cap->workers[i].flows;
+        FlowCounter flow;
+        for (int position = 0; (position = flow_table_drain_next(flows, position, &flow)) >= 0; ) {
+            cap->drained_packets += flow.packets;
+            cap->drained_bytes += flow.bytes;
+            if (mapped) {
+                attribute_flow(cap, &flow, &map, connections);
+            }
+        }
+        flow_table_expire(flows, (uint32_t)now, CAPTURE_FLOW_IDLE_SECONDS);
+
+        FlowTableStats stats;
+        flow_table_get_stats(flows, &stats);
+        overflow_packets += stats.overflow_packets;
+        totals->flow_overflows += stats.overflow_bytes;
+        totals->flow_evictions += stats.evictions;
+        totals->flow_occupied += stats.occupied;
+        totals->flow_capacity += stats.capacity;
+    }
+
+    totals->packets = cap->drained_packets + overflow_packets;
+    totals->bytes = cap->drained_bytes + totals->flow_overflows;
+
+    if (!mapped) {
+        return -1;
+    }
+    free(map.keys);
+    free(map.slots);
+
+    // Velocidades del intervalo medido
+    double elapsed = now - cap->last_update;
+    cap->last_update = now;
+
+    for (int i = 0; i < cap->process_count; i++) {
+        ProcessTraffic* process = &cap->processes[i];
+        process->rx_speed = bytes_to_mbps(process->rx_bytes - process->last_rx, elapsed);
+        process->tx_speed = bytes_to_mbps(process->tx_bytes - process->last_tx, elapsed);
+        process->last_rx = process->rx_bytes;
+        process->last_tx = process->tx_bytes;
+    }
+
+    return running ? cap->process_count : -1;
+}
+
+const ProcessTraffic* capture_get_process(const Capture* cap, int pid) {
+    int low = 0, high = cap->process_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (cap->processes[mid].pid < pid) low = mid + 1;
+        else high = mid;
+    }
+    if (low < cap->process_count && cap->processes[low].pid == pid) {
+        return &cap->processes[low];
+    }
+    return NULL;
+}
+
+void capture_get_stats(Capture* cap, CaptureStats* stats) {
+    *stats = cap->totals;
+}
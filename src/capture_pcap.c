@@ -0,0 +1,71 @@
+#define _GNU_SOURCE
+#include "capture.h"
+#include <stdio.h>
+#include <string.h>
+#include <pcap.h>
+
+// Callback de pcap_dispatch: solo cabeceras, sin copias
+static void handle_packet(unsigned char* user, const struct pcap_pkthdr* header, const unsigned char* data) {
+    capture_account_packet((CaptureWorker*)user, data, header->caplen, header->len);
+}
+
+int pcap_backend_open(CaptureWorker* worker) {
+    Capture* cap = worker->cap;
+    char errbuf[PCAP_ERRBUF_SIZE];
+    const char* device = cap->interface[0] ? cap->interface : "any";
+
+    errbuf[0] = '\0';
+    pcap_t* handle = pcap_create(device, errbuf);
+    if (!handle) {
+        snprintf(cap->error, sizeof(cap->error), "pcap_create(%s): %.200s", device, errbuf);
+        return -1;
+    }
+
+    pcap_set_snaplen(handle, CAPTURE_SNAPLEN);
+    pcap_set_promisc(handle, 0);
+    pcap_set_timeout(handle, CAPTURE_TIMEOUT_MS);
+    pcap_set_buffer_size(handle, CAPTURE_BUFFER_SIZE);
+
+    int status = pcap_activate(handle);
+    if (status < 0) {
+        snprintf(cap->error, sizeof(cap->error), "pcap_activate(%s): %.200s", device, pcap_geterr(handle));
+        pcap_close(handle);
+        return -1;
+    }
+
+    worker->handle = handle;
+    worker->linktype = pcap_datalink(handle);
+    return 0;
+}
+
+// Procesar un lote de paquetes. Devuelve -1 si la captura terminó con error
+int pcap_backend_dispatch(CaptureWorker* worker) {
+    int result = pcap_dispatch(worker->handle, -1, handle_packet, (unsigned char*)worker);
+    if (result == -1) {
+        snprintf(worker->cap->error, sizeof(worker->cap->error), "pcap_dispatch: %.200s", pcap_geterr(worker->handle));
+        return -1;
+    }
+    return result < 0 ? 0 : result;   // -2 = pcap_breakloop
+}
+
+void pcap_backend_break(CaptureWorker* worker) {
+    if (worker->handle) {
+        pcap_breakloop(worker->handle);
+    }
+}
+
+// Leer descartes acumulados (llamar solo desde el hilo de captura)
+void pcap_backend_stats(CaptureWorker* worker, CaptureStats* stats) {
+    struct pcap_stat ps;
+    if (worker->handle && pcap_stats(worker->handle, &ps) == 0) {
+        stats->kernel_drops = ps.ps_drop;
+        stats->interface_drops = ps.ps_ifdrop;
+    }
+}
+
+void pcap_backend_close(CaptureWorker* worker) {
+    if (worker->handle) {
+        pcap_close(worker->handle);
+        worker->handle = NULL;
+    }
+}
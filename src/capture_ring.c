@@ -0,0 +1,241 @@
+#define _GNU_SOURCE
+#include "capture.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+
+// Filtro BPF que solo recorta: el kernel copia al anillo como máximo CAPTURE_SNAPLEN bytes
+static int attach_snaplen_filter(int fd) {
+    struct sock_filter code[] = {
+        { BPF_RET | BPF_K, 0, 0, CAPTURE_SNAPLEN },
+    };
+    struct sock_fprog program = { 1, code };
+    return setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program));
+}
+
+// Unir el anillo al grupo PACKET_FANOUT: el kernel reparte los paquetes por hash de flujo.
+// Con ROLLOVER un anillo lleno cede paquetes a otro en lugar de descartarlos; la suma
+// posterior por flujo no depende de qué hilo vio cada paquete
+static int join_fanout(int fd, int group) {
+    int argument = (group & 0xffff) | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_ROLLOVER) << 16);
+    return setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &argument, sizeof(argument));
+}
+
+int ring_backend_open(CaptureWorker* worker) {
+    Capture* cap = worker->cap;
+    CaptureRing* ring = &worker->ring;
+    int block_size = cap->config.block_size;
+    int block_count = cap->config.block_count / cap->config.threads;
+
+    if (block_count < CAPTURE_RING_MIN_BLOCKS) {
+        block_count = CAPTURE_RING_MIN_BLOCKS;
+    }
+
+    ring->fd = -1;
+    ring->wake_fd = -1;
+
+    int fd = socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, htons(ETH_P_ALL));
+    if (fd < 0) {
+        snprintf(cap->error, sizeof(cap->error), "socket(AF_PACKET): %s", strerror(errno));
+        return -1;
+    }
+
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        snprintf(cap->error, sizeof(cap->error), "PACKET_VERSION TPACKET_V3: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    attach_snaplen_filter(fd);
+
+    // Con TPACKET_V3 los paquetes se empaquetan de forma contigua dentro de cada bloque;
+    // tp_frame_size solo fija el tamaño máximo de un paquete
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size;
+    req.tp_block_nr = block_count;
+    req.tp_frame_size = 2048;
+    req.tp_frame_nr = (unsigned int)((size_t)block_size * block_count / req.tp_frame_size);
+    req.tp_retire_blk_tov = cap->config.block_timeout_ms;
+    req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+        snprintf(cap->error, sizeof(cap->error), "PACKET_RX_RING (%d x %d): %s",
+                 block_count, block_size, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    ring->map_size = (size_t)block_size * block_count;
+    ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd, 0);
+    if (ring->map == MAP_FAILED) {
+        // MAP_LOCKED puede fallar por RLIMIT_MEMLOCK; el anillo funciona igual sin bloquear
+        ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (ring->map == MAP_FAILED) {
+        snprintf(cap->error, sizeof(cap->error), "mmap del anillo: %s", strerror(errno));
+        ring->map = NULL;
+        close(fd);
+        return -1;
+    }
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = cap->interface[0] ? (int)if_nametoindex(cap->interface) : 0;
+
+    if (cap->interface[0] && addr.sll_ifindex == 0) {
+        snprintf(cap->error, sizeof(cap->error), "interfaz desconocida: %s", cap->interface);
+        munmap(ring->map, ring->map_size);
+        ring->map = NULL;
+        close(fd);
+        return -1;
+    }
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        snprintf(cap->error, sizeof(cap->error), "bind(AF_PACKET): %s", strerror(errno));
+        munmap(ring->map, ring->map_size);
+        ring->map = NULL;
+        close(fd);
+        return -1;
+    }
+
+    if (cap->config.threads > 1 && join_fanout(fd, cap->fanout_group) < 0) {
+        snprintf(cap->error, sizeof(cap->error), "PACKET_FANOUT: %s", strerror(errno));
+        munmap(ring->map, ring->map_size);
+        ring->map = NULL;
+        close(fd);
+        return -1;
+    }
+
+    ring->fd = fd;
+    ring->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ring->block_size = block_size;
+    ring->block_count = block_count;
+    ring->current = 0;
+
+    // Los paquetes se entregan desde la cabecera de red (tp_net), sea cual sea el enlace
+    worker->linktype = CAPTURE_LINK_RAW;
+    return 0;
+}
+
+static struct tpacket_block_desc* ring_block(CaptureRing* ring, int index) {
+    return (struct tpacket_block_desc*)(ring->map + (size_t)index * ring->block_size);
+}
+
+// Recorrer todos los paquetes de un bloque y devolverlo al kernel
+static int process_block(CaptureWorker* worker, struct tpacket_block_desc* block) {
+    int packets = block->hdr.bh1.num_pkts;
+    struct tpacket3_hdr* header = (struct tpacket3_hdr*)((uint8_t*)block + block->hdr.bh1.offset_to_first_pkt);
+
+    for (int i = 0; i < packets; i++) {
+        uint32_t l2_length = header->tp_net - header->tp_mac;
+        if (header->tp_snaplen > l2_length) {
+            capture_account_packet(worker, (uint8_t*)header + header->tp_net,
+                                   header->tp_snaplen - l2_length, header->tp_len);
+        }
+        header = (struct tpacket3_hdr*)((uint8_t*)header + header->tp_next_offset);
+    }
+
+    __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    return packets;
+}
+
+// Procesar los bloques listos o esperar hasta que el kernel retire uno
+int ring_backend_dispatch(CaptureWorker* worker) {
+    Capture* cap = worker->cap;
+    CaptureRing* ring = &worker->ring;
+    int processed = 0;
+
+    while (1) {
+        struct tpacket_block_desc* block = ring_block(ring, ring->current);
+        if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+            break;
+        }
+        processed += process_block(worker, block);
+        ring->current = (ring->current + 1) % ring->block_count;
+
+        // Volver al bucle de captura cada vuelta completa para atender intercambios
+        if (ring->current == 0) {
+            return processed;
+        }
+    }
+
+    if (processed > 0) {
+        return processed;
+    }
+
+    struct pollfd fds[2] = {
+        { ring->fd, POLLIN | POLLERR, 0 },
+        { ring->wake_fd, POLLIN, 0 },
+    };
+    if (poll(fds, 2, cap->config.block_timeout_ms) < 0 && errno != EINTR) {
+        snprintf(cap->error, sizeof(cap->error), "poll: %s", strerror(errno));
+        return -1;
+    }
+    if (fds[1].revents & POLLIN) {
+        uint64_t value;
+        ssize_t ignored = read(ring->wake_fd, &value, sizeof(value));
+        (void)ignored;
+    }
+    return 0;
+}
+
+// Despertar al hilo de captura si está esperando en poll()
+void ring_backend_break(CaptureWorker* worker) {
+    uint64_t one = 1;
+    if (worker->ring.wake_fd >= 0) {
+        ssize_t ignored = write(worker->ring.wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+// Acumular PACKET_STATISTICS (el kernel reinicia los contadores en cada lectura)
+// y medir la ocupación del anillo. Llamar solo desde el hilo de captura
+void ring_backend_stats(CaptureWorker* worker, CaptureStats* stats) {
+    CaptureRing* ring = &worker->ring;
+    struct tpacket_stats_v3 kernel_stats;
+    socklen_t length = sizeof(kernel_stats);
+
+    if (getsockopt(ring->fd, SOL_PACKET, PACKET_STATISTICS, &kernel_stats, &length) == 0) {
+        stats->kernel_drops += kernel_stats.tp_drops;
+        stats->ring_freezes += kernel_stats.tp_freeze_q_cnt;
+    }
+
+    int used = 0;
+    for (int i = 0; i < ring->block_count; i++) {
+        if (__atomic_load_n(&ring_block(ring, i)->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) {
+            used++;
+        }
+    }
+    stats->ring_blocks_used = used;
+    stats->ring_blocks_total = ring->block_count;
+}
+
+void ring_backend_close(CaptureWorker* worker) {
+    CaptureRing* ring = &worker->ring;
+    if (ring->map) {
+        munmap(ring->map, ring->map_size);
+        ring->map = NULL;
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+        ring->fd = -1;
+    }
+    if (ring->wake_fd >= 0) {
+        close(ring->wake_fd);
+        ring->wake_fd = -1;
+    }
+}
@@ -1,60 +1,98 @@
+#define _GNU_SOURCE
 #include "collector.h"
+#include "netlink.h"
+#include "sockdiag.h"
+#include "procnet.h"
+#include "sockowner.h"
+#include "capture.h"
+#include "probe.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <dirent.h>
 #include <ctype.h>
-#include <netinet/in.h> // Para inet_ntoa
-#include <arpa/inet.h>  // Para inet_ntoa
+#include <netinet/in.h> // Para AF_INET e IPPROTO_*
+#include <arpa/inet.h>
 #include <net/if.h>     // Para if_nametoindex
-#include <sys/wait.h>   // Para popen
+#include <sys/ioctl.h>  // Para SIOCGIFADDR
+#include <linux/rtnetlink.h> // Para RTMGRP_LINK
 
+// Interfaces como máximo al enumerar /sys/class/net sin netlink
+#define SYSFS_MAX_INTERFACES 1024
 
+// Tabla de estadísticas por ifindex alimentada por RTM_GETLINK
+static LinkStatsTable link_table;
+static int link_socket = -1;
+static int link_state = 0;   // 0 = sin inicializar, 1 = netlink disponible, -1 = usar /proc/net/dev
+
+// Caché de direcciones mantenida por notificaciones de netlink
+static AddressCache address_cache;
+static int address_state = 0;   // 0 = sin inicializar, 1 = netlink disponible, -1 = usar ioctl
+
+// Socket de sock_diag para el volcado de conexiones (-1 = sin abrir, -2 = no disponible)
+static int diag_socket = -1;
+
+// Índice inodo de socket -> proceso propietario
+static SocketOwnerIndex owner_index;
+static int owner_ready = 0;
+
+// Captura de paquetes para el tráfico por proceso
+static Capture process_capture;
+static int capture_running = 0;
 
 // Leer estadísticas de una interfaz de red desde /proc/net/dev
 NetworkStats read_interface_stats(const char* interface) {
     NetworkStats stats = {0};
-    FILE* file;
-    char line[512];
-    char interface_name[64];
-    
-    // Inicializar estructura
-    stats.timestamp = get_current_timestamp();
-    
-    file = fopen("/proc/net/dev", "r");
-    if (!file) {
+    const char* data = proc_registry_read(proc_registry_shared(), "/proc/net/dev", NULL);
+    if (!data) {
         return stats;
     }
     
     // Saltar las dos primeras líneas (encabezados)
-    fgets(line, sizeof(line), file);
-    fgets(line, sizeof(line), file);
-    
-    // Buscar la interfaz específica
-    while (fgets(line, sizeof(line), file)) {
-        // Parsear línea: interfaz: rx_bytes rx_packets rx_errors rx_drop ... tx_bytes tx_packets ...
-        if (sscanf(line, "%63s %lu %lu %*u %*u %*u %*u %*u %*u %lu %lu %*u %*u %*u %*u %*u %*u",
-                   interface_name, &stats.rx_bytes, &stats.rx_packets, &stats.tx_bytes, &stats.tx_packets) >= 4) {
-            
-            // Eliminar ":" del nombre de la interfaz
-            char* colon = strchr(interface_name, ':');
-            if (colon) *colon = '\0';
+    const char* line = data;
+    for (int i = 0; i < 2 && line; i++) {
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    
+    // Buscar la interfaz por su nombre y convertir solo su línea: sscanf mide con strlen
+    // todo lo que queda del búfer, así que llamarlo en cada línea era cuadrático
+    size_t name_length = strlen(interface);
+    while (line && *line) {
+        const char* name = line + strspn(line, " ");
+        const char* end = strchr(line, '\n');
+        
+        if (strncmp(name, interface, name_length) == 0 && name[name_length] == ':') {
+            // Línea: interfaz: rx_bytes rx_packets rx_errors rx_drop ... tx_bytes tx_packets ...
+            char values[512];
+            const char* start = name + name_length + 1;
+            size_t length = end ? (size_t)(end - start) : strlen(start);
+            if (length >= sizeof(values)) length = sizeof(values) - 1;
+            memcpy(values, start, length);
+            values[length] = '\0';
             
-            // Verificar si es la interfaz que buscamos
-            if (strcmp(interface_name, interface) == 0) {
-                break;
+            if (sscanf(values, "%lu %lu %*u %*u %*u %*u %*u %*u %lu %lu",
+                       &stats.rx_bytes, &stats.rx_packets, &stats.tx_bytes, &stats.tx_packets) >= 3) {
+                stats.timestamp_ns = monotonic_ns();
             }
+            break;
         }
+        
+        line = end ? end + 1 : NULL;
     }
     
-    fclose(file);
+    if (stats.timestamp_ns == 0) {
+        stats = (NetworkStats){0};   // interfaz no encontrada
+        stats.timestamp_ns = monotonic_ns();
+    }
     return stats;
 }
 
-// Calcular velocidades basadas en estadísticas actuales y previas
-void calculate_speeds(NetworkStats* current, NetworkStats* previous, double time_diff) {
-    if (!previous || time_diff <= 0) {
+// Calcular velocidades sobre el intervalo real entre las dos lecturas
+void calculate_speeds(NetworkStats* current, const NetworkStats* previous) {
+    double time_diff = previous ? elapsed_seconds(previous->timestamp_ns, current->timestamp_ns) : 0.0;
+    if (time_diff <= 0) {
         current->rx_speed = 0.0;
         current->tx_speed = 0.0;
         current->total_speed = 0.0;
@@ -71,112 +109,219 @@ void calculate_speeds(NetworkStats* current, NetworkStats* previous, double time
     current->total_speed = current->rx_speed + current->tx_speed;
 }
 
-// Obtener estadísticas de red para una interfaz
+// Abrir el socket de enlaces, suscrito a altas, bajas y cambios de estado, y hacer el
+// primer volcado. Devuelve -1 si netlink no está disponible
+static int open_link_table(void) {
+    if (link_state == 0) {
+        link_socket = nl_open(RTMGRP_LINK);
+        if (link_socket >= 0 && link_stats_init(&link_table) == 0 &&
+            link_stats_dump(&link_table, link_socket) >= 0) {
+            link_state = 1;
+        } else {
+            nl_close(link_socket);
+            link_socket = -1;
+            link_state = -1;
+        }
+    }
+    
+    return link_state > 0 ? 0 : -1;
+}
+
+// Refrescar las estadísticas de todas las interfaces con un único volcado de netlink
+int refresh_network_stats(void) {
+    if (open_link_table() < 0) {
+        return -1;
+    }
+
+    return link_stats_dump(&link_table, link_socket);
+}
+
+// Obtener estadísticas de red para una interfaz desde la tabla del último volcado
 NetworkStats collect_network_stats(const char* interface) {
-    return read_interface_stats(interface);
+    if (open_link_table() < 0) {
+        return read_interface_stats(interface);
+    }
+
+    const NetworkStats* stats = link_stats_get(&link_table, link_stats_find(&link_table, interface));
+    if (!stats) {
+        NetworkStats empty = {0};
+        empty.timestamp_ns = monotonic_ns();
+        return empty;
+    }
+
+    return *stats;
 }
 
-// Obtener interfaces de red disponibles
-char** get_available_interfaces(int* count) {
-    // Lista de interfaces comunes en orden de prioridad
-    const char* common_interfaces[] = {
-        "wlan0", "wlan1", "wifi0", "wifi1",  // WiFi
-        "eth0", "enp0s3", "enp7s0", "eno1", "ens33",  // Ethernet
-        "docker0", "br0", "virbr0",  // Virtuales
-        NULL
-    };
-    
-    // Contar interfaces que existen
-    *count = 0;
-    for (int i = 0; common_interfaces[i] != NULL; i++) {
-        char path[256];
-        snprintf(path, sizeof(path), "/sys/class/net/%s", common_interfaces[i]);
-        if (access(path, F_OK) == 0) {
-            (*count)++;
+// Enumerar interfaces sin netlink: entradas de /sys/class/net
+static int list_interfaces_sysfs(char names[][MAX_INTERFACE_NAME], int* active, int max) {
+    DIR* dir = opendir("/sys/class/net");
+    struct dirent* entry;
+    int count = 0;
+    
+    if (!dir) {
+        return 0;
+    }
+    
+    while ((entry = readdir(dir)) != NULL && count < max) {
+        if (entry->d_name[0] == '.') {
+            continue;
         }
+        snprintf(names[count], MAX_INTERFACE_NAME, "%.*s", MAX_INTERFACE_NAME - 1, entry->d_name);
+        active[count] = is_interface_active(names[count]);
+        count++;
     }
     
-    // Si no se encontró ninguna, devolver al menos una
-    if (*count == 0) {
-        *count = 1;
-        char** interfaces = malloc(sizeof(char*));
-        interfaces[0] = malloc(strlen("eth0") + 1);
-        strcpy(interfaces[0], "eth0");
-        return interfaces;
+    closedir(dir);
+    return count;
+}
+
+// Enumerar todas las interfaces con su estado desde la tabla de enlaces, que las
+// notificaciones de RTMGRP_LINK mantienen al día. No reserva memoria
+int list_interfaces(char names[][MAX_INTERFACE_NAME], int* active, int max) {
+    if (open_link_table() < 0) {
+        return list_interfaces_sysfs(names, active, max);
     }
     
-    // Crear array con interfaces que existen
-    char** interfaces = malloc(*count * sizeof(char*));
-    if (!interfaces) {
-        *count = 0;
-        return NULL;
+    link_stats_update(&link_table, link_socket);
+    
+    int count = 0;
+    for (int ifindex = link_stats_next(&link_table, 0); ifindex > 0 && count < max;
+         ifindex = link_stats_next(&link_table, ifindex)) {
+        snprintf(names[count], MAX_INTERFACE_NAME, "%s", link_stats_name(&link_table, ifindex));
+        active[count] = link_stats_is_up(&link_table, ifindex);
+        count++;
     }
     
-    int index = 0;
-    for (int i = 0; common_interfaces[i] != NULL && index < *count; i++) {
-        char path[256];
-        snprintf(path, sizeof(path), "/sys/class/net/%s", common_interfaces[i]);
-        if (access(path, F_OK) == 0) {
-            interfaces[index] = malloc(strlen(common_interfaces[i]) + 1);
-            if (interfaces[index]) {
-                strcpy(interfaces[index], common_interfaces[i]);
-                index++;
-            }
+    return count;
+}
+
+// Obtener interfaces de red disponibles (todas las que conoce el kernel)
+char** get_available_interfaces(int* count) {
+    int max = SYSFS_MAX_INTERFACES;
+    if (open_link_table() == 0) {
+        link_stats_update(&link_table, link_socket);
+        max = link_table.count;
+    }
+    
+    *count = 0;
+    char (*names)[MAX_INTERFACE_NAME] = malloc((max > 0 ? max : 1) * sizeof(*names));
+    int* active = malloc((max > 0 ? max : 1) * sizeof(int));
+    char** interfaces = malloc((max > 0 ? max : 1) * sizeof(char*));
+    if (names && active && interfaces) {
+        *count = list_interfaces(names, active, max);
+        for (int i = 0; i < *count; i++) {
+            interfaces[i] = strdup(names[i]);
         }
     }
     
-    *count = index;
+    free(names);
+    free(active);
+    if (*count == 0) {
+        free(interfaces);
+        return NULL;
+    }
     return interfaces;
 }
 
-
-
-// Verificar si una interfaz está activa
+// Verificar si una interfaz está activa (operstate "up")
 int is_interface_active(const char* interface) {
     if (!interface) {
         return 0;
     }
     
+    if (open_link_table() == 0) {
+        link_stats_update(&link_table, link_socket);
+        return link_stats_is_up(&link_table, link_stats_find(&link_table, interface));
+    }
+    
     char path[256];
-    FILE* file;
-    char operstate[32];
     
     snprintf(path, sizeof(path), "/sys/class/net/%s/operstate", interface);
-    file = fopen(path, "r");
-    if (!file) {
+    const char* operstate = proc_registry_read(proc_registry_shared(), path, NULL);
+    if (!operstate) {
         return 0;
     }
     
-    if (fgets(operstate, sizeof(operstate), file)) {
-        operstate[strcspn(operstate, "\n")] = '\0';
-        fclose(file);
-        return strcmp(operstate, "up") == 0;
+    return strcmp(operstate, "up\n") == 0 || strcmp(operstate, "up") == 0;
+}
+
+// Respaldo sin netlink: dirección IPv4 primaria con SIOCGIFADDR
+static int read_address_ioctl(const char* interface, char* buffer, int size) {
+    struct ifreq request;
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
     }
     
-    fclose(file);
-    return 0;
+    memset(&request, 0, sizeof(request));
+    snprintf(request.ifr_name, IFNAMSIZ, "%s", interface);
+    int result = ioctl(fd, SIOCGIFADDR, &request);
+    close(fd);
+    if (result < 0) {
+        return -1;
+    }
+    
+    struct sockaddr_in* address = (struct sockaddr_in*)&request.ifr_addr;
+    return inet_ntop(AF_INET, &address->sin_addr, buffer, size) ? 0 : -1;
 }
 
-// Obtener número de conexiones activas
-int get_connection_count(void) {
-    FILE* file;
-    char line[512];
-    int count = 0;
+// Obtener la IP de una interfaz (IPv4 primaria o, si no tiene, IPv6 global) desde la
+// caché de direcciones: en régimen estable es una lectura de memoria
+int get_interface_address(const char* interface, char* buffer, int size) {
+    if (!interface) {
+        return -1;
+    }
     
-    file = fopen("/proc/net/tcp", "r");
-    if (!file) {
-        return 0;
+    if (address_state == 0) {
+        address_state = address_cache_init(&address_cache) == 0 ? 1 : -1;
+    }
+    if (address_state < 0) {
+        return read_address_ioctl(interface, buffer, size);
     }
     
-    // Saltar encabezado
-    fgets(line, sizeof(line), file);
+    if (address_cache_update(&address_cache) < 0) {
+        return -1;
+    }
     
-    // Contar líneas (conexiones)
-    while (fgets(line, sizeof(line), file)) {
-        count++;
+    int ifindex = link_state > 0 ? link_stats_find(&link_table, interface) : -1;
+    if (ifindex <= 0) {
+        ifindex = if_nametoindex(interface);
+    }
+    
+    const InterfaceAddress* address = address_cache_find(&address_cache, ifindex, AF_INET);
+    if (!address) {
+        address = address_cache_find(&address_cache, ifindex, AF_INET6);
+    }
+    if (!address) {
+        return -1;
+    }
+    
+    return inet_ntop(address->family, address->addr, buffer, size) ? 0 : -1;
+}
+
+// Obtener la IP de una interfaz en memoria nueva ("No disponible" si no tiene)
+char* get_interface_ip(const char* interface) {
+    char* ip = malloc(MAX_IP_ADDRESS);
+    if (!ip) return NULL;
+    
+    if (get_interface_address(interface, ip, MAX_IP_ADDRESS) < 0) {
+        snprintf(ip, MAX_IP_ADDRESS, "No disponible");
+    }
+    return ip;
+}
+
+// Obtener número de conexiones TCP activas (IPv4 e IPv6)
+int get_connection_count(void) {
+    int count = procnet_count(proc_registry_shared(), "/proc/net/tcp");
+    if (count < 0) {
+        return 0;
+    }
+    
+    int count6 = procnet_count(proc_registry_shared(), "/proc/net/tcp6");
+    if (count6 > 0) {
+        count += count6;
     }
     
-    fclose(file);
     return count;
 }
 
@@ -185,8 +330,9 @@ int get_active_processes(void) {
     DIR* dir;
     struct dirent* entry;
     int count = 0;
+    char path[PROC_PATH_MAX];
     
-    dir = opendir("/proc");
+    dir = opendir(proc_path("/proc", path, sizeof(path)));
     if (!dir) {
         return 0;
     }
@@ -202,113 +348,119 @@ int get_active_processes(void) {
     return count;
 }
 
-// Obtener conexiones TCP reales del sistema
-Connection* collect_connections(int* count) {
-    FILE* file;
-    char line[512];
-    Connection* connections = malloc(MAX_CONNECTIONS * sizeof(Connection));
-    *count = 0;
+// Asignar pid y nombre de proceso a cada conexión usando el índice de inodos
+void resolve_connection_owners(Connection* connections, int count) {
+    if (!owner_ready) {
+        sock_owner_init(&owner_index, 0);
+        owner_ready = 1;
+    }
     
-    if (!connections) return NULL;
+    // Solo se reescanean los PIDs nuevos o con cambios en sus fds
+    sock_owner_refresh(&owner_index);
+    sock_owner_resolve(&owner_index, connections, count);
+}
+
+// Obtener conexiones filtradas por estado (máscara de bits 1 << estado)
+Connection* collect_connections_by_state(uint32_t states, int* count) {
+    ConnectionList list = {0};
+    *count = 0;
     
-    file = fopen("/proc/net/tcp", "r");
-    if (!file) {
-        free(connections);
-        return NULL;
+    // sock_diag ve el kernel real: con otra raíz de /proc solo valen sus ficheros
+    if (diag_socket == -1 && proc_root()[0]) {
+        diag_socket = -2;
+    }
+    if (diag_socket == -1) {
+        diag_socket = sock_diag_open();
+        if (diag_socket < 0) {
+            diag_socket = -2;   // no volver a intentarlo
+        }
     }
     
-    // Saltar encabezado
-    fgets(line, sizeof(line), file);
-    
-    // Leer conexiones
-    while (fgets(line, sizeof(line), file) && *count < MAX_CONNECTIONS) {
-        unsigned int local_addr, remote_addr;
-        int local_port, remote_port;
-        int state;
-        
-        // Parsear línea: sl local_address rem_address st tx_queue rx_queue tr tm->when retrnsmt uid timeout inode
-        if (sscanf(line, "%*d: %x:%x %x:%x %x", &local_addr, &local_port, &remote_addr, &remote_port, &state) >= 5) {
-            
-            // Convertir direcciones IP
-            struct in_addr local_ip, remote_ip;
-            local_ip.s_addr = local_addr;
-            remote_ip.s_addr = remote_addr;
-            
-            // Obtener nombres de IP
-            char* local_ip_str = inet_ntoa(local_ip);
-            char* remote_ip_str = inet_ntoa(remote_ip);
-            
-            // Obtener nombre del proceso (simplificado por ahora)
-            char process_name[MAX_PROCESS_NAME];
-            strcpy(process_name, "unknown");
-            
-            // Obtener estado de conexión
-            char state_str[16];
-            switch (state) {
-                case 1: strcpy(state_str, "ESTABLISHED"); break;
-                case 2: strcpy(state_str, "SYN_SENT"); break;
-                case 3: strcpy(state_str, "SYN_RECV"); break;
-                case 4: strcpy(state_str, "FIN_WAIT1"); break;
-                case 5: strcpy(state_str, "FIN_WAIT2"); break;
-                case 6: strcpy(state_str, "TIME_WAIT"); break;
-                case 7: strcpy(state_str, "CLOSE"); break;
-                case 8: strcpy(state_str, "CLOSE_WAIT"); break;
-                case 9: strcpy(state_str, "LAST_ACK"); break;
-                case 10: strcpy(state_str, "LISTEN"); break;
-                case 11: strcpy(state_str, "CLOSING"); break;
-                default: strcpy(state_str, "UNKNOWN"); break;
-            }
-            
-            // Guardar conexión
-            strncpy(connections[*count].local_ip, local_ip_str, MAX_IP_ADDRESS - 1);
-            connections[*count].local_port = ntohs(local_port);
-            strncpy(connections[*count].remote_ip, remote_ip_str, MAX_IP_ADDRESS - 1);
-            connections[*count].remote_port = ntohs(remote_port);
-            strncpy(connections[*count].state, state_str, 15);
-            strncpy(connections[*count].process, process_name, MAX_PROCESS_NAME - 1);
-            connections[*count].timestamp = get_current_timestamp();
-            
-            (*count)++;
+    if (diag_socket >= 0) {
+        if (sock_diag_collect_all(diag_socket, states, &list) >= 0) {
+            resolve_connection_owners(list.items, list.count);
+            *count = list.count;
+            return list.items;
         }
+        
+        // Descartar lo leído y reabrir el socket en la próxima llamada
+        sock_diag_close(diag_socket);
+        diag_socket = -1;
+        list.count = 0;
     }
     
-    fclose(file);
-    return connections;
+    // Respaldo: /proc/net/{tcp,tcp6,udp,udp6} con el filtro de estados aplicado al parsear
+    if (procnet_collect(proc_registry_shared(), states, &list) < 0) {
+        free(list.items);
+        return NULL;
+    }
+    
+    resolve_connection_owners(list.items, list.count);
+    *count = list.count;
+    return list.items;
+}
+
+// Obtener todas las conexiones TCP y UDP del sistema
+Connection* collect_connections(int* count) {
+    return collect_connections_by_state(CONN_STATES_ALL, count);
+}
+
+// Copiar a la prueba los percentiles de un histograma (NULL = sin datos)
+void latency_test_percentiles(LatencyTest* test, const LatencyHistogram* histogram) {
+    if (!histogram || histogram->count == 0) {
+        test->p50 = test->p99 = test->p999 = test->max = -1.0;
+        test->samples = 0;
+        return;
+    }
+    test->p50 = histogram_percentile(histogram, 50.0);
+    test->p99 = histogram_percentile(histogram, 99.0);
+    test->p999 = histogram_percentile(histogram, 99.9);
+    test->max = histogram_percentile(histogram, 100.0);
+    test->samples = histogram->count;
 }
 
 // Obtener pruebas de latencia reales
 LatencyTest* collect_latency_tests(int* count) {
-    const char* servers[] = {"google.com", "github.com", "cloudflare.com", "8.8.8.8"};
-    *count = 4; // Número de servidores a probar
+    const char* servers[] = { PROBE_DEFAULT_TARGETS };
+    int server_count = sizeof(servers) / sizeof(servers[0]);
+    int indices[sizeof(servers) / sizeof(servers[0])];
+    ProbeConfig config;
+    ProbeEngine engine;
     
-    LatencyTest* tests = malloc(*count * sizeof(LatencyTest));
+    *count = 0;
+    LatencyTest* tests = malloc(server_count * sizeof(LatencyTest));
     if (!tests) return NULL;
     
-    for (int i = 0; i < *count; i++) {
-        strncpy(tests[i].server, servers[i], MAX_SERVER_NAME - 1);
-        tests[i].server[MAX_SERVER_NAME - 1] = '\0';
-        tests[i].timestamp = get_current_timestamp();
+    // Un eco ICMP por servidor, todos a la vez en el mismo bucle epoll
+    probe_default_config(&config);
+    if (probe_engine_init(&engine, &config) < 0) {
+        free(tests);
+        return NULL;
+    }
+    for (int i = 0; i < server_count; i++) {
+        indices[i] = probe_engine_add(&engine, servers[i]);
+    }
+    probe_engine_run(&engine);
+    
+    for (int i = 0; i < server_count; i++) {
+        LatencyTest* test = &tests[(*count)++];
+        snprintf(test->server, MAX_SERVER_NAME, "%s", servers[i]);
+        test->timestamp = get_current_timestamp();
+        test->latency = -1.0;
+        test->status = PROBE_ERROR;   // no se pudo resolver el nombre
+        latency_test_percentiles(test, NULL);
         
-        // Simular latencia basada en el servidor (por ahora)
-        // En una implementación completa, se haría ping real
-        if (strcmp(servers[i], "google.com") == 0) {
-            tests[i].latency = 15.5;
-            tests[i].status = 0;
-        } else if (strcmp(servers[i], "github.com") == 0) {
-            tests[i].latency = 45.2;
-            tests[i].status = 0;
-        } else if (strcmp(servers[i], "cloudflare.com") == 0) {
-            tests[i].latency = 8.7;
-            tests[i].status = 0;
-        } else if (strcmp(servers[i], "8.8.8.8") == 0) {
-            tests[i].latency = 12.3;
-            tests[i].status = 0;
-        } else {
-            tests[i].latency = -1.0;
-            tests[i].status = 2; // Error
+        if (indices[i] >= 0) {
+            const ProbeTarget* target = &engine.targets[indices[i]];
+            test->status = target->status;
+            if (target->status == PROBE_OK) {
+                test->latency = target->last_ms;
+            }
+            latency_test_percentiles(test, &target->histogram);
         }
     }
     
+    probe_engine_free(&engine);
     return tests;
 }
 
@@ -317,15 +469,113 @@ double calculate_bandwidth_usage(const char* interface) {
     return 0.0;
 }
 
+// Ordenar procesos de mayor a menor velocidad total
+static int compare_traffic(const void* a, const void* b) {
+    const ProcessTraffic* pa = a;
+    const ProcessTraffic* pb = b;
+    double total_a = pa->rx_speed + pa->tx_speed;
+    double total_b = pb->rx_speed + pb->tx_speed;
+    return (total_a < total_b) - (total_a > total_b);
+}
+
+// Iniciar la captura de paquetes para atribuir tráfico a procesos
+int start_process_monitor(const char* interface, const CaptureConfig* config) {
+    if (capture_running) {
+        return 0;
+    }
+    
+    if (capture_start(&process_capture, interface, config) < 0) {
+        return -1;
+    }
+    
+    capture_running = 1;
+    update_process_monitor();   // fijar el inicio del primer intervalo
+    return 0;
+}
+
+void stop_process_monitor(void) {
+    if (capture_running) {
+        capture_stop(&process_capture);
+        capture_running = 0;
+    }
+}
+
+const char* process_monitor_error(void) {
+    return process_capture.error;
+}
+
+// Cerrar el intervalo actual y atribuir sus flujos a los sockets de cada proceso
+int update_process_monitor(void) {
+    if (!capture_running) {
+        return -1;
+    }
+    
+    int count;
+    Connection* connections = collect_connections(&count);
+    int result = capture_update(&process_capture, connections, connections ? count : 0);
+    free(connections);
+    return result;
+}
+
+// Procesos con tráfico, ordenados por velocidad total (el llamador libera el array)
+ProcessTraffic* collect_process_traffic(int* count) {
+    *count = 0;
+    if (!capture_running || process_capture.process_count == 0) {
+        return NULL;
+    }
+    
+    ProcessTraffic* processes = malloc(process_capture.process_count * sizeof(ProcessTraffic));
+    if (!processes) {
+        return NULL;
+    }
+    
+    memcpy(processes, process_capture.processes, process_capture.process_count * sizeof(ProcessTraffic));
+    *count = process_capture.process_count;
+    qsort(processes, *count, sizeof(ProcessTraffic), compare_traffic);
+    return processes;
+}
+
+int get_capture_stats(CaptureStats* stats) {
+    if (!capture_running) {
+        memset(stats, 0, sizeof(CaptureStats));
+        return -1;
+    }
+    capture_get_stats(&process_capture, stats);
+    return 0;
+}
+
+// Velocidad de red de un proceso en el último intervalo (bytes por segundo)
 int get_process_network_usage(int pid, uint64_t* rx_bytes, uint64_t* tx_bytes) {
-    // TODO: Implementar monitoreo de uso de red por proceso
     *rx_bytes = 0;
     *tx_bytes = 0;
+    
+    if (!capture_running) {
+        return -1;
+    }
+    
+    const ProcessTraffic* process = capture_get_process(&process_capture, pid);
+    if (process) {
+        *rx_bytes = (uint64_t)(process->rx_speed * 1024.0 * 1024.0);
+        *tx_bytes = (uint64_t)(process->tx_speed * 1024.0 * 1024.0);
+    }
     return 0;
 }
 
-char* get_process_connections(int pid, int* count) {
-    // TODO: Implementar obtención de conexiones por proceso
+// Obtener las conexiones abiertas por un proceso
+Connection* get_process_connections(int pid, int* count) {
+    int total;
+    Connection* connections = collect_connections(&total);
     *count = 0;
-    return NULL;
-} 
\ No newline at end of file
+    
+    if (!connections) {
+        return NULL;
+    }
+    
+    for (int i = 0; i < total; i++) {
+        if (connections[i].pid == pid) {
+            connections[(*count)++] = connections[i];
+        }
+    }
+    
+    return connections;
+}
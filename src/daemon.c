@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+#include "daemon.h"
+#include "sampler.h"
+#include "shared.h"
+#include <stdio.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+
+int run_daemon(void) {
+    SharedSnapshot shared;
+    Sampler sampler;
+    char name[64];
+
+    // SIGINT y SIGTERM llegan por signalfd: bloquearlas antes de crear el hilo de
+    // muestreo para que ninguno las reciba por manejador
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    if (shared_default_name(name, sizeof(name)) < 0) {
+        fprintf(stderr, "Nombre de segmento demasiado largo en NX_SHM\n");
+        return 1;
+    }
+    if (shared_create(&shared, name) < 0) {
+        fprintf(stderr, "%s\n", shared.error);
+        return 1;
+    }
+
+    int signal_fd = signalfd(-1, &signals, SFD_CLOEXEC);
+    if (signal_fd < 0 || sampler_start(&sampler, DAEMON_LINKS_PERIOD_MS) < 0) {
+        fprintf(stderr, "No se pudo iniciar el hilo de muestreo\n");
+        if (signal_fd >= 0) close(signal_fd);
+        shared_close(&shared);
+        return 1;
+    }
+
+    printf("nx daemon (pid %d) publicando en %s. Ctrl+C para terminar\n", (int)getpid(), name);
+    fflush(stdout);
+
+    // Despertar solo con cada publicación del hilo de muestreo y copiarla una vez,
+    // sea cual sea el número de visores
+    struct pollfd fds[2] = {
+        { sampler_publish_fd(&sampler), POLLIN, 0 },
+        { signal_fd, POLLIN, 0 },
+    };
+    unsigned long published = 0;
+    while (1) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            sampler_drain(&sampler);
+            const Snapshot* snapshot = sampler_acquire(&sampler);
+            if (snapshot) {
+                shared_publish(&shared, snapshot);
+                published++;
+            }
+            sampler_release(&sampler);
+        }
+    }
+
+    sampler_stop(&sampler);
+    shared_close(&shared);
+    close(signal_fd);
+    printf("nx daemon: %lu muestras copiadas al segmento\n", published);
+    return 0;
+}
@@ -0,0 +1,453 @@
+#define _GNU_SOURCE
+#include "exporter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+
+#define EXPORTER_EVENTS 64
+#define LISTEN_TOKEN UINT32_MAX
+#define STOP_TOKEN (UINT32_MAX - 1)
+
+void exporter_default_config(ExporterConfig* config) {
+    memset(config, 0, sizeof(ExporterConfig));
+    snprintf(config->listen, sizeof(config->listen), "%s", EXPORTER_DEFAULT_LISTEN);
+    config->max_clients = EXPORTER_DEFAULT_CLIENTS;
+}
+
+static int fail(Exporter* exporter, const char* what) {
+    snprintf(exporter->error, sizeof(exporter->error), "%s %.100s: %s", what, exporter->config.listen, strerror(errno));
+    return -1;
+}
+
+// Separar "host:puerto", "[v6]:puerto" o ":puerto" (host vacío = todas las direcciones)
+static int split_listen(const char* listen, char* host, size_t host_size, char* port, size_t port_size) {
+    const char* colon = strrchr(listen, ':');
+    if (!colon || !colon[1]) {
+        return -1;
+    }
+
+    const char* begin = listen;
+    const char* end = colon;
+    if (*begin == '[' && end > begin && end[-1] == ']') {
+        begin++;
+        end--;
+    }
+    if ((size_t)(end - begin) >= host_size) {
+        return -1;
+    }
+    memcpy(host, begin, end - begin);
+    host[end - begin] = '\0';
+    return snprintf(port, port_size, "%s", colon + 1) < (int)port_size ? 0 : -1;
+}
+
+int exporter_init(Exporter* exporter, const ExporterConfig* config) {
+    char host[128];
+    char port[16];
+    struct addrinfo hints;
+    struct addrinfo* result;
+
+    memset(exporter, 0, sizeof(Exporter));
+    exporter->config = *config;
+    exporter->listen_fd = -1;
+    exporter->epoll_fd = -1;
+    if (exporter->config.max_clients < 1) {
+        exporter->config.max_clients = 1;
+    }
+
+    if (split_listen(config->listen, host, sizeof(host), port, sizeof(port)) < 0) {
+        snprintf(exporter->error, sizeof(exporter->error), "dirección no válida: %.100s (se espera host:puerto)",
+                 config->listen);
+        return -1;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    int status = getaddrinfo(host[0] ? host : NULL, port, &hints, &result);
+    if (status != 0) {
+        snprintf(exporter->error, sizeof(exporter->error), "no se pudo resolver %.100s: %s",
+                 config->listen, gai_strerror(status));
+        return -1;
+    }
+
+    for (struct addrinfo* address = result; address; address = address->ai_next) {
+        int fd = socket(address->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, address->ai_addr, address->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) {
+            exporter->listen_fd = fd;
+            break;
+        }
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    freeaddrinfo(result);
+    if (exporter->listen_fd < 0) {
+        return fail(exporter, "no se pudo escuchar en");
+    }
+
+    exporter->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    exporter->clients = calloc(exporter->config.max_clients, sizeof(ExporterClient));
+    if (exporter->epoll_fd < 0 || !exporter->clients) {
+        fail(exporter, "epoll/memoria para");
+        exporter_free(exporter);
+        return -1;
+    }
+    for (int i = 0; i < exporter->config.max_clients; i++) {
+        exporter->clients[i].fd = -1;
+        metrics_buffer_init(&exporter->clients[i].response, EXPORTER_HEADER_SIZE);
+    }
+
+    struct epoll_event event = { EPOLLIN, { .u32 = LISTEN_TOKEN } };
+    if (epoll_ctl(exporter->epoll_fd, EPOLL_CTL_ADD, exporter->listen_fd, &event) < 0) {
+        fail(exporter, "epoll_ctl en");
+        exporter_free(exporter);
+        return -1;
+    }
+    return 0;
+}
+
+void exporter_free(Exporter* exporter) {
+    if (exporter->clients) {
+        for (int i = 0; i < exporter->config.max_clients; i++) {
+            if (exporter->clients[i].fd >= 0) close(exporter->clients[i].fd);
+            metrics_buffer_free(&exporter->clients[i].response);
+        }
+        free(exporter->clients);
+        exporter->clients = NULL;
+    }
+    if (exporter->epoll_fd >= 0) close(exporter->epoll_fd);
+    if (exporter->listen_fd >= 0) close(exporter->listen_fd);
+    exporter->epoll_fd = -1;
+    exporter->listen_fd = -1;
+}
+
+// ============================================================================
+// ORIGEN DE LAS MUESTRAS
+// ============================================================================
+
+// Si el daemon terminó, su última muestra ya no es actual: seguir con un hilo de
+// muestreo propio (503 hasta su primera muestra) o, si no arranca, responder 503.
+// Se comprueba en cada scrape: es un kill(pid, 0)
+static int daemon_gone(Exporter* exporter) {
+    if (exporter->orphaned) {
+        return 1;
+    }
+    if (shared_alive(&exporter->shared)) {
+        return 0;
+    }
+
+    shared_close(&exporter->shared);
+    if (sampler_start(&exporter->sampler, EXPORTER_LINKS_PERIOD_MS) < 0) {
+        fprintf(stderr, "nx exporter: nx daemon terminó y no se pudo iniciar el hilo de muestreo\n");
+        exporter->orphaned = 1;
+        return 1;
+    }
+    exporter->attached = 0;
+    fprintf(stderr, "nx exporter: nx daemon terminó, muestreando con un hilo propio\n");
+    return 0;
+}
+
+static const Snapshot* acquire_snapshot(Exporter* exporter) {
+    if (exporter->attached && daemon_gone(exporter)) {
+        return NULL;
+    }
+    if (!exporter->attached) {
+        return sampler_acquire(&exporter->sampler);
+    }
+    shared_read(&exporter->shared, &exporter->shared_copy);
+    return exporter->shared_copy.sequence ? &exporter->shared_copy : NULL;
+}
+
+static void release_snapshot(Exporter* exporter) {
+    if (!exporter->attached) {
+        sampler_release(&exporter->sampler);
+    }
+}
+
+// ============================================================================
+// CLIENTES
+// ============================================================================
+
+static void close_client(ExporterClient* client) {
+    close(client->fd);   // cerrar también lo quita del epoll
+    client->fd = -1;
+    client->received = 0;
+    client->writing = 0;
+}
+
+static void watch(Exporter* exporter, ExporterClient* client, uint32_t events) {
+    struct epoll_event event = { events, { .u32 = (uint32_t)(client - exporter->clients) } };
+    epoll_ctl(exporter->epoll_fd, EPOLL_CTL_MOD, client->fd, &event);
+}
+
+static void accept_clients(Exporter* exporter) {
+    int fd;
+    while ((fd = accept4(exporter->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        // Sin huecos libres se cierra la conexión más inactiva (p. ej. un keep-alive olvidado)
+        ExporterClient* slot = NULL;
+        for (int i = 0; i < exporter->config.max_clients; i++) {
+            ExporterClient* client = &exporter->clients[i];
+            if (client->fd < 0) {
+                slot = client;
+                break;
+            }
+            if (!slot || client->active_ns < slot->active_ns) {
+                slot = client;
+            }
+        }
+        if (slot->fd >= 0) {
+            close_client(slot);
+        }
+
+        slot->fd = fd;
+        slot->received = 0;
+        slot->writing = 0;
+        slot->active_ns = monotonic_ns();
+        struct epoll_event event = { EPOLLIN, { .u32 = (uint32_t)(slot - exporter->clients) } };
+        if (epoll_ctl(exporter->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close_client(slot);
+        }
+    }
+}
+
+// Colocar la cabecera justo delante del cuerpo ya escrito en el búfer de respuesta
+static void finish_response(ExporterClient* client, int status, const char* reason, const char* type) {
+    MetricsBuffer* response = &client->response;
+    char header[EXPORTER_HEADER_SIZE];
+
+    int length = snprintf(header, sizeof(header),
+                          "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+                          status, reason, type, response->length - response->offset,
+                          client->keep_alive ? "keep-alive" : "close");
+    if (length < 0 || (size_t)length >= sizeof(header)) {
+        length = 0;
+    }
+    client->start = response->offset - (size_t)length;
+    client->sent = client->start;
+    memcpy(response->data + client->start, header, (size_t)length);
+}
+
+static void simple_response(ExporterClient* client, int status, const char* reason, const char* body) {
+    metrics_buffer_reset(&client->response);
+    metrics_buffer_printf(&client->response, "%s", body);
+    finish_response(client, status, reason, "text/plain; charset=utf-8");
+}
+
+static void send_response(Exporter* exporter, ExporterClient* client);
+
+// Atender la petición completa que empieza en client->request (length bytes hasta la línea vacía)
+static void handle_request(Exporter* exporter, ExporterClient* client, size_t length) {
+    char method[8] = "";
+    char path[256] = "";
+    char version[16] = "";
+
+    sscanf(client->request, "%7s %255s %15s", method, path, version);
+    client->request[length - 1] = '\0';   // acotar las búsquedas de cabeceras a esta petición
+    if (strcmp(version, "HTTP/1.1") == 0) {
+        client->keep_alive = !strcasestr(client->request, "\nConnection: close");
+    } else {
+        client->keep_alive = strcasestr(client->request, "\nConnection: keep-alive") != NULL;
+    }
+
+    // Dejar en el búfer lo que venga detrás (peticiones encadenadas)
+    client->received -= length;
+    memmove(client->request, client->request + length, client->received);
+
+    char* query = strchr(path, '?');
+    if (query) *query = '\0';
+
+    if (strcmp(method, "GET") != 0) {
+        simple_response(client, 405, "Method Not Allowed", "Solo GET\n");
+    } else if (strcmp(path, "/metrics") == 0) {
+        const Snapshot* snapshot = acquire_snapshot(exporter);
+        if (!snapshot) {
+            simple_response(client, 503, "Service Unavailable", "Aún no hay ninguna muestra\n");
+        } else if (metrics_render(snapshot, &client->response) < 0) {
+            client->keep_alive = 0;
+            simple_response(client, 500, "Internal Server Error", "Sin memoria\n");
+        } else {
+            finish_response(client, 200, "OK", OPENMETRICS_CONTENT_TYPE);
+            exporter->scrapes++;
+        }
+        release_snapshot(exporter);
+    } else if (strcmp(path, "/") == 0) {
+        simple_response(client, 200, "OK", "nx exporter: métricas en /metrics\n");
+    } else {
+        simple_response(client, 404, "Not Found", "No encontrado\n");
+    }
+
+    if (client->response.failed) {
+        close_client(client);
+        return;
+    }
+    send_response(exporter, client);
+}
+
+// Buscar una petición completa en lo recibido y atenderla
+static void process_requests(Exporter* exporter, ExporterClient* client) {
+    char* end = memmem(client->request, client->received, "\r\n\r\n", 4);
+    if (end) {
+        handle_request(exporter, client, (size_t)(end + 4 - client->request));
+    } else if (client->received >= EXPORTER_REQUEST_SIZE - 1) {
+        client->received = 0;
+        client->keep_alive = 0;
+        simple_response(client, 431, "Request Header Fields Too Large", "Cabeceras demasiado largas\n");
+        send_response(exporter, client);
+    }
+}
+
+static void send_response(Exporter* exporter, ExporterClient* client) {
+    MetricsBuffer* response = &client->response;
+
+    while (client->sent < response->length) {
+        ssize_t sent = send(client->fd, response->data + client->sent, response->length - client->sent,
+                            MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                // El resto cuando el socket admita más: mientras, no leer más peticiones
+                if (!client->writing) watch(exporter, client, EPOLLOUT);
+                client->writing = 1;
+                return;
+            }
+            close_client(client);
+            return;
+        }
+        client->sent += (size_t)sent;
+    }
+
+    client->active_ns = monotonic_ns();
+    if (!client->keep_alive) {
+        close_client(client);
+        return;
+    }
+    if (client->writing) {
+        watch(exporter, client, EPOLLIN);
+        client->writing = 0;
+    }
+    if (client->received > 0) {
+        process_requests(exporter, client);
+    }
+}
+
+static void read_request(Exporter* exporter, ExporterClient* client) {
+    ssize_t received = recv(client->fd, client->request + client->received,
+                            EXPORTER_REQUEST_SIZE - 1 - client->received, 0);
+    if (received < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    if (received <= 0) {
+        close_client(client);
+        return;
+    }
+    client->received += (size_t)received;
+    client->active_ns = monotonic_ns();
+    process_requests(exporter, client);
+}
+
+static int serve(Exporter* exporter, int stop_fd) {
+    struct epoll_event events[EXPORTER_EVENTS];
+    struct epoll_event stop = { EPOLLIN, { .u32 = STOP_TOKEN } };
+
+    if (epoll_ctl(exporter->epoll_fd, EPOLL_CTL_ADD, stop_fd, &stop) < 0) {
+        return fail(exporter, "epoll_ctl en");
+    }
+
+    while (1) {
+        int count = epoll_wait(exporter->epoll_fd, events, EXPORTER_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return fail(exporter, "epoll_wait en");
+        }
+
+        for (int i = 0; i < count; i++) {
+            uint32_t token = events[i].data.u32;
+            if (token == STOP_TOKEN) {
+                return 0;
+            }
+            if (token == LISTEN_TOKEN) {
+                accept_clients(exporter);
+                continue;
+            }
+
+            ExporterClient* client = &exporter->clients[token];
+            if (client->fd < 0) {
+                continue;   // cerrado por un evento anterior del mismo lote
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_client(client);
+            } else if (events[i].events & EPOLLOUT) {
+                send_response(exporter, client);
+            } else if (events[i].events & EPOLLIN) {
+                read_request(exporter, client);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// PUNTO DE ENTRADA
+// ============================================================================
+
+int run_exporter(const ExporterConfig* config) {
+    static Exporter exporter;
+    char name[64];
+
+    // SIGINT y SIGTERM por signalfd, bloqueadas antes de crear el hilo de muestreo
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    if (exporter_init(&exporter, config) < 0) {
+        fprintf(stderr, "%s\n", exporter.error);
+        return 1;
+    }
+
+    // Con un daemon en marcha no hace falta muestrear: se copia su muestra
+    exporter.attached = shared_default_name(name, sizeof(name)) == 0 &&
+                        shared_attach(&exporter.shared, name) == 0;
+    int signal_fd = signalfd(-1, &signals, SFD_CLOEXEC);
+    if (signal_fd < 0 ||
+        (!exporter.attached && sampler_start(&exporter.sampler, EXPORTER_LINKS_PERIOD_MS) < 0)) {
+        fprintf(stderr, "No se pudo iniciar el hilo de muestreo\n");
+        if (signal_fd >= 0) close(signal_fd);
+        if (exporter.attached) shared_close(&exporter.shared);
+        exporter_free(&exporter);
+        return 1;
+    }
+
+    printf("nx exporter (pid %d) sirviendo http://%s/metrics con datos de %s. Ctrl+C para terminar\n",
+           (int)getpid(), config->listen, exporter.attached ? "nx daemon" : "su propio hilo de muestreo");
+    fflush(stdout);
+
+    int result = serve(&exporter, signal_fd);
+    if (result < 0) {
+        fprintf(stderr, "%s\n", exporter.error);
+    }
+
+    if (exporter.attached) {
+        shared_close(&exporter.shared);
+    } else {
+        sampler_stop(&exporter.sampler);
+    }
+    close(signal_fd);
+    printf("nx exporter: %lu peticiones a /metrics\n", (unsigned long)exporter.scrapes);
+    exporter_free(&exporter);
+    return result < 0 ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+#define _GNU_SOURCE
+#include "flowtable.h"
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t flow_key_hash(const FlowKey* key) {
+    uint64_t words[sizeof(FlowKey) / sizeof(uint64_t)];
+    uint64_t hash = 0x9e3779b97f4a7c15ULL;
+    memcpy(words, key, sizeof(words));
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        hash ^= words[i];
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 32;
+    }
+    return (uint32_t)hash;
+}
+
+int flow_table_init(FlowTable* table, int capacity) {
+    void* memory;
+    uint32_t size = 64;
+
+    memset(table, 0, sizeof(FlowTable));
+    while (size < (uint32_t)capacity) {
+        size *= 2;
+    }
+
+    if (posix_memalign(&memory, 64, size * sizeof(FlowEntry)) != 0) {
+        return -1;
+    }
+    memset(memory, 0, size * sizeof(FlowEntry));
+
+    table->entries = memory;
+    table->mask = size - 1;
+    table->max_occupied = (uint32_t)((uint64_t)size * FLOW_TABLE_MAX_LOAD_PERCENT / 100);
+    return 0;
+}
+
+void flow_table_free(FlowTable* table) {
+    free(table->entries);
+    memset(table, 0, sizeof(FlowTable));
+}
+
+// ============================================================================
+// CAMINO CALIENTE
+// ============================================================================
+
+static void touch_entry(FlowTable* table, FlowEntry* entry, uint32_t bytes) {
+    uint32_t clock = __atomic_load_n(&table->clock, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&entry->last_seen, __ATOMIC_RELAXED) != clock) {
+        __atomic_store_n(&entry->last_seen, clock, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&entry->bytes, bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&entry->packets, 1, __ATOMIC_RELAXED);
+}
+
+// Reservar un hueco vacío o una lápida para un flujo nuevo.
+// Devuelve 1 si insertó, 0 si otro escritor ganó el hueco y -1 si la tabla está llena
+static int insert_entry(FlowTable* table, FlowEntry* entry, uint32_t expected,
+                        const FlowKey* key, uint32_t bytes) {
+    if ((uint32_t)__atomic_load_n(&table->occupied, __ATOMIC_RELAXED) >= table->max_occupied) {
+        return -1;
+    }
+    if (!__atomic_compare_exchange_n(&entry->state, &expected, FLOW_BUSY, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+
+    // El hueco es nuestro hasta publicarlo como vivo. Un escritor que casó la clave
+    // anterior antes de la expulsión pudo sumar después: eso va a overflow, no al flujo nuevo
+    entry->key = *key;
+    uint64_t stale_bytes = __atomic_exchange_n(&entry->bytes, bytes, __ATOMIC_RELAXED);
+    uint64_t stale_packets = __atomic_exchange_n(&entry->packets, 1, __ATOMIC_RELAXED);
+    if (stale_packets) {
+        __atomic_fetch_add(&table->overflow_packets, stale_packets, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&table->overflow_bytes, stale_bytes, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&entry->last_seen, __atomic_load_n(&table->clock, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->state, FLOW_LIVE, __ATOMIC_RELEASE);
+
+    int occupied = __atomic_add_fetch(&table->occupied, 1, __ATOMIC_RELAXED);
+    int peak = __atomic_load_n(&table->peak, __ATOMIC_RELAXED);
+    while (occupied > peak &&
+           !__atomic_compare_exchange_n(&table->peak, &peak, occupied, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    __atomic_fetch_add(&table->inserts, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+// Sin cerrojos ni reservas: un sondeo lineal acotado y, solo para flujos nuevos, un CAS.
+// Dos escritores que insertan a la vez el mismo flujo pueden crear dos entradas; el
+// consumidor suma por clave, así que solo cuesta un hueco
+void flow_table_add(FlowTable* table, const FlowKey* key, uint32_t bytes) {
+    uint32_t slot = flow_key_hash(key) & table->mask;
+    FlowEntry* tombstone = NULL;
+    int result = 0;
+
+    for (int probe = 0; probe < FLOW_TABLE_MAX_PROBE; probe++) {
+        FlowEntry* entry = &table->entries[slot];
+        uint32_t state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+
+        if (state == FLOW_LIVE) {
+            if (memcmp(&entry->key, key, sizeof(FlowKey)) == 0) {
+                touch_entry(table, entry, bytes);
+                return;
+            }
+        } else if (state == FLOW_EMPTY) {
+            // Fin de la cadena: el flujo no existe. Preferir la primera lápida vista
+            if (tombstone) {
+                result = insert_entry(table, tombstone, FLOW_TOMBSTONE, key, bytes);
+                tombstone = NULL;
+            } else {
+                result = insert_entry(table, entry, FLOW_EMPTY, key, bytes);
+            }
+            if (result != 0) {
+                break;
+            }
+            continue;   // otro escritor tomó el hueco: volver a mirarlo
+        } else if (state == FLOW_TOMBSTONE && !tombstone) {
+            tombstone = entry;
+        }
+
+        slot = (slot + 1) & table->mask;
+    }
+
+    if (result == 0 && tombstone) {
+        result = insert_entry(table, tombstone, FLOW_TOMBSTONE, key, bytes);
+    }
+    if (result <= 0) {
+        __atomic_fetch_add(&table->overflow_packets, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&table->overflow_bytes, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+// ============================================================================
+// CONSUMIDOR
+// ============================================================================
+
+int flow_table_drain_next(FlowTable* table, int position, FlowCounter* out) {
+    for (uint32_t i = (uint32_t)position; i <= table->mask; i++) {
+        FlowEntry* entry = &table->entries[i];
+        if (__atomic_load_n(&entry->state, __ATOMIC_ACQUIRE) != FLOW_LIVE ||
+            __atomic_load_n(&entry->packets, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+
+        // Solo el consumidor expulsa, así que la clave de una entrada viva no cambia aquí
+        out->key = entry->key;
+        out->packets = __atomic_exchange_n(&entry->packets, 0, __ATOMIC_RELAXED);
+        out->bytes = __atomic_exchange_n(&entry->bytes, 0, __ATOMIC_RELAXED);
+        return (int)i + 1;
+    }
+    return -1;
+}
+
+int flow_table_expire(FlowTable* table, uint32_t now, uint32_t idle_seconds) {
+    int evicted = 0;
+
+    __atomic_store_n(&table->clock, now, __ATOMIC_RELAXED);
+
+    for (uint32_t i = 0; i <= table->mask; i++) {
+        FlowEntry* entry = &table->entries[i];
+        uint32_t state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+        if (state != FLOW_LIVE ||
+            now - __atomic_load_n(&entry->last_seen, __ATOMIC_RELAXED) < idle_seconds ||
+            __atomic_load_n(&entry->packets, __ATOMIC_RELAXED) != 0) {
+            continue;
+        }
+
+        if (!__atomic_compare_exchange_n(&entry->state, &state, FLOW_TOMBSTONE, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        // Un escritor que encontró la entrada justo antes de expulsarla: devolverla a la vida
+        if (__atomic_load_n(&entry->packets, __ATOMIC_ACQUIRE) != 0) {
+            uint32_t expected = FLOW_TOMBSTONE;
+            if (__atomic_compare_exchange_n(&entry->state, &expected, FLOW_LIVE, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                continue;
+            }
+        }
+
+        // Lo que sumó un escritor rezagado tras la comprobación ya no lo retira nadie. Solo
+        // si el hueco sigue siendo lápida: reservado (BUSY) ninguna inserción lo reutiliza
+        // mientras se vacía, y si otro flujo ya lo ocupó sus contadores son suyos
+        uint32_t tombstone = FLOW_TOMBSTONE;
+        if (__atomic_compare_exchange_n(&entry->state, &tombstone, FLOW_BUSY, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            uint64_t late_packets = __atomic_exchange_n(&entry->packets, 0, __ATOMIC_RELAXED);
+            uint64_t late_bytes = __atomic_exchange_n(&entry->bytes, 0, __ATOMIC_RELAXED);
+            if (late_packets) {
+                __atomic_fetch_add(&table->overflow_packets, late_packets, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&table->overflow_bytes, late_bytes, __ATOMIC_RELAXED);
+            }
+            __atomic_store_n(&entry->state, FLOW_TOMBSTONE, __ATOMIC_RELEASE);
+        }
+
+        // El flujo expulsado deja de ocupar hueco aunque otro ya lo haya reutilizado:
+        // esa inserción sumó su propia entrada a occupied
+        __atomic_sub_fetch(&table->occupied, 1, __ATOMIC_RELAXED);
+        evicted++;
+    }
+
+    // Las lápidas al final de una cadena ya no separan nada: vaciarlas acorta los sondeos.
+    // Si un escritor inserta detrás a la vez, su flujo puede duplicarse, lo cual es inocuo
+    for (uint32_t i = table->mask + 1; i-- > 0; ) {
+        FlowEntry* entry = &table->entries[i];
+        FlowEntry* next = &table->entries[(i + 1) & table->mask];
+        uint32_t tombstone = FLOW_TOMBSTONE;
+        if (__atomic_load_n(&next->state, __ATOMIC_ACQUIRE) == FLOW_EMPTY) {
+            __atomic_compare_exchange_n(&entry->state, &tombstone, FLOW_EMPTY, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+        }
+    }
+
+    __atomic_fetch_add(&table->evictions, evicted, __ATOMIC_RELAXED);
+    return evicted;
+}
+
+void flow_table_get_stats(const FlowTable* table, FlowTableStats* stats) {
+    stats->capacity = (int)table->mask + 1;
+    stats->occupied = __atomic_load_n(&table->occupied, __ATOMIC_RELAXED);
+    stats->peak = __atomic_load_n(&table->peak, __ATOMIC_RELAXED);
+    stats->inserts = __atomic_load_n(&table->inserts, __ATOMIC_RELAXED);
+    stats->evictions = __atomic_load_n(&table->evictions, __ATOMIC_RELAXED);
+    stats->overflow_packets = __atomic_load_n(&table->overflow_packets, __ATOMIC_RELAXED);
+    stats->overflow_bytes = __atomic_load_n(&table->overflow_bytes, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,120 @@
+#define _GNU_SOURCE
+#include "histogram.h"
+#include <string.h>
+
+#define US_PER_MS 1000.0
+
+void histogram_init(LatencyHistogram* histogram) {
+    memset(histogram, 0, sizeof(LatencyHistogram));
+}
+
+// Hasta 2 * SUB_BUCKETS los valores tienen cubeta propia; a partir de ahí cada
+// potencia de dos se reparte en SUB_BUCKETS cubetas de ancho 1 << shift
+static int bucket_index(uint64_t us) {
+    if (us < HISTOGRAM_SUB_BUCKETS) {
+        return (int)us;
+    }
+    int msb = 63 - __builtin_clzll(us);
+    int shift = msb - HISTOGRAM_SUB_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (int)((us >> shift) - HISTOGRAM_SUB_BUCKETS);
+}
+
+// Mayor valor (µs) que cae en la cubeta
+static uint64_t bucket_upper(int index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t top = HISTOGRAM_SUB_BUCKETS + index % HISTOGRAM_SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void histogram_record(LatencyHistogram* histogram, double ms) {
+    double scaled = ms * US_PER_MS + 0.5;
+    uint64_t us = scaled <= 0.0 ? 0 : (scaled >= (double)HISTOGRAM_MAX_US ? HISTOGRAM_MAX_US : (uint64_t)scaled);
+
+    histogram->counts[bucket_index(us)]++;
+    if (histogram->count == 0 || us < histogram->min_us) histogram->min_us = (uint32_t)us;
+    if (us > histogram->max_us) histogram->max_us = (uint32_t)us;
+    histogram->count++;
+    histogram->sum_us += us;
+}
+
+void histogram_merge(LatencyHistogram* dst, const LatencyHistogram* src) {
+    if (src->count == 0) {
+        return;
+    }
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    if (dst->count == 0 || src->min_us < dst->min_us) dst->min_us = src->min_us;
+    if (src->max_us > dst->max_us) dst->max_us = src->max_us;
+    dst->count += src->count;
+    dst->sum_us += src->sum_us;
+}
+
+double histogram_percentile(const LatencyHistogram* histogram, double percentile) {
+    if (histogram->count == 0) {
+        return -1.0;
+    }
+    if (percentile <= 0.0) {
+        return histogram->min_us / US_PER_MS;
+    }
+
+    // Rango del valor buscado (1..count), redondeado hacia arriba como en HdrHistogram
+    uint64_t rank = (uint64_t)(percentile / 100.0 * histogram->count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > histogram->count) rank = histogram->count;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(i);
+            return (upper < histogram->max_us ? upper : histogram->max_us) / US_PER_MS;
+        }
+    }
+    return histogram->max_us / US_PER_MS;
+}
+
+double histogram_mean(const LatencyHistogram* histogram) {
+    return histogram->count > 0 ? (double)histogram->sum_us / histogram->count / US_PER_MS : -1.0;
+}
+
+int histogram_distribution(const LatencyHistogram* histogram, double values[], int bins, double* max_ms) {
+    *max_ms = 0.0;
+    if (histogram->count == 0 || bins <= 0) {
+        return 0;
+    }
+
+    // Las cubetas ya están en escala logarítmica: basta repartir su rango de índices
+    int first = bucket_index(histogram->min_us);
+    int last = bucket_index(histogram->max_us);
+    int span = last - first + 1;
+    if (bins > span) {
+        bins = span;
+    }
+
+    memset(values, 0, bins * sizeof(double));
+    for (int i = first; i <= last; i++) {
+        values[(int64_t)(i - first) * bins / span] += histogram->counts[i];
+    }
+
+    *max_ms = histogram->max_us / US_PER_MS;
+    return bins;
+}
+
+void histogram_cumulative(const LatencyHistogram* histogram, const double bounds_ms[], uint64_t counts[], int bounds) {
+    uint64_t seen = 0;
+    int bucket = 0;
+
+    // Una sola pasada: límites y cubetas están ordenados
+    for (int i = 0; i < bounds; i++) {
+        uint64_t limit_us = bounds_ms[i] * US_PER_MS >= (double)HISTOGRAM_MAX_US
+                                ? HISTOGRAM_MAX_US : (uint64_t)(bounds_ms[i] * US_PER_MS);
+        while (bucket < HISTOGRAM_BUCKETS && bucket_upper(bucket) <= limit_us) {
+            seen += histogram->counts[bucket++];
+        }
+        counts[i] = seen;
+    }
+}
@@ -1,9 +1,19 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <netinet/in.h>
 #include "utils.h"
 #include "collector.h"
+#include "probe.h"
+#include "tsdb.h"
+#include "shared.h"
+#include "daemon.h"
+#include "exporter.h"
+#include "output.h"
 #include "ui.h"
 
 // Función para mostrar ayuda
@@ -16,21 +26,77 @@ void show_help(void) {
     printf("  bandwidth               - Mostrar métricas de ancho de banda\n");
     printf("  connections             - Mostrar conexiones activas\n");
     printf("  interfaces              - Mostrar interfaces de red\n");
-    printf("  latency                 - Mostrar pruebas de latencia\n");
-    printf("  processes               - Mostrar procesos activos\n");
+    printf("  latency [--count N] [--interval MS] [--timeout MS] [destino...]\n");
+    printf("                          - Medir latencia (ICMP a \"host\", TCP a \"host:puerto\")\n");
+    printf("  latency --http [--parallel N] [--count N] [--interval MS] [--timeout MS] [url...]\n");
+    printf("                          - Desglosar DNS, TCP, TLS y primer byte de peticiones HTTP\n");
+    printf("  history <interfaz> [--from T] [--to T]\n");
+    printf("                          - Historial grabado por la TUI (T: now, -30m, -2h, -1d,\n");
+    printf("                            segundos Unix o \"AAAA-MM-DD HH:MM:SS\")\n");
+    printf("  processes [--ring] [--threads N]\n");
+    printf("                          - Mostrar procesos activos y su tráfico\n");
+    printf("                            (--threads 0 = un anillo por núcleo)\n");
+    printf("  daemon                  - Recolectar una vez para todos: tui, status y connections\n");
+    printf("                            leen su muestra de memoria compartida (NX_SHM)\n");
+    printf("  exporter [--listen HOST:PUERTO] [--clients N]\n");
+    printf("                          - Servir métricas OpenMetrics/Prometheus en /metrics\n");
+    printf("                            (por defecto %s)\n", EXPORTER_DEFAULT_LISTEN);
     printf("  tui                     - Interfaz gráfica en terminal\n\n");
+    printf("Opciones de status, bandwidth, interfaces, connections, processes y history:\n");
+    printf("  --format text|json|csv|binary\n");
+    printf("                          - Registros para otros programas (latency admite --format)\n");
+    printf("  --interval MS           - Repetir cada MS milisegundos hasta Ctrl+C o hasta que se\n");
+    printf("                            cierre la salida (history: seguir las muestras nuevas)\n\n");
     printf("Ejemplos:\n");
     printf("  nx help                 - Mostrar esta ayuda\n");
     printf("  nx status               - Estado del sistema\n");
     printf("  nx bandwidth            - Métricas de ancho de banda\n");
     printf("  nx tui                  - Interfaz gráfica interactiva\n");
+    printf("  nx connections --format json --interval 1000 | jq .remote_addr\n");
+}
+
+// Con `nx daemon` en marcha, copiar su última muestra en lugar de recolectar
+static int read_daemon_snapshot(Snapshot* snapshot) {
+    SharedSnapshot shared;
+    char name[64];
+    
+    if (shared_default_name(name, sizeof(name)) < 0 || shared_attach(&shared, name) < 0) {
+        return -1;
+    }
+    int copied = shared_read(&shared, snapshot);
+    shared_close(&shared);
+    return copied > 0 ? 0 : -1;
+}
+
+// Estado a partir de la muestra del daemon
+static void show_daemon_status(const Snapshot* snapshot) {
+    printf("Interfaces de Red:\n");
+    for (int i = 0; i < snapshot->interface_count; i++) {
+        printf("  %s (%s)\n", snapshot->interfaces[i], snapshot->interface_active[i] ? "activa" : "inactiva");
+    }
+    printf("\n");
+    
+    printf("Estadísticas del Sistema:\n");
+    printf("  Conexiones TCP activas: %d\n", snapshot->tcp_connections);
+    printf("  Procesos activos: %d\n", snapshot->processes);
+    printf("\n");
+    
+    printf("Última actualización: muestra #%lu de nx daemon (sockets hace %.1f s)\n",
+           (unsigned long)snapshot->sequence, snapshot_age(snapshot, SAMPLE_SOCKETS));
 }
 
 // Función para mostrar estado del sistema
 void show_status(void) {
+    static Snapshot snapshot;
+    
     printf("NLX - Estado del Sistema\n");
     printf("========================\n\n");
     
+    if (read_daemon_snapshot(&snapshot) == 0) {
+        show_daemon_status(&snapshot);
+        return;
+    }
+    
     // Interfaces de red
     printf("Interfaces de Red:\n");
     int interface_count;
@@ -94,25 +160,29 @@ void show_bandwidth(void) {
     printf("Interfaz: %s\n\n", active_interface);
     
     // Tomar primera medición
+    refresh_network_stats();
     NetworkStats stats1 = collect_network_stats(active_interface);
+    char received[MAX_FORMATTED], sent[MAX_FORMATTED], total[MAX_FORMATTED];
     printf("Medición inicial:\n");
-    printf("  Bytes recibidos: %s\n", format_bytes(stats1.rx_bytes));
-    printf("  Bytes enviados: %s\n", format_bytes(stats1.tx_bytes));
+    printf("  Bytes recibidos: %s\n", format_bytes(stats1.rx_bytes, received, sizeof(received)));
+    printf("  Bytes enviados: %s\n", format_bytes(stats1.tx_bytes, sent, sizeof(sent)));
     printf("  Paquetes recibidos: %lu\n", stats1.rx_packets);
     printf("  Paquetes enviados: %lu\n", stats1.tx_packets);
     printf("\n");
     
     printf("Esperando 2 segundos para calcular velocidades...\n");
-    sleep(2);
+    sleep_ms(2000);
     
     // Tomar segunda medición
+    refresh_network_stats();
     NetworkStats stats2 = collect_network_stats(active_interface);
-    calculate_speeds(&stats2, &stats1, 2.0);
+    calculate_speeds(&stats2, &stats1);
     
-    printf("Velocidades (últimos 2 segundos):\n");
-    printf("  Descarga: %s\n", format_speed(stats2.rx_speed));
-    printf("  Subida: %s\n", format_speed(stats2.tx_speed));
-    printf("  Total: %s\n", format_speed(stats2.total_speed));
+    printf("Velocidades (últimos %.3f segundos):\n", elapsed_seconds(stats1.timestamp_ns, stats2.timestamp_ns));
+    printf("  Descarga: %s\n  Subida: %s\n  Total: %s\n",
+           format_speed(stats2.rx_speed, received, sizeof(received)),
+           format_speed(stats2.tx_speed, sent, sizeof(sent)),
+           format_speed(stats2.total_speed, total, sizeof(total)));
     
     // Liberar memoria
     for (int i = 0; i < interface_count; i++) {
@@ -134,6 +204,9 @@ void show_interfaces(void) {
         return;
     }
     
+    // Un solo volcado para todas las interfaces
+    refresh_network_stats();
+    
     printf("Interfaces disponibles:\n");
     for (int i = 0; i < interface_count; i++) {
         int is_active = is_interface_active(interfaces[i]);
@@ -141,8 +214,9 @@ void show_interfaces(void) {
         
         printf("  %s:\n", interfaces[i]);
         printf("    Estado: %s\n", is_active ? "activa" : "inactiva");
-        printf("    Bytes recibidos: %s\n", format_bytes(stats.rx_bytes));
-        printf("    Bytes enviados: %s\n", format_bytes(stats.tx_bytes));
+        char received[MAX_FORMATTED], sent[MAX_FORMATTED];
+        printf("    Bytes recibidos: %s\n", format_bytes(stats.rx_bytes, received, sizeof(received)));
+        printf("    Bytes enviados: %s\n", format_bytes(stats.tx_bytes, sent, sizeof(sent)));
         printf("\n");
     }
     
@@ -154,112 +228,668 @@ void show_interfaces(void) {
 }
 
 // Función para mostrar procesos
-void show_processes(void) {
+void show_processes(const CaptureConfig* config) {
     printf("NLX - Procesos Activos\n");
     printf("======================\n\n");
     
     int processes = get_active_processes();
     printf("Total de procesos activos: %d\n", processes);
-    printf("Proceso actual (PID %d): %s\n", getpid(), get_process_name(getpid()));
+    printf("Proceso actual (PID %d): %s\n\n", getpid(), get_process_name(getpid()));
+    
+    // Tráfico por proceso a partir de la captura de paquetes
+    if (start_process_monitor("any", config) < 0) {
+        printf("No se pudo iniciar la captura de paquetes: %s\n", process_monitor_error());
+        printf("(se necesitan permisos CAP_NET_RAW para ver el tráfico por proceso)\n");
+        return;
+    }
+    
+    printf("Capturando tráfico durante 2 segundos...\n\n");
+    sleep_ms(2000);
+    update_process_monitor();
+    
+    int count;
+    ProcessTraffic* traffic = collect_process_traffic(&count);
+    
+    printf("%-8s %-16s %-14s %-14s\n", "PID", "Proceso", "Descarga", "Subida");
+    printf("----------------------------------------------------\n");
+    
+    int to_show = count > 10 ? 10 : count;
+    for (int i = 0; i < to_show; i++) {
+        char received[MAX_FORMATTED], sent[MAX_FORMATTED];
+        printf("%-8d %-16s %-14s %-14s\n", traffic[i].pid, traffic[i].comm,
+               format_speed(traffic[i].rx_speed, received, sizeof(received)),
+               format_speed(traffic[i].tx_speed, sent, sizeof(sent)));
+    }
+    if (count == 0) {
+        printf("Sin tráfico atribuible a procesos en el intervalo\n");
+    }
+    free(traffic);
+    
+    CaptureStats stats;
+    get_capture_stats(&stats);
+    char captured[MAX_FORMATTED], unattributed[MAX_FORMATTED], overflows[MAX_FORMATTED];
+    printf("\nCaptura: %lu paquetes, %s\n", stats.packets, format_bytes(stats.bytes, captured, sizeof(captured)));
+    printf("  Descartes del kernel: %lu  Descartes de interfaz: %lu\n",
+           stats.kernel_drops, stats.interface_drops);
+    printf("  Sin proceso: %s  Fuera de la tabla de flujos: %s\n",
+           format_bytes(stats.unattributed, unattributed, sizeof(unattributed)),
+           format_bytes(stats.flow_overflows, overflows, sizeof(overflows)));
+    printf("  Flujos: %d/%d en uso, %lu expulsados por inactividad\n",
+           stats.flow_occupied, stats.flow_capacity, stats.flow_evictions);
+    if (stats.ring_blocks_total > 0) {
+        printf("  Anillos (%d hilos): %d/%d bloques ocupados, %lu congelaciones\n",
+               stats.threads,
+               stats.ring_blocks_used, stats.ring_blocks_total, stats.ring_freezes);
+    }
+    
+    stop_process_monitor();
 }
 
 // Función para mostrar conexiones reales
 void show_connections(void) {
+    static Snapshot snapshot;
+    Connection* collected = NULL;
+    const Connection* connections;
+    int available;
+    int count;
+    
     printf("NLX - Conexiones Activas\n");
     printf("=========================\n\n");
     
-    int count;
-    Connection* connections = collect_connections(&count);
+    // El daemon publica las primeras SAMPLER_MAX_CONNECTIONS y el total
+    if (read_daemon_snapshot(&snapshot) == 0) {
+        connections = snapshot.connections;
+        available = snapshot.connection_count;
+        count = snapshot.connection_total;
+    } else {
+        collected = collect_connections(&count);
+        connections = collected;
+        available = count;
+    }
     
     if (!connections || count == 0) {
         printf("No se pudieron obtener las conexiones\n");
+        free(collected);
         return;
     }
     
-    printf("Conexiones TCP activas: %d\n\n", count);
+    printf("Conexiones activas (TCP/UDP): %d\n\n", count);
     
     // Mostrar las primeras 10 conexiones más relevantes
-    int to_show = count > 10 ? 10 : count;
+    int to_show = available > 10 ? 10 : available;
     printf("Primeras %d conexiones:\n", to_show);
-    printf("%-15s %-8s %-15s %-8s %-12s\n", "IP Local", "Puerto", "IP Remota", "Puerto", "Estado");
-    printf("------------------------------------------------------------\n");
+    printf("%-5s %-39s %-6s %-39s %-6s %-12s %s\n", "Proto", "IP Local", "Puerto", "IP Remota", "Puerto", "Estado", "Proceso");
+    printf("----------------------------------------------------------------------------------------------------------------------------\n");
     
     for (int i = 0; i < to_show; i++) {
-        printf("%-15s %-8d %-15s %-8d %-12s\n",
-               connections[i].local_ip,
+        char local_ip[MAX_IP_ADDRESS];
+        char remote_ip[MAX_IP_ADDRESS];
+        char owner[MAX_PROCESS_NAME + 16];
+        if (connections[i].pid > 0) {
+            snprintf(owner, sizeof(owner), "%d/%s", connections[i].pid, connections[i].process);
+        } else {
+            snprintf(owner, sizeof(owner), "-");
+        }
+        printf("%-5s %-39s %-6d %-39s %-6d %-12s %s\n",
+               connection_protocol_name(&connections[i]),
+               format_ip_address(connections[i].family, connections[i].local_addr, local_ip, sizeof(local_ip)),
                connections[i].local_port,
-               connections[i].remote_ip,
+               format_ip_address(connections[i].family, connections[i].remote_addr, remote_ip, sizeof(remote_ip)),
                connections[i].remote_port,
-               connections[i].state);
+               connections[i].protocol == IPPROTO_UDP ? "-" : connection_state_name(connections[i].state),
+               owner);
     }
     
-    if (count > 10) {
-        printf("\n... y %d conexiones más\n", count - 10);
+    if (count > to_show) {
+        printf("\n... y %d conexiones más\n", count - to_show);
     }
     
-    free(connections);
+    free(collected);
 }
 
-// Función para mostrar latencia real
-void show_latency(void) {
-    printf("NLX - Pruebas de Latencia\n");
-    printf("========================\n\n");
+// Registros de latencia al terminar los sondeos
+static int latency_view(Output* output, void* context) {
+    const ProbeEngine* engine = context;
     
-    int count;
-    LatencyTest* tests = collect_latency_tests(&count);
+    for (int i = 0; i < engine->count; i++) {
+        const ProbeTarget* target = &engine->targets[i];
+        const LatencyHistogram* histogram = &target->histogram;
+        int answered = target->received > 0;
+        output_begin(output, "latency");
+        output_string(output, "target", target->name);
+        output_string(output, "probe", probe_type_name(target->type));
+        output_u64(output, "sent", target->sent);
+        output_u64(output, "received", target->received);
+        output_double(output, "min_ms", answered ? target->min_ms : NAN);
+        output_double(output, "p50_ms", answered ? histogram_percentile(histogram, 50.0) : NAN);
+        output_double(output, "p99_ms", answered ? histogram_percentile(histogram, 99.0) : NAN);
+        output_double(output, "p999_ms", answered ? histogram_percentile(histogram, 99.9) : NAN);
+        output_double(output, "max_ms", answered ? target->max_ms : NAN);
+        output_string(output, "error", answered ? "" : target->status == PROBE_TIMEOUT ? "timeout" : strerror(target->error));
+        output_end(output);
+    }
+    return 0;
+}
+
+static int http_latency_view(Output* output, void* context) {
+    static const char* phases[HTTP_PHASES] = { "dns_ms", "tcp_ms", "tls_ms", "first_byte_ms", "total_ms" };
+    const HttpProbeEngine* engine = context;
+    
+    for (int i = 0; i < engine->count; i++) {
+        const HttpTarget* target = &engine->targets[i];
+        int answered = target->received > 0;
+        output_begin(output, "http");
+        output_string(output, "url", target->url);
+        output_u64(output, "code", target->http_code > 0 ? (uint64_t)target->http_code : 0);
+        output_u64(output, "sent", target->sent);
+        output_u64(output, "received", target->received);
+        for (int phase = 0; phase < HTTP_PHASES; phase++) {
+            output_double(output, phases[phase], answered ? target->total_ms[phase] / target->received : NAN);
+        }
+        output_double(output, "total_p99_ms", answered ? histogram_percentile(&target->histogram, 99.0) : NAN);
+        output_u64(output, "connections", target->connections);
+        output_string(output, "error", answered ? "" : target->error);
+        output_end(output);
+    }
+    return 0;
+}
+
+// Función para mostrar latencia real (ICMP para "host", TCP para "host:puerto")
+void show_latency(const ProbeConfig* config, const char** targets, int target_count, const OutputConfig* output) {
+    static const char* default_targets[] = { PROBE_DEFAULT_TARGETS };
+    ProbeEngine engine;
+    FILE* info = output->format == OUTPUT_TEXT ? stdout : stderr;   // stdout solo lleva registros
+    
+    fprintf(info, "NLX - Pruebas de Latencia\n");
+    fprintf(info, "========================\n\n");
+    
+    if (target_count == 0) {
+        targets = default_targets;
+        target_count = sizeof(default_targets) / sizeof(default_targets[0]);
+    }
     
-    if (!tests) {
-        printf("No se pudieron realizar las pruebas de latencia\n");
+    if (probe_engine_init(&engine, config) < 0) {
+        fprintf(info, "No se pudieron realizar las pruebas de latencia: %s\n", probe_engine_error(&engine));
+        return;
+    }
+    for (int i = 0; i < target_count; i++) {
+        if (probe_engine_add(&engine, targets[i]) < 0) {
+            fprintf(info, "Omitido: %s\n", probe_engine_error(&engine));
+        }
+    }
+    if (engine.count == 0) {
+        probe_engine_free(&engine);
         return;
     }
     
-    printf("Probando conectividad a %d servidores...\n\n", count);
-    printf("%-15s %-12s %-10s\n", "Servidor", "Latencia", "Estado");
-    printf("----------------------------------------\n");
+    fprintf(info, "Probando conectividad a %d destinos (%d sondeos cada %d ms)...\n\n",
+            engine.count, config->rounds, config->interval_ms);
+    probe_engine_run(&engine);
+    if (output->format != OUTPUT_TEXT) {
+        output_run(output, latency_view, &engine);
+        probe_engine_free(&engine);
+        return;
+    }
     
-    for (int i = 0; i < count; i++) {
-        printf("%-15s ", tests[i].server);
+    printf("%-24s %-5s %-9s %10s %10s %10s %10s %10s  %s\n", "Destino", "Tipo", "Recibidos",
+           "Mín", "p50", "p99", "p99.9", "Máx", "Estado");
+    printf("------------------------------------------------------------------------------------------------------------------\n");
+    
+    int good_connections = 0;
+    double total_latency = 0.0;
+    LatencyHistogram all;
+    histogram_init(&all);
+    
+    for (int i = 0; i < engine.count; i++) {
+        const ProbeTarget* target = &engine.targets[i];
+        printf("%-24s %-5s %4lu/%-4lu ", target->name, probe_type_name(target->type),
+               (unsigned long)target->received, (unsigned long)target->sent);
         
-        if (tests[i].status == 0 && tests[i].latency > 0) {
-            printf("%-12.1fms ", tests[i].latency);
+        if (target->received > 0) {
+            double average = target->total_ms / target->received;
+            const LatencyHistogram* histogram = &target->histogram;
+            printf("%7.3f ms %7.3f ms %7.3f ms %7.3f ms %7.3f ms  ", target->min_ms,
+                   histogram_percentile(histogram, 50.0), histogram_percentile(histogram, 99.0),
+                   histogram_percentile(histogram, 99.9), target->max_ms);
+            good_connections++;
+            total_latency += average;
+            histogram_merge(&all, histogram);
             
             // Color según latencia
-            if (tests[i].latency < 20) {
+            if (average < 20) {
                 printf("✅ Excelente");
-            } else if (tests[i].latency < 50) {
+            } else if (average < 50) {
                 printf("🟡 Buena");
-            } else if (tests[i].latency < 100) {
+            } else if (average < 100) {
                 printf("🟠 Regular");
             } else {
                 printf("🔴 Lenta");
             }
-        } else if (tests[i].status == 1) {
-            printf("%-12s ⏰ Timeout", "N/A");
+        } else if (target->status == PROBE_TIMEOUT) {
+            printf("%10s %10s %10s %10s %10s  ⏰ Timeout", "N/A", "N/A", "N/A", "N/A", "N/A");
         } else {
-            printf("%-12s ❌ Error", "N/A");
+            printf("%10s %10s %10s %10s %10s  ❌ %s", "N/A", "N/A", "N/A", "N/A", "N/A", strerror(target->error));
         }
         printf("\n");
     }
     
     printf("\nResumen:\n");
-    int good_connections = 0;
-    double total_latency = 0.0;
-    int valid_tests = 0;
+    printf("  Destinos con respuesta: %d/%d\n", good_connections, engine.count);
+    if (good_connections > 0) {
+        printf("  Latencia promedio: %.3fms\n", total_latency / good_connections);
+        printf("  Todos los sondeos: p50 %.3fms, p99 %.3fms, p99.9 %.3fms\n",
+               histogram_percentile(&all, 50.0), histogram_percentile(&all, 99.0),
+               histogram_percentile(&all, 99.9));
+    }
+    
+    probe_engine_free(&engine);
+}
+
+// Función para mostrar el desglose de peticiones HTTP concurrentes
+void show_http_latency(const ProbeConfig* config, const char** urls, int url_count, const OutputConfig* output) {
+    static const char* default_urls[] = { PROBE_HTTP_DEFAULT_TARGETS };
+    HttpProbeEngine engine;
+    FILE* info = output->format == OUTPUT_TEXT ? stdout : stderr;
+    
+    fprintf(info, "NLX - Latencia HTTP\n");
+    fprintf(info, "===================\n\n");
+    
+    if (url_count == 0) {
+        urls = default_urls;
+        url_count = sizeof(default_urls) / sizeof(default_urls[0]);
+    }
+    
+    if (http_probe_init(&engine, config) < 0) {
+        fprintf(info, "No se pudieron realizar las pruebas HTTP: %s\n", engine.error);
+        return;
+    }
+    for (int i = 0; i < url_count; i++) {
+        if (http_probe_add(&engine, urls[i]) < 0) {
+            fprintf(info, "Omitido %s: %s\n", urls[i], engine.error);
+        }
+    }
+    if (engine.count == 0) {
+        http_probe_free(&engine);
+        return;
+    }
+    
+    fprintf(info, "Probando %d URLs (%d peticiones cada %d ms, máximo %d en vuelo)...\n\n",
+            engine.count, config->rounds, config->interval_ms, engine.config.max_in_flight);
+    if (http_probe_run(&engine) < 0) {
+        fprintf(info, "Error: %s\n", engine.error);
+    }
+    if (output->format != OUTPUT_TEXT) {
+        output_run(output, http_latency_view, &engine);
+        http_probe_free(&engine);
+        return;
+    }
+    
+    printf("%-32s %4s %-9s", "URL", "Cód", "Recibidos");
+    for (int phase = 0; phase < HTTP_PHASES; phase++) {
+        printf(" %11s", http_phase_name(phase));
+    }
+    printf(" %11s %9s\n", "Total p99", "Conexiones");
+    printf("-------------------------------------------------------------------------------------------------------------------------\n");
+    
+    for (int i = 0; i < engine.count; i++) {
+        const HttpTarget* target = &engine.targets[i];
+        printf("%-32.32s %4ld %4lu/%-4lu", target->url, target->http_code,
+               (unsigned long)target->received, (unsigned long)target->sent);
+        
+        if (target->received > 0) {
+            // Medias por petición: con la conexión reutilizada DNS, TCP y TLS cuentan como 0
+            for (int phase = 0; phase < HTTP_PHASES; phase++) {
+                printf(" %8.3f ms", target->total_ms[phase] / target->received);
+            }
+            printf(" %8.3f ms %9lu\n", histogram_percentile(&target->histogram, 99.0),
+                   (unsigned long)target->connections);
+        } else {
+            printf("  %s %s\n", target->status == PROBE_TIMEOUT ? "⏰" : "❌", target->error);
+        }
+    }
+    
+    http_probe_free(&engine);
+}
+
+// Recorrido del historial: velocidades entre muestras consecutivas
+typedef struct {
+    Tsdb db;
+    const char* interface;
+    uint64_t from_ms;
+    uint64_t to_ms;
+    int follow;                 // --interval: seguir leyendo las muestras nuevas
+    Output* output;
+    TsdbSample previous;
+    int has_previous;
+} HistoryView;
+
+static void print_history_sample(const TsdbSample* sample, void* context) {
+    HistoryView* view = context;
+    double rx_speed = NAN;
+    double tx_speed = NAN;
+    
+    // Un contador que retrocede es un reinicio de la interfaz: sin velocidad para ese tramo
+    double elapsed = view->has_previous ? (sample->timestamp_ms - view->previous.timestamp_ms) / 1000.0 : 0.0;
+    if (elapsed > 0 && sample->rx_bytes >= view->previous.rx_bytes && sample->tx_bytes >= view->previous.tx_bytes) {
+        rx_speed = bytes_to_mbps(sample->rx_bytes - view->previous.rx_bytes, elapsed);
+        tx_speed = bytes_to_mbps(sample->tx_bytes - view->previous.tx_bytes, elapsed);
+    }
+    view->previous = *sample;
+    view->has_previous = 1;
+    
+    Output* output = view->output;
+    if (output->format != OUTPUT_TEXT) {
+        output->time_ms = sample->timestamp_ms;
+        output_begin(output, "history");
+        output_string(output, "interface", view->interface);
+        output_u64(output, "rx_bytes", sample->rx_bytes);
+        output_u64(output, "tx_bytes", sample->tx_bytes);
+        output_double(output, "rx_bytes_per_second", rx_speed * 1024.0 * 1024.0);
+        output_double(output, "tx_bytes_per_second", tx_speed * 1024.0 * 1024.0);
+        output_end(output);
+        return;
+    }
+    
+    time_t seconds = (time_t)(sample->timestamp_ms / 1000);
+    struct tm tm;
+    char when[32];
+    char rx[MAX_FORMATTED], tx[MAX_FORMATTED], received[MAX_FORMATTED], sent[MAX_FORMATTED];
+    
+    localtime_r(&seconds, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+    printf("%s  %14s %14s %12s %12s\n", when,
+           isnan(rx_speed) ? "-" : format_speed(rx_speed, rx, sizeof(rx)),
+           isnan(tx_speed) ? "-" : format_speed(tx_speed, tx, sizeof(tx)),
+           format_bytes(sample->rx_bytes, received, sizeof(received)),
+           format_bytes(sample->tx_bytes, sent, sizeof(sent)));
+}
+
+static int history_view(Output* output, void* context) {
+    HistoryView* view = context;
+    
+    view->output = output;
+    if (view->follow) {
+        view->to_ms = tsdb_now_ms();
+    }
+    uint64_t start = monotonic_ns();
+    int count = tsdb_scan(&view->db, view->interface, view->from_ms, view->to_ms, print_history_sample, view);
+    double elapsed = elapsed_seconds(start, monotonic_ns());
+    
+    if (count < 0) {
+        fprintf(stderr, "Sin memoria para recorrer el historial\n");
+        return -1;
+    }
+    if (!view->follow) {
+        fprintf(stderr, "%d muestras de %s en %.1f ms\n", count, view->interface, elapsed * 1000.0);
+    } else if (view->has_previous) {
+        view->from_ms = view->previous.timestamp_ms + 1;   // la siguiente pasada, solo lo nuevo
+    }
+    return 0;
+}
+
+// Función para consultar el historial grabado (con --interval sigue las muestras nuevas)
+int show_history(const char* interface, const char* from, const char* to, const OutputConfig* config) {
+    static HistoryView view;
+    char path[512];
+    uint64_t now = tsdb_now_ms();
+    
+    memset(&view, 0, sizeof(view));
+    view.interface = interface;
+    view.follow = config->interval_ms > 0;
+    if (tsdb_parse_time(from, now, &view.from_ms) < 0 || tsdb_parse_time(to, now, &view.to_ms) < 0) {
+        fprintf(stderr, "Hora no válida (usa now, -30m, -2h, -1d, segundos Unix o \"AAAA-MM-DD HH:MM:SS\")\n");
+        return -1;
+    }
+    if (tsdb_default_path(path, sizeof(path)) < 0) {
+        fprintf(stderr, "No se encontró el historial: define NX_HISTORY o HOME\n");
+        return -1;
+    }
+    if (tsdb_open(&view.db, path, 0, 0) < 0) {
+        fprintf(stderr, "%s\n", view.db.error);
+        return -1;
+    }
     
+    if (config->format == OUTPUT_TEXT) {
+        printf("%-19s  %14s %14s %12s %12s\n", "Hora", "Descarga", "Subida", "Recibidos", "Enviados");
+        printf("---------------------------------------------------------------------------\n");
+    }
+    int result = output_run(config, history_view, &view);
+    tsdb_close(&view.db);
+    return result;
+}
+
+// ============================================================================
+// SALIDA PARA MÁQUINAS (--format) Y REPETICIÓN (--interval)
+// ============================================================================
+
+// Registros de `nx status`: uno por interfaz y otro con los totales
+static void output_status(Output* output, char names[][MAX_INTERFACE_NAME], const int* active, int count,
+                          int connections, int processes) {
     for (int i = 0; i < count; i++) {
-        if (tests[i].status == 0 && tests[i].latency > 0) {
-            good_connections++;
-            total_latency += tests[i].latency;
-            valid_tests++;
+        output_begin(output, "interface");
+        output_string(output, "name", names[i]);
+        output_u64(output, "active", active[i] != 0);
+        output_end(output);
+    }
+    output_begin(output, "system");
+    output_u64(output, "tcp_connections", connections > 0 ? connections : 0);
+    output_u64(output, "processes", processes > 0 ? processes : 0);
+    output_end(output);
+}
+
+static int status_view(Output* output, void* context) {
+    static Snapshot snapshot;
+    char names[SAMPLER_MAX_INTERFACES][MAX_INTERFACE_NAME];
+    int active[SAMPLER_MAX_INTERFACES];
+    (void)context;
+    
+    if (output->format == OUTPUT_TEXT) {
+        show_status();
+    } else if (read_daemon_snapshot(&snapshot) == 0) {
+        output_status(output, snapshot.interfaces, snapshot.interface_active, snapshot.interface_count,
+                      snapshot.tcp_connections, snapshot.processes);
+    } else {
+        int count = list_interfaces(names, active, SAMPLER_MAX_INTERFACES);
+        output_status(output, names, active, count, get_connection_count(), get_active_processes());
+    }
+    return 0;
+}
+
+static int interfaces_view(Output* output, void* context) {
+    char names[SAMPLER_MAX_INTERFACES][MAX_INTERFACE_NAME];
+    int active[SAMPLER_MAX_INTERFACES];
+    (void)context;
+    
+    if (output->format == OUTPUT_TEXT) {
+        show_interfaces();
+        return 0;
+    }
+    
+    int count = list_interfaces(names, active, SAMPLER_MAX_INTERFACES);
+    refresh_network_stats();
+    for (int i = 0; i < count; i++) {
+        NetworkStats stats = collect_network_stats(names[i]);
+        output_begin(output, "interface");
+        output_string(output, "name", names[i]);
+        output_u64(output, "active", active[i] != 0);
+        output_u64(output, "rx_bytes", stats.rx_bytes);
+        output_u64(output, "tx_bytes", stats.tx_bytes);
+        output_u64(output, "rx_packets", stats.rx_packets);
+        output_u64(output, "tx_packets", stats.tx_packets);
+        output_end(output);
+    }
+    return 0;
+}
+
+// Todas las conexiones (el daemon solo publica las primeras SAMPLER_MAX_CONNECTIONS)
+static int connections_view(Output* output, void* context) {
+    int count;
+    (void)context;
+    
+    if (output->format == OUTPUT_TEXT) {
+        show_connections();
+        return 0;
+    }
+    
+    Connection* connections = collect_connections(&count);
+    if (!connections && count == 0) {
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        output_connection(output, &connections[i]);
+    }
+    free(connections);
+    return 0;
+}
+
+// Velocidad de la primera interfaz activa entre dos pasadas
+typedef struct {
+    char interface[MAX_INTERFACE_NAME];
+    NetworkStats previous;
+    int has_previous;
+} BandwidthView;
+
+static int bandwidth_view(Output* output, void* context) {
+    BandwidthView* view = context;
+    
+    refresh_network_stats();
+    NetworkStats stats = collect_network_stats(view->interface);
+    if (!view->has_previous) {
+        view->previous = stats;
+        view->has_previous = 1;
+        return 0;
+    }
+    calculate_speeds(&stats, &view->previous);
+    double elapsed = elapsed_seconds(view->previous.timestamp_ns, stats.timestamp_ns);
+    view->previous = stats;
+    
+    if (output->format == OUTPUT_TEXT) {
+        time_t now = time(NULL);
+        struct tm tm;
+        char when[16];
+        char rx[MAX_FORMATTED], tx[MAX_FORMATTED], total[MAX_FORMATTED];
+        localtime_r(&now, &tm);
+        strftime(when, sizeof(when), "%H:%M:%S", &tm);
+        printf("%-8s  %14s %14s %14s\n", when, format_speed(stats.rx_speed, rx, sizeof(rx)),
+               format_speed(stats.tx_speed, tx, sizeof(tx)), format_speed(stats.total_speed, total, sizeof(total)));
+        return 0;
+    }
+    
+    output_begin(output, "bandwidth");
+    output_string(output, "interface", view->interface);
+    output_double(output, "seconds", elapsed);
+    output_u64(output, "rx_bytes", stats.rx_bytes);
+    output_u64(output, "tx_bytes", stats.tx_bytes);
+    output_double(output, "rx_bytes_per_second", stats.rx_speed * 1024.0 * 1024.0);
+    output_double(output, "tx_bytes_per_second", stats.tx_speed * 1024.0 * 1024.0);
+    output_end(output);
+    return 0;
+}
+
+int run_bandwidth(const OutputConfig* config) {
+    static BandwidthView view;
+    char names[SAMPLER_MAX_INTERFACES][MAX_INTERFACE_NAME];
+    int active[SAMPLER_MAX_INTERFACES];
+    
+    if (config->format == OUTPUT_TEXT && config->interval_ms == 0) {
+        show_bandwidth();
+        return 0;
+    }
+    
+    memset(&view, 0, sizeof(view));
+    int count = list_interfaces(names, active, SAMPLER_MAX_INTERFACES);
+    for (int i = 0; i < count && !view.interface[0]; i++) {
+        if (active[i]) {
+            snprintf(view.interface, sizeof(view.interface), "%s", names[i]);
         }
     }
+    if (!view.interface[0]) {
+        fprintf(stderr, "No se encontró ninguna interfaz activa\n");
+        return -1;
+    }
     
-    printf("  Conexiones exitosas: %d/%d\n", good_connections, count);
-    if (valid_tests > 0) {
-        printf("  Latencia promedio: %.1fms\n", total_latency / valid_tests);
+    if (config->interval_ms == 0) {
+        // Una sola medida de 2 s, como en formato texto
+        refresh_network_stats();
+        view.previous = collect_network_stats(view.interface);
+        view.has_previous = 1;
+        sleep_ms(2000);
+    } else if (config->format == OUTPUT_TEXT) {
+        printf("Interfaz: %s (cada %d ms)\n\n", view.interface, config->interval_ms);
+        printf("%-8s  %14s %14s %14s\n", "Hora", "Descarga", "Subida", "Total");
+    }
+    return output_run(config, bandwidth_view, &view);
+}
+
+// Tráfico por proceso entre dos pasadas; la captura arranca en la primera
+typedef struct {
+    const CaptureConfig* capture;
+    int started;
+} ProcessesView;
+
+static int processes_view(Output* output, void* context) {
+    ProcessesView* view = context;
+    int count;
+    
+    if (!view->started) {
+        if (start_process_monitor("any", view->capture) < 0) {
+            fprintf(stderr, "No se pudo iniciar la captura de paquetes: %s\n", process_monitor_error());
+            return -1;
+        }
+        view->started = 1;
+        return 0;
     }
     
-    free(tests);
+    update_process_monitor();
+    ProcessTraffic* traffic = collect_process_traffic(&count);
+    if (output->format == OUTPUT_TEXT) {
+        int to_show = count > 10 ? 10 : count;
+        printf("\n%-8s %-16s %-14s %-14s\n", "PID", "Proceso", "Descarga", "Subida");
+        for (int i = 0; i < to_show; i++) {
+            char received[MAX_FORMATTED], sent[MAX_FORMATTED];
+            printf("%-8d %-16s %-14s %-14s\n", traffic[i].pid, traffic[i].comm,
+                   format_speed(traffic[i].rx_speed, received, sizeof(received)),
+                   format_speed(traffic[i].tx_speed, sent, sizeof(sent)));
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            output_begin(output, "process");
+            output_u64(output, "pid", traffic[i].pid > 0 ? traffic[i].pid : 0);
+            output_string(output, "comm", traffic[i].comm);
+            output_u64(output, "rx_bytes", traffic[i].rx_bytes);
+            output_u64(output, "tx_bytes", traffic[i].tx_bytes);
+            output_double(output, "rx_bytes_per_second", traffic[i].rx_speed * 1024.0 * 1024.0);
+            output_double(output, "tx_bytes_per_second", traffic[i].tx_speed * 1024.0 * 1024.0);
+            output_end(output);
+        }
+    }
+    free(traffic);
+    return 0;
+}
+
+int run_processes(const CaptureConfig* capture, const OutputConfig* config) {
+    ProcessesView view = { capture, 0 };
+    
+    if (config->format == OUTPUT_TEXT && config->interval_ms == 0) {
+        show_processes(capture);
+        return 0;
+    }
+    
+    int result;
+    if (config->interval_ms == 0) {
+        // Arranque, 2 s de captura y una sola pasada, como en formato texto
+        result = processes_view(NULL, &view);
+        if (result == 0) {
+            sleep_ms(2000);
+            result = output_run(config, processes_view, &view);
+        }
+    } else {
+        result = output_run(config, processes_view, &view);
+    }
+    if (view.started) {
+        stop_process_monitor();
+    }
+    return result;
 }
 
 // Función para ejecutar interfaz TUI
@@ -267,6 +897,23 @@ void show_tui(void) {
     run_tui();
 }
 
+// Opción que no reconoce el comando o valor de --format/--interval no válido
+static int invalid_option(const char* option) {
+    fprintf(stderr, "Opción no válida: %s (ver nx help)\n", option);
+    return 1;
+}
+
+// Comandos sin opciones propias: solo --format e --interval
+static int parse_output_options(OutputConfig* config, int argc, char** argv) {
+    for (int i = 2; i < argc; i++) {
+        if (output_parse_option(config, argc, argv, &i) <= 0) {
+            invalid_option(argv[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Si no hay argumentos, mostrar ayuda
     if (argc < 2) {
@@ -275,26 +922,113 @@ int main(int argc, char* argv[]) {
     }
     
     // Parsear comando
+    OutputConfig output;
+    output_default_config(&output);
+    int result = 0;
+    
     if (strcmp(argv[1], "help") == 0) {
         show_help();
     }
     else if (strcmp(argv[1], "status") == 0) {
-        show_status();
+        if (parse_output_options(&output, argc, argv) < 0) return 1;
+        result = output_run(&output, status_view, NULL);
     }
     else if (strcmp(argv[1], "bandwidth") == 0) {
-        show_bandwidth();
+        if (parse_output_options(&output, argc, argv) < 0) return 1;
+        result = run_bandwidth(&output);
     }
     else if (strcmp(argv[1], "interfaces") == 0) {
-        show_interfaces();
+        if (parse_output_options(&output, argc, argv) < 0) return 1;
+        result = output_run(&output, interfaces_view, NULL);
     }
     else if (strcmp(argv[1], "processes") == 0) {
-        show_processes();
+        CaptureConfig config;
+        capture_default_config(&config);
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--ring") == 0) {
+                config.backend = CAPTURE_BACKEND_RING;
+            } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                config.backend = CAPTURE_BACKEND_RING;   // el reparto entre hilos requiere el anillo
+                config.threads = atoi(argv[++i]);
+            } else if (output_parse_option(&output, argc, argv, &i) <= 0) {
+                return invalid_option(argv[i]);
+            }
+        }
+        result = run_processes(&config, &output);
     }
     else if (strcmp(argv[1], "connections") == 0) {
-        show_connections();
+        if (parse_output_options(&output, argc, argv) < 0) return 1;
+        result = output_run(&output, connections_view, NULL);
     }
     else if (strcmp(argv[1], "latency") == 0) {
-        show_latency();
+        ProbeConfig config;
+        const char** targets = (const char**)&argv[2];
+        int target_count = 0;
+        int http = 0;
+        probe_default_config(&config);
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+                config.rounds = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+                config.interval_ms = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+                config.timeout_ms = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) {
+                config.max_in_flight = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--http") == 0) {
+                http = 1;
+            } else if (strcmp(argv[i], "--format") == 0) {
+                // --interval es el espacio entre sondeos: aquí solo cuenta --format
+                if (output_parse_option(&output, argc, argv, &i) < 0) return invalid_option(argv[i]);
+            } else {
+                targets[target_count++] = argv[i];   // compactar los destinos sobre argv
+            }
+        }
+        if (config.rounds < 1) config.rounds = 1;
+        if (config.interval_ms < 1) config.interval_ms = 1;
+        if (config.timeout_ms < 1) config.timeout_ms = 1;
+        if (config.max_in_flight < 1) config.max_in_flight = 1;
+        if (http) {
+            show_http_latency(&config, targets, target_count, &output);
+        } else {
+            show_latency(&config, targets, target_count, &output);
+        }
+    }
+    else if (strcmp(argv[1], "history") == 0) {
+        const char* interface = NULL;
+        const char* from = "-1h";
+        const char* to = "now";
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+                from = argv[++i];
+            } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+                to = argv[++i];
+            } else {
+                int parsed = output_parse_option(&output, argc, argv, &i);
+                if (parsed < 0) return invalid_option(argv[i]);
+                if (parsed == 0) interface = argv[i];
+            }
+        }
+        if (!interface) {
+            printf("Uso: nx history <interfaz> [--from T] [--to T] [--format F] [--interval MS]\n");
+            return 1;
+        }
+        result = show_history(interface, from, to, &output);
+    }
+    else if (strcmp(argv[1], "daemon") == 0) {
+        return run_daemon();
+    }
+    else if (strcmp(argv[1], "exporter") == 0) {
+        ExporterConfig config;
+        exporter_default_config(&config);
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+                snprintf(config.listen, sizeof(config.listen), "%s", argv[++i]);
+            } else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc) {
+                config.max_clients = atoi(argv[++i]);
+            }
+        }
+        return run_exporter(&config);
     }
     else if (strcmp(argv[1], "tui") == 0) {
         show_tui();
@@ -305,5 +1039,5 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    return 0;
+    return result < 0 ? 1 : 0;
 } 
\ No newline at end of file
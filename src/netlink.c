@@ -0,0 +1,636 @@
+#define _GNU_SOURCE
+#include "netlink.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if.h>
+#include <linux/if_link.h>
+#include <linux/if_addr.h>
+
+// Tamaño del buffer de socket para volcados con miles de interfaces
+#define NETLINK_SOCKET_BUFFER (4 * 1024 * 1024)
+
+// ============================================================================
+// SOCKETS NETLINK
+// ============================================================================
+
+// Abrir socket NETLINK_ROUTE suscrito opcionalmente a grupos multicast
+int nl_open(unsigned int groups) {
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int buffer_size = NETLINK_SOCKET_BUFFER;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = groups;
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void nl_close(int fd) {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Mensaje ajeno al volcado con número de secuencia seq: la cola de un volcado anterior
+// que se abortó. Las notificaciones llevan seq 0 y se aplican; NLMSG_DONE y NLMSG_ERROR
+// solo cierran el volcado si son suyos
+static int foreign_message(const struct nlmsghdr* nlh, int seq) {
+    if (nlh->nlmsg_seq == (uint32_t)seq) {
+        return 0;
+    }
+    return nlh->nlmsg_seq != 0 || nlh->nlmsg_type == NLMSG_DONE || nlh->nlmsg_type == NLMSG_ERROR;
+}
+
+// ============================================================================
+// TABLA DE ESTADÍSTICAS DE ENLACES
+// ============================================================================
+
+// Hash FNV-1a para nombres de interfaz
+static uint32_t hash_name(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Asegurar que la tabla tiene espacio para un ifindex
+static int ensure_capacity(LinkStatsTable* table, int ifindex) {
+    if (ifindex < table->capacity) {
+        return 0;
+    }
+
+    int capacity = table->capacity > 0 ? table->capacity : 64;
+    while (capacity <= ifindex) {
+        capacity *= 2;
+    }
+
+    NetworkStats* stats = realloc(table->stats, capacity * sizeof(NetworkStats));
+    if (!stats) return -1;
+    table->stats = stats;
+
+    char (*names)[MAX_INTERFACE_NAME] = realloc(table->names, capacity * sizeof(*names));
+    if (!names) return -1;
+    table->names = names;
+
+    uint8_t* operstate = realloc(table->operstate, capacity * sizeof(uint8_t));
+    if (!operstate) return -1;
+    table->operstate = operstate;
+
+    uint32_t* flags = realloc(table->flags, capacity * sizeof(uint32_t));
+    if (!flags) return -1;
+    table->flags = flags;
+
+    uint32_t* seen = realloc(table->seen, capacity * sizeof(uint32_t));
+    if (!seen) return -1;
+    table->seen = seen;
+
+    // Inicializar solo la parte nueva
+    int added = capacity - table->capacity;
+    memset(&table->stats[table->capacity], 0, added * sizeof(NetworkStats));
+    memset(&table->names[table->capacity], 0, added * sizeof(*names));
+    memset(&table->operstate[table->capacity], 0, added * sizeof(uint8_t));
+    memset(&table->flags[table->capacity], 0, added * sizeof(uint32_t));
+    memset(&table->seen[table->capacity], 0, added * sizeof(uint32_t));
+
+    table->capacity = capacity;
+    return 0;
+}
+
+// Reconstruir el índice nombre -> ifindex
+static void rebuild_hash(LinkStatsTable* table) {
+    int size = 64;
+    while (size < table->count * 2) {
+        size *= 2;
+    }
+
+    if (size != table->hash_size) {
+        int* hash = realloc(table->hash, size * sizeof(int));
+        if (!hash) return;
+        table->hash = hash;
+        table->hash_size = size;
+    }
+    memset(table->hash, 0, table->hash_size * sizeof(int));
+
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->seen[i] != table->generation || table->seen[i] == 0) {
+            continue;
+        }
+        uint32_t slot = hash_name(table->names[i]) & (table->hash_size - 1);
+        while (table->hash[slot] != 0) {
+            slot = (slot + 1) & (table->hash_size - 1);
+        }
+        table->hash[slot] = i + 1;
+    }
+
+    table->hash_dirty = 0;
+}
+
+int link_stats_init(LinkStatsTable* table) {
+    memset(table, 0, sizeof(LinkStatsTable));
+    table->rx_buffer = malloc(NETLINK_RX_BUFFER);
+    if (!table->rx_buffer) {
+        return -1;
+    }
+    return ensure_capacity(table, 0);
+}
+
+void link_stats_free(LinkStatsTable* table) {
+    free(table->stats);
+    free(table->names);
+    free(table->operstate);
+    free(table->flags);
+    free(table->seen);
+    free(table->hash);
+    free(table->rx_buffer);
+    memset(table, 0, sizeof(LinkStatsTable));
+}
+
+// Preparar un nuevo volcado
+void link_stats_begin(LinkStatsTable* table) {
+    table->pending = table->generation + 1;
+    if (table->pending == 0) {
+        table->pending = 1;
+    }
+    table->timestamp_ns = monotonic_ns();
+}
+
+// Procesar un mensaje RTM_NEWLINK
+static void parse_link(LinkStatsTable* table, struct nlmsghdr* nlh) {
+    struct ifinfomsg* ifm = NLMSG_DATA(nlh);
+    int ifindex = ifm->ifi_index;
+
+    if (ifindex <= 0 || ensure_capacity(table, ifindex) < 0) {
+        return;
+    }
+
+    NetworkStats* stats = &table->stats[ifindex];
+    int attr_len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifm));
+    int have_stats64 = 0;
+
+    table->flags[ifindex] = ifm->ifi_flags;
+
+    for (struct rtattr* rta = IFLA_RTA(ifm); RTA_OK(rta, attr_len); rta = RTA_NEXT(rta, attr_len)) {
+        switch (rta->rta_type) {
+            case IFLA_IFNAME: {
+                const char* name = RTA_DATA(rta);
+                if (strncmp(table->names[ifindex], name, MAX_INTERFACE_NAME) != 0) {
+                    strncpy(table->names[ifindex], name, MAX_INTERFACE_NAME - 1);
+                    table->names[ifindex][MAX_INTERFACE_NAME - 1] = '\0';
+                    table->hash_dirty = 1;
+                }
+                break;
+            }
+            case IFLA_OPERSTATE:
+                table->operstate[ifindex] = *(const uint8_t*)RTA_DATA(rta);
+                break;
+            case IFLA_STATS64: {
+                struct rtnl_link_stats64 link_stats;
+                memcpy(&link_stats, RTA_DATA(rta), sizeof(link_stats));
+                stats->rx_bytes = link_stats.rx_bytes;
+                stats->tx_bytes = link_stats.tx_bytes;
+                stats->rx_packets = link_stats.rx_packets;
+                stats->tx_packets = link_stats.tx_packets;
+                have_stats64 = 1;
+                break;
+            }
+            case IFLA_STATS: {
+                // Contadores de 32 bits solo si el kernel no envía IFLA_STATS64
+                if (!have_stats64) {
+                    struct rtnl_link_stats link_stats;
+                    memcpy(&link_stats, RTA_DATA(rta), sizeof(link_stats));
+                    stats->rx_bytes = link_stats.rx_bytes;
+                    stats->tx_bytes = link_stats.tx_bytes;
+                    stats->rx_packets = link_stats.rx_packets;
+                    stats->tx_packets = link_stats.tx_packets;
+                }
+                break;
+            }
+        }
+    }
+
+    stats->rx_speed = 0.0;
+    stats->tx_speed = 0.0;
+    stats->total_speed = 0.0;
+    stats->timestamp_ns = table->timestamp_ns;
+
+    if (table->seen[ifindex] != table->generation || table->generation == 0) {
+        table->hash_dirty = 1;  // interfaz nueva respecto al volcado anterior
+    }
+    table->seen[ifindex] = table->pending;
+}
+
+// Procesar un mensaje RTM_DELLINK
+static void remove_link(LinkStatsTable* table, struct nlmsghdr* nlh) {
+    struct ifinfomsg* ifm = NLMSG_DATA(nlh);
+    int ifindex = ifm->ifi_index;
+
+    if (ifindex > 0 && ifindex < table->capacity && table->seen[ifindex] != 0) {
+        table->seen[ifindex] = 0;
+        table->hash_dirty = 1;
+    }
+}
+
+// Procesar un bloque recibido. Devuelve 1 al terminar el volcado, 0 si faltan datos, -1 en error
+int link_stats_parse(LinkStatsTable* table, const void* buffer, size_t length) {
+    int remaining = (int)length;
+
+    for (struct nlmsghdr* nlh = (struct nlmsghdr*)buffer; NLMSG_OK(nlh, remaining); nlh = NLMSG_NEXT(nlh, remaining)) {
+        if (foreign_message(nlh, table->seq)) {
+            continue;
+        }
+        if (nlh->nlmsg_type == NLMSG_DONE) {
+            return 1;
+        }
+        if (nlh->nlmsg_type == NLMSG_ERROR) {
+            return -1;
+        }
+        if (nlh->nlmsg_type == RTM_NEWLINK) {
+            parse_link(table, nlh);
+        } else if (nlh->nlmsg_type == RTM_DELLINK) {
+            remove_link(table, nlh);
+        }
+    }
+
+    return 0;
+}
+
+// Cerrar un volcado y publicar la nueva generación
+void link_stats_end(LinkStatsTable* table) {
+    int count = 0;
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->seen[i] == table->pending) {
+            count++;
+        }
+    }
+
+    if (count != table->count) {
+        table->hash_dirty = 1;  // alguna interfaz desapareció
+    }
+
+    table->count = count;
+    table->generation = table->pending;
+
+    if (table->hash_dirty) {
+        rebuild_hash(table);
+    }
+}
+
+// Volcar todas las interfaces con una única petición RTM_GETLINK
+int link_stats_dump(LinkStatsTable* table, int fd) {
+    struct {
+        struct nlmsghdr nlh;
+        struct ifinfomsg ifm;
+    } request;
+
+    memset(&request, 0, sizeof(request));
+    request.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    request.nlh.nlmsg_type = RTM_GETLINK;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.nlh.nlmsg_seq = ++table->seq;
+    request.ifm.ifi_family = AF_UNSPEC;
+
+    if (send(fd, &request, request.nlh.nlmsg_len, 0) < 0) {
+        return -1;
+    }
+
+    link_stats_begin(table);
+
+    while (1) {
+        ssize_t received = recv(fd, table->rx_buffer, NETLINK_RX_BUFFER, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // Los contadores de cada lote se leen en el kernel justo antes de entregarlo
+        table->timestamp_ns = monotonic_ns();
+        int result = received > 0 ? link_stats_parse(table, table->rx_buffer, received) : -1;
+        if (result < 0) {
+            // Volcado abortado: lo ya recibido se queda como si fueran notificaciones
+            // en la generación vigente, y lo que quede de él en el socket se descarta
+            // por su seq en el siguiente volcado
+            for (int i = 0; i < table->capacity; i++) {
+                if (table->seen[i] == table->pending) {
+                    table->seen[i] = table->generation;
+                }
+            }
+            table->pending = table->generation;
+            if (table->generation != 0) {
+                link_stats_end(table);
+            }
+            return -1;
+        }
+        if (result > 0) {
+            break;
+        }
+    }
+
+    link_stats_end(table);
+    return table->count;
+}
+
+// Fuera de un volcado pending == generation, así que parse_link deja las altas en la
+// generación vigente y link_stats_end solo recuenta y reconstruye el hash si hace falta
+int link_stats_update(LinkStatsTable* table, int fd) {
+    uint64_t before = table->notifications;
+
+    while (1) {
+        ssize_t received = recv(fd, table->rx_buffer, NETLINK_RX_BUFFER, MSG_DONTWAIT);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == ENOBUFS) {
+                // Se perdieron notificaciones: el volcado deja la tabla exacta
+                return link_stats_dump(table, fd) < 0 ? -1 : (int)(table->notifications - before);
+            }
+            return -1;
+        }
+
+        table->timestamp_ns = monotonic_ns();
+        int remaining = (int)received;
+        for (struct nlmsghdr* nlh = (struct nlmsghdr*)table->rx_buffer; NLMSG_OK(nlh, remaining);
+             nlh = NLMSG_NEXT(nlh, remaining)) {
+            if (nlh->nlmsg_type == RTM_NEWLINK || nlh->nlmsg_type == RTM_DELLINK) {
+                table->notifications++;
+            }
+        }
+        link_stats_parse(table, table->rx_buffer, received);
+    }
+
+    if (table->notifications != before) {
+        link_stats_end(table);
+    }
+    return (int)(table->notifications - before);
+}
+
+// Buscar el ifindex de una interfaz por nombre (-1 si no existe)
+int link_stats_find(const LinkStatsTable* table, const char* name) {
+    if (!name || table->hash_size == 0) {
+        return -1;
+    }
+
+    uint32_t slot = hash_name(name) & (table->hash_size - 1);
+    while (table->hash[slot] != 0) {
+        int ifindex = table->hash[slot] - 1;
+        if (table->seen[ifindex] == table->generation &&
+            strncmp(table->names[ifindex], name, MAX_INTERFACE_NAME) == 0) {
+            return ifindex;
+        }
+        slot = (slot + 1) & (table->hash_size - 1);
+    }
+
+    return -1;
+}
+
+// Obtener las estadísticas de un ifindex del último volcado
+const NetworkStats* link_stats_get(const LinkStatsTable* table, int ifindex) {
+    if (ifindex <= 0 || ifindex >= table->capacity || table->seen[ifindex] != table->generation) {
+        return NULL;
+    }
+    return &table->stats[ifindex];
+}
+
+int link_stats_next(const LinkStatsTable* table, int ifindex) {
+    for (int i = ifindex < 0 ? 1 : ifindex + 1; i < table->capacity; i++) {
+        if (table->seen[i] != 0 && table->seen[i] == table->generation) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* link_stats_name(const LinkStatsTable* table, int ifindex) {
+    if (ifindex <= 0 || ifindex >= table->capacity || table->seen[ifindex] != table->generation) {
+        return NULL;
+    }
+    return table->names[ifindex];
+}
+
+int link_stats_is_up(const LinkStatsTable* table, int ifindex) {
+    if (ifindex <= 0 || ifindex >= table->capacity || table->seen[ifindex] != table->generation) {
+        return 0;
+    }
+    return table->operstate[ifindex] == IF_OPER_UP;
+}
+
+// ============================================================================
+// CACHÉ DE DIRECCIONES
+// ============================================================================
+
+static int same_address(const InterfaceAddress* a, const InterfaceAddress* b) {
+    int size = a->family == AF_INET ? 4 : 16;
+    return a->ifindex == b->ifindex && a->family == b->family &&
+           a->prefix_len == b->prefix_len && memcmp(a->addr, b->addr, size) == 0;
+}
+
+// Procesar un mensaje RTM_NEWADDR o RTM_DELADDR
+static void parse_address(AddressCache* cache, struct nlmsghdr* nlh) {
+    struct ifaddrmsg* ifa = NLMSG_DATA(nlh);
+    InterfaceAddress address;
+    int attr_len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifa));
+    int have_local = 0;
+    int have_address = 0;
+
+    if (ifa->ifa_family != AF_INET && ifa->ifa_family != AF_INET6) {
+        return;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.ifindex = ifa->ifa_index;
+    address.family = ifa->ifa_family;
+    address.prefix_len = ifa->ifa_prefixlen;
+    address.scope = ifa->ifa_scope;
+    int size = address.family == AF_INET ? 4 : 16;
+
+    // En enlaces punto a punto IFA_ADDRESS es el extremo remoto: preferir IFA_LOCAL
+    for (struct rtattr* rta = IFA_RTA(ifa); RTA_OK(rta, attr_len); rta = RTA_NEXT(rta, attr_len)) {
+        if ((int)RTA_PAYLOAD(rta) < size) {
+            continue;
+        }
+        if (rta->rta_type == IFA_LOCAL) {
+            memcpy(address.addr, RTA_DATA(rta), size);
+            have_local = 1;
+        } else if (rta->rta_type == IFA_ADDRESS && !have_local) {
+            memcpy(address.addr, RTA_DATA(rta), size);
+            have_address = 1;
+        }
+    }
+    if (!have_local && !have_address) {
+        return;
+    }
+
+    for (int i = 0; i < cache->count; i++) {
+        if (same_address(&cache->addresses[i], &address)) {
+            if (nlh->nlmsg_type == RTM_DELADDR) {
+                // Conservar el orden: la primera dirección de cada interfaz es la primaria
+                memmove(&cache->addresses[i], &cache->addresses[i + 1],
+                        (cache->count - i - 1) * sizeof(InterfaceAddress));
+                cache->count--;
+            } else {
+                cache->addresses[i] = address;
+            }
+            cache->changes++;
+            return;
+        }
+    }
+
+    if (nlh->nlmsg_type == RTM_DELADDR) {
+        return;
+    }
+
+    if (cache->count == cache->capacity) {
+        int capacity = cache->capacity > 0 ? cache->capacity * 2 : 16;
+        InterfaceAddress* addresses = realloc(cache->addresses, capacity * sizeof(InterfaceAddress));
+        if (!addresses) return;
+        cache->addresses = addresses;
+        cache->capacity = capacity;
+    }
+    cache->addresses[cache->count++] = address;
+    cache->changes++;
+}
+
+int address_cache_parse(AddressCache* cache, const void* buffer, size_t length) {
+    int remaining = (int)length;
+
+    for (struct nlmsghdr* nlh = (struct nlmsghdr*)buffer; NLMSG_OK(nlh, remaining); nlh = NLMSG_NEXT(nlh, remaining)) {
+        if (foreign_message(nlh, cache->seq)) {
+            continue;
+        }
+        if (nlh->nlmsg_type == NLMSG_DONE) {
+            return 1;
+        }
+        if (nlh->nlmsg_type == NLMSG_ERROR) {
+            return -1;
+        }
+        if (nlh->nlmsg_type == RTM_NEWADDR || nlh->nlmsg_type == RTM_DELADDR) {
+            parse_address(cache, nlh);
+        }
+    }
+
+    return 0;
+}
+
+// Volcado RTM_GETADDR completo de IPv4 e IPv6. Las notificaciones que lleguen
+// intercaladas se aplican igual: el resultado final es coherente
+static int address_cache_dump(AddressCache* cache) {
+    struct {
+        struct nlmsghdr nlh;
+        struct ifaddrmsg ifa;
+    } request;
+
+    memset(&request, 0, sizeof(request));
+    request.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+    request.nlh.nlmsg_type = RTM_GETADDR;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.nlh.nlmsg_seq = ++cache->seq;
+    request.ifa.ifa_family = AF_UNSPEC;
+
+    if (send(cache->fd, &request, request.nlh.nlmsg_len, 0) < 0) {
+        return -1;
+    }
+
+    cache->count = 0;
+    while (1) {
+        ssize_t received = recv(cache->fd, cache->rx_buffer, NETLINK_RX_BUFFER, 0);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (received == 0) {
+            return -1;
+        }
+
+        int result = address_cache_parse(cache, cache->rx_buffer, received);
+        if (result < 0) {
+            return -1;
+        }
+        if (result > 0) {
+            break;
+        }
+    }
+
+    cache->synced = 1;
+    cache->dumps++;
+    return cache->count;
+}
+
+int address_cache_init(AddressCache* cache) {
+    memset(cache, 0, sizeof(AddressCache));
+    cache->rx_buffer = malloc(NETLINK_RX_BUFFER);
+    cache->fd = nl_open(RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR);
+    if (!cache->rx_buffer || cache->fd < 0 || address_cache_dump(cache) < 0) {
+        address_cache_free(cache);
+        return -1;
+    }
+    return 0;
+}
+
+void address_cache_free(AddressCache* cache) {
+    nl_close(cache->fd);
+    free(cache->addresses);
+    free(cache->rx_buffer);
+    memset(cache, 0, sizeof(AddressCache));
+    cache->fd = -1;
+}
+
+int address_cache_update(AddressCache* cache) {
+    uint64_t before = cache->changes;
+
+    while (cache->synced) {
+        ssize_t received = recv(cache->fd, cache->rx_buffer, NETLINK_RX_BUFFER, MSG_DONTWAIT);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return (int)(cache->changes - before);
+            }
+            if (errno != ENOBUFS) {
+                return -1;
+            }
+            cache->synced = 0;   // se perdieron notificaciones: volver a volcar
+            break;
+        }
+        address_cache_parse(cache, cache->rx_buffer, received);
+    }
+
+    if (address_cache_dump(cache) < 0) {
+        return -1;
+    }
+    return (int)(cache->changes - before);
+}
+
+const InterfaceAddress* address_cache_find(const AddressCache* cache, int ifindex, int family) {
+    const InterfaceAddress* fallback = NULL;
+
+    for (int i = 0; i < cache->count; i++) {
+        const InterfaceAddress* address = &cache->addresses[i];
+        if (address->ifindex != ifindex || address->family != family) {
+            continue;
+        }
+        if (address->scope == RT_SCOPE_UNIVERSE) {
+            return address;
+        }
+        if (!fallback) {
+            fallback = address;
+        }
+    }
+
+    return fallback;
+}
@@ -0,0 +1,188 @@
+#define _GNU_SOURCE
+#include "openmetrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#define METRICS_INITIAL_CAPACITY 16384
+
+void metrics_buffer_init(MetricsBuffer* buffer, size_t offset) {
+    memset(buffer, 0, sizeof(MetricsBuffer));
+    buffer->offset = offset;
+    buffer->length = offset;
+}
+
+void metrics_buffer_free(MetricsBuffer* buffer) {
+    free(buffer->data);
+    metrics_buffer_init(buffer, buffer->offset);
+}
+
+void metrics_buffer_reset(MetricsBuffer* buffer) {
+    buffer->length = buffer->offset;
+    buffer->failed = 0;
+}
+
+static int reserve(MetricsBuffer* buffer, size_t needed) {
+    if (buffer->length + needed <= buffer->capacity) {
+        return 0;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : METRICS_INITIAL_CAPACITY;
+    while (capacity < buffer->length + needed) {
+        capacity *= 2;
+    }
+    char* data = realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->failed = 1;
+        return -1;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+void metrics_buffer_printf(MetricsBuffer* buffer, const char* format, ...) {
+    va_list args;
+
+    if (buffer->failed || reserve(buffer, 256) < 0) {
+        return;
+    }
+
+    // Casi siempre cabe a la primera; si no, crecer y repetir
+    va_start(args, format);
+    int written = vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+    va_end(args);
+    if (written < 0) {
+        buffer->failed = 1;
+        return;
+    }
+    if ((size_t)written >= buffer->capacity - buffer->length) {
+        if (reserve(buffer, (size_t)written + 1) < 0) {
+            return;
+        }
+        va_start(args, format);
+        vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+        va_end(args);
+    }
+    buffer->length += (size_t)written;
+}
+
+// Valor de etiqueta con los escapes de OpenMetrics (\\, \" y \n)
+static void label_value(MetricsBuffer* buffer, const char* value) {
+    size_t length = strlen(value);
+    if (buffer->failed || reserve(buffer, length * 2 + 1) < 0) {
+        return;
+    }
+    for (const char* c = value; *c; c++) {
+        if (*c == '\\' || *c == '"' || *c == '\n') {
+            buffer->data[buffer->length++] = '\\';
+            buffer->data[buffer->length++] = *c == '\n' ? 'n' : *c;
+        } else {
+            buffer->data[buffer->length++] = *c;
+        }
+    }
+}
+
+static void family(MetricsBuffer* buffer, const char* name, const char* type, const char* unit, const char* help) {
+    metrics_buffer_printf(buffer, "# TYPE %s %s\n", name, type);
+    if (unit) {
+        metrics_buffer_printf(buffer, "# UNIT %s %s\n", name, unit);
+    }
+    metrics_buffer_printf(buffer, "# HELP %s %s\n", name, help);
+}
+
+// Una muestra con una sola etiqueta: nombre{etiqueta="valor"} número
+static void sample(MetricsBuffer* buffer, const char* name, const char* label, const char* value, const char* number) {
+    metrics_buffer_printf(buffer, "%s{%s=\"", name, label);
+    label_value(buffer, value);
+    metrics_buffer_printf(buffer, "\"} %s\n", number);
+}
+
+static void interface_counter(MetricsBuffer* buffer, const Snapshot* snapshot, const char* name,
+                              const char* help, size_t field) {
+    char number[32];
+
+    family(buffer, name, "counter", strstr(name, "bytes") ? "bytes" : NULL, help);
+    for (int i = 0; i < snapshot->interface_count; i++) {
+        const uint64_t* value = (const uint64_t*)((const char*)&snapshot->interface_stats[i] + field);
+        char total[96];
+        snprintf(number, sizeof(number), "%lu", (unsigned long)*value);
+        snprintf(total, sizeof(total), "%s_total", name);
+        sample(buffer, total, "interface", snapshot->interfaces[i], number);
+    }
+}
+
+int metrics_render(const Snapshot* snapshot, MetricsBuffer* buffer) {
+    static const char* sections[SAMPLE_SECTIONS] = {
+        "interfaces", "links", "address", "sockets", "processes", "latency"
+    };
+    char number[32];
+
+    metrics_buffer_reset(buffer);
+
+    // Interfaces
+    family(buffer, "nx_interface_up", "gauge", NULL, "Interfaz activa (1) o inactiva (0).");
+    for (int i = 0; i < snapshot->interface_count; i++) {
+        sample(buffer, "nx_interface_up", "interface", snapshot->interfaces[i],
+               snapshot->interface_active[i] ? "1" : "0");
+    }
+    interface_counter(buffer, snapshot, "nx_interface_receive_bytes", "Bytes recibidos.",
+                      offsetof(NetworkStats, rx_bytes));
+    interface_counter(buffer, snapshot, "nx_interface_transmit_bytes", "Bytes enviados.",
+                      offsetof(NetworkStats, tx_bytes));
+    interface_counter(buffer, snapshot, "nx_interface_receive_packets", "Paquetes recibidos.",
+                      offsetof(NetworkStats, rx_packets));
+    interface_counter(buffer, snapshot, "nx_interface_transmit_packets", "Paquetes enviados.",
+                      offsetof(NetworkStats, tx_packets));
+
+    // Conexiones: NEW_SYN_RECV (12) se muestra como SYN_RECV (3), igual que en la TUI
+    family(buffer, "nx_tcp_connections", "gauge", NULL, "Conexiones TCP por estado.");
+    for (int state = 1; state < SAMPLER_TCP_STATES - 1; state++) {
+        int count = snapshot->tcp_states[state];
+        if (state == 3) count += snapshot->tcp_states[12];
+        snprintf(number, sizeof(number), "%d", count);
+        sample(buffer, "nx_tcp_connections", "state", connection_state_name(state), number);
+    }
+    family(buffer, "nx_udp_sockets", "gauge", NULL, "Sockets UDP abiertos.");
+    metrics_buffer_printf(buffer, "nx_udp_sockets %d\n", snapshot->udp_sockets);
+    family(buffer, "nx_processes", "gauge", NULL, "Procesos en /proc.");
+    metrics_buffer_printf(buffer, "nx_processes %d\n", snapshot->processes);
+    family(buffer, "nx_history_errors", "counter", NULL, "Muestras que no se pudieron guardar en el historial.");
+    metrics_buffer_printf(buffer, "nx_history_errors_total %lu\n", (unsigned long)snapshot->history_errors);
+
+    // Latencia: distribución de las últimas ventanas (puede bajar, no es un contador)
+    family(buffer, "nx_latency_up", "gauge", NULL, "El último sondeo del destino respondió (1) o no (0).");
+    for (int i = 0; i < snapshot->latency_count; i++) {
+        sample(buffer, "nx_latency_up", "target", snapshot->latency[i].server,
+               snapshot->latency[i].status == PROBE_OK ? "1" : "0");
+    }
+    family(buffer, "nx_latency_seconds", "gaugehistogram", "seconds",
+           "Latencia de los sondeos de los últimos minutos.");
+    for (int i = 0; i < snapshot->latency_count; i++) {
+        const char* target = snapshot->latency[i].server;
+        for (int j = 0; j < SAMPLER_LATENCY_BOUNDS; j++) {
+            metrics_buffer_printf(buffer, "nx_latency_seconds_bucket{target=\"");
+            label_value(buffer, target);
+            metrics_buffer_printf(buffer, "\",le=\"%g\"} %lu\n", sampler_latency_bounds_ms[j] / 1000.0,
+                                  (unsigned long)snapshot->latency_buckets[i][j]);
+        }
+        snprintf(number, sizeof(number), "%lu", (unsigned long)snapshot->latency[i].samples);
+        metrics_buffer_printf(buffer, "nx_latency_seconds_bucket{target=\"");
+        label_value(buffer, target);
+        metrics_buffer_printf(buffer, "\",le=\"+Inf\"} %s\n", number);
+        sample(buffer, "nx_latency_seconds_gcount", "target", target, number);
+        snprintf(number, sizeof(number), "%.6f", snapshot->latency_sum_ms[i] / 1000.0);
+        sample(buffer, "nx_latency_seconds_gsum", "target", target, number);
+    }
+
+    // Frescura de cada sección (cada recolector tiene su periodo)
+    family(buffer, "nx_sample_age_seconds", "gauge", "seconds", "Antigüedad de la última lectura de cada sección.");
+    for (int i = 0; i < SAMPLE_SECTIONS; i++) {
+        if (snapshot->collected_ns[i] == 0) continue;
+        snprintf(number, sizeof(number), "%.3f", elapsed_seconds(snapshot->collected_ns[i], monotonic_ns()));
+        sample(buffer, "nx_sample_age_seconds", "section", sections[i], number);
+    }
+
+    metrics_buffer_printf(buffer, "# EOF\n");
+    return buffer->failed ? -1 : 0;
+}
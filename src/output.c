@@ -0,0 +1,442 @@
+#define _GNU_SOURCE
+#include "output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/signalfd.h>
+
+// Espacio que se exige libre antes de escribir un campo (nombre y cadena escapada)
+#define FIELD_RESERVE (64 + OUTPUT_STRING_MAX * 6)
+
+void output_default_config(OutputConfig* config) {
+    memset(config, 0, sizeof(OutputConfig));
+    config->format = OUTPUT_TEXT;
+}
+
+int output_parse_option(OutputConfig* config, int argc, char** argv, int* i) {
+    static const char* names[] = { "text", "json", "csv", "binary" };
+
+    if (strcmp(argv[*i], "--format") == 0) {
+        if (*i + 1 >= argc) return -1;
+        const char* value = argv[++*i];
+        for (int format = OUTPUT_TEXT; format <= OUTPUT_BINARY; format++) {
+            if (strcmp(value, names[format]) == 0) {
+                config->format = format;
+                return 1;
+            }
+        }
+        return -1;
+    }
+    if (strcmp(argv[*i], "--interval") == 0) {
+        if (*i + 1 >= argc) return -1;
+        config->interval_ms = atoi(argv[++*i]);
+        return config->interval_ms >= 1 ? 1 : -1;
+    }
+    return 0;
+}
+
+void output_init(Output* output, int fd, OutputFormat format) {
+    output->fd = fd;
+    output->format = format;
+    output->time_ms = 0;
+    output->length = 0;
+    output->record = 0;
+    output->type = -1;
+    output->fields = 0;
+    output->type_count = 0;
+    output->schema_length = 0;
+    output->records = 0;
+    output->writes = 0;
+    output->bytes = 0;
+    output->failed = 0;
+    if (format == OUTPUT_BINARY) {
+        memcpy(output->data, OUTPUT_BINARY_MAGIC, 4);
+        output->length = 4;
+    }
+}
+
+int output_flush(Output* output) {
+    size_t written = 0;
+
+    while (!output->failed && written < output->length) {
+        ssize_t result = write(output->fd, output->data + written, output->length - written);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            output->failed = 1;   // EPIPE: quien leía ya no está
+            break;
+        }
+        written += (size_t)result;
+        output->writes++;
+        output->bytes += (uint64_t)result;
+    }
+    output->length = 0;
+    return output->failed ? -1 : 0;
+}
+
+// ============================================================================
+// ESCRITURA EN EL BÚFER
+// ============================================================================
+
+static void put(char* buffer, size_t* length, const void* data, size_t size) {
+    memcpy(buffer + *length, data, size);
+    *length += size;
+}
+
+static void put_byte(char* buffer, size_t* length, uint8_t value) {
+    buffer[(*length)++] = (char)value;
+}
+
+// Entero en little-endian sea cual sea la arquitectura
+static void put_le(char* buffer, size_t* length, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        buffer[(*length)++] = (char)(value >> (8 * i));
+    }
+}
+
+// Decimal sin printf: es lo más repetido en una fila
+static void put_u64(char* buffer, size_t* length, uint64_t value) {
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count > 0) {
+        buffer[(*length)++] = digits[--count];
+    }
+}
+
+static void put_json_string(char* buffer, size_t* length, const char* value, size_t size) {
+    static const char hex[] = "0123456789abcdef";
+
+    buffer[(*length)++] = '"';
+    for (size_t i = 0; i < size; i++) {
+        unsigned char c = (unsigned char)value[i];
+        if (c == '"' || c == '\\') {
+            buffer[(*length)++] = '\\';
+            buffer[(*length)++] = (char)c;
+        } else if (c < 0x20) {
+            put(buffer, length, "\\u00", 4);
+            buffer[(*length)++] = hex[c >> 4];
+            buffer[(*length)++] = hex[c & 15];
+        } else {
+            buffer[(*length)++] = (char)c;
+        }
+    }
+    buffer[(*length)++] = '"';
+}
+
+// Entre comillas solo si hace falta (RFC 4180)
+static void put_csv_string(char* buffer, size_t* length, const char* value, size_t size) {
+    if (strcspn(value, ",\"\r\n") >= size) {
+        put(buffer, length, value, size);
+        return;
+    }
+    buffer[(*length)++] = '"';
+    for (size_t i = 0; i < size; i++) {
+        if (value[i] == '"') {
+            buffer[(*length)++] = '"';
+        }
+        buffer[(*length)++] = value[i];
+    }
+    buffer[(*length)++] = '"';
+}
+
+// ============================================================================
+// REGISTROS
+// ============================================================================
+
+static int find_type(Output* output, const char* type) {
+    for (int i = 0; i < output->type_count; i++) {
+        if (strcmp(output->types[i].name, type) == 0) {
+            return i;
+        }
+    }
+    if (output->type_count == OUTPUT_MAX_TYPES) {
+        return -1;
+    }
+    OutputType* entry = &output->types[output->type_count];
+    snprintf(entry->name, sizeof(entry->name), "%s", type);
+    entry->described = 0;
+    return output->type_count++;
+}
+
+// Nombre del campo en el registro y, la primera vez, en la cabecera o el esquema
+static int field(Output* output, const char* name, int kind) {
+    if (output->type < 0 || output->length + FIELD_RESERVE > sizeof(output->data) ||
+        output->schema_length + 64 > sizeof(output->schema)) {
+        return -1;   // registro descartado o fuera de márgenes: se omite el campo
+    }
+
+    int describe = !output->types[output->type].described;
+    size_t name_length = strnlen(name, 32);
+    switch (output->format) {
+    case OUTPUT_JSON:
+        put_byte(output->data, &output->length, ',');
+        put_json_string(output->data, &output->length, name, name_length);
+        put_byte(output->data, &output->length, ':');
+        break;
+    case OUTPUT_CSV:
+        put_byte(output->data, &output->length, ',');
+        if (describe) {
+            put_byte(output->schema, &output->schema_length, ',');
+            put_csv_string(output->schema, &output->schema_length, name, name_length);
+        }
+        break;
+    case OUTPUT_BINARY:
+        if (describe) {
+            put_byte(output->schema, &output->schema_length, (uint8_t)kind);
+            put_byte(output->schema, &output->schema_length, (uint8_t)name_length);
+            put(output->schema, &output->schema_length, name, name_length);
+        }
+        break;
+    default:
+        return -1;
+    }
+    output->fields++;
+    return 0;
+}
+
+void output_begin(Output* output, const char* type) {
+    if (output->length >= OUTPUT_BUFFER_SIZE) {
+        output_flush(output);
+    }
+
+    output->type = find_type(output, type);
+    output->record = output->length;
+    output->fields = 0;
+    output->schema_length = 0;
+    if (output->type < 0) {
+        return;
+    }
+
+    size_t type_length = strnlen(type, sizeof(output->types[0].name) - 1);
+    switch (output->format) {
+    case OUTPUT_JSON:
+        put(output->data, &output->length, "{\"type\":", 8);
+        put_json_string(output->data, &output->length, type, type_length);
+        break;
+    case OUTPUT_CSV:
+        put_csv_string(output->data, &output->length, type, type_length);
+        put(output->schema, &output->schema_length, "type", 4);
+        break;
+    case OUTPUT_BINARY:
+        // Cabeceras de trama: se completan en output_end, cuando se conoce la longitud
+        output->length += 4;
+        output->schema_length = 4;
+        put_byte(output->schema, &output->schema_length, (uint8_t)type_length);
+        put(output->schema, &output->schema_length, type, type_length);
+        output->schema_length++;   // número de campos
+        break;
+    default:
+        output->type = -1;
+        return;
+    }
+    output_u64(output, "time_ms", output->time_ms);
+}
+
+void output_string(Output* output, const char* name, const char* value) {
+    if (field(output, name, OUTPUT_FIELD_STRING) < 0) {
+        return;
+    }
+    size_t length = strnlen(value, OUTPUT_STRING_MAX);
+    switch (output->format) {
+    case OUTPUT_JSON:
+        put_json_string(output->data, &output->length, value, length);
+        break;
+    case OUTPUT_CSV:
+        put_csv_string(output->data, &output->length, value, length);
+        break;
+    default:
+        put_le(output->data, &output->length, length, 2);
+        put(output->data, &output->length, value, length);
+        break;
+    }
+}
+
+void output_u64(Output* output, const char* name, uint64_t value) {
+    if (field(output, name, OUTPUT_FIELD_U64) < 0) {
+        return;
+    }
+    if (output->format == OUTPUT_BINARY) {
+        put_le(output->data, &output->length, value, 8);
+    } else {
+        put_u64(output->data, &output->length, value);
+    }
+}
+
+void output_double(Output* output, const char* name, double value) {
+    if (field(output, name, OUTPUT_FIELD_F64) < 0) {
+        return;
+    }
+    if (output->format == OUTPUT_BINARY) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        put_le(output->data, &output->length, bits, 8);
+    } else if (!isfinite(value)) {
+        // JSON no admite NaN ni infinitos; en CSV queda vacío
+        if (output->format == OUTPUT_JSON) put(output->data, &output->length, "null", 4);
+    } else {
+        // Con |valor| enorme "%.3f" no cabe en los 64 bytes reservados: "%.17g" ocupa
+        // como mucho 24 y conserva el valor exacto, sin dejar el campo vacío
+        int written = snprintf(output->data + output->length, 64, "%.3f", value);
+        if (written < 0 || written >= 64) {
+            written = snprintf(output->data + output->length, 64, "%.17g", value);
+        }
+        output->length += written > 0 && written < 64 ? (size_t)written : 0;
+    }
+}
+
+void output_end(Output* output) {
+    if (output->type < 0) {
+        output->length = output->record;
+        return;
+    }
+
+    OutputType* type = &output->types[output->type];
+    switch (output->format) {
+    case OUTPUT_JSON:
+        put(output->data, &output->length, "}\n", 2);
+        break;
+    case OUTPUT_CSV:
+        put_byte(output->data, &output->length, '\n');
+        put_byte(output->schema, &output->schema_length, '\n');
+        break;
+    default: {
+        size_t position = output->record;
+        put_byte(output->data, &position, 'R');
+        put_byte(output->data, &position, (uint8_t)output->type);
+        put_le(output->data, &position, output->length - output->record - 4, 2);
+
+        position = 0;
+        put_byte(output->schema, &position, 'S');
+        put_byte(output->schema, &position, (uint8_t)output->type);
+        put_le(output->schema, &position, output->schema_length - 4, 2);
+        output->schema[5 + (uint8_t)output->schema[4]] = (char)output->fields;
+        break;
+    }
+    }
+
+    // Primera fila del tipo: su cabecera o esquema va delante
+    if (!type->described) {
+        if (output->length + output->schema_length > sizeof(output->data)) {
+            output->length = output->record;   // no cabe: se descarta la fila
+            return;
+        }
+        memmove(output->data + output->record + output->schema_length, output->data + output->record,
+                output->length - output->record);
+        memcpy(output->data + output->record, output->schema, output->schema_length);
+        output->length += output->schema_length;
+        type->described = 1;
+    }
+    output->records++;
+}
+
+void output_connection(Output* output, const Connection* connection) {
+    char address[MAX_IP_ADDRESS];
+    int udp = connection->protocol == IPPROTO_UDP;
+
+    output_begin(output, "connection");
+    output_string(output, "proto", connection_protocol_name(connection));
+    output_string(output, "local_addr",
+                  format_ip_address(connection->family, connection->local_addr, address, sizeof(address)));
+    output_u64(output, "local_port", connection->local_port);
+    output_string(output, "remote_addr",
+                  format_ip_address(connection->family, connection->remote_addr, address, sizeof(address)));
+    output_u64(output, "remote_port", connection->remote_port);
+    output_string(output, "state", udp ? "" : connection_state_name(connection->state));
+    output_u64(output, "uid", connection->uid);
+    output_u64(output, "inode", connection->inode);
+    output_u64(output, "pid", connection->pid > 0 ? (uint64_t)connection->pid : 0);
+    output_string(output, "process", connection->pid > 0 ? connection->process : "");
+    output_end(output);
+}
+
+// ============================================================================
+// REPETICIÓN PERIÓDICA
+// ============================================================================
+
+static uint64_t realtime_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Una pasada de la vista y el volcado de lo que escribió
+static int run_view(Output* output, OutputView view, void* context) {
+    output->time_ms = realtime_ms();
+    int result = view(output, context);
+
+    if (output->format == OUTPUT_TEXT) {
+        if (fflush(stdout) != 0 || ferror(stdout)) {
+            output->failed = 1;
+        }
+    } else {
+        output_flush(output);
+    }
+    return output->failed ? -1 : result;
+}
+
+int output_run(const OutputConfig* config, OutputView view, void* context) {
+    static Output output;
+
+    output_init(&output, STDOUT_FILENO, config->format);
+    signal(SIGPIPE, SIG_IGN);   // una tubería cerrada llega como EPIPE en write
+
+    if (config->interval_ms <= 0) {
+        int result = run_view(&output, view, context);
+        return result < 0 && !output.failed ? -1 : 0;
+    }
+
+    sigset_t signals, previous;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &previous);
+
+    int signal_fd = signalfd(-1, &signals, SFD_CLOEXEC);
+    int ticker = ticker_open(config->interval_ms);
+    if (signal_fd < 0 || ticker < 0) {
+        fprintf(stderr, "No se pudo crear el temporizador: %s\n", strerror(errno));
+        if (signal_fd >= 0) close(signal_fd);
+        ticker_close(ticker);
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+        return -1;
+    }
+
+    struct pollfd fds[2] = {
+        { .fd = ticker, .events = POLLIN },
+        { .fd = signal_fd, .events = POLLIN },
+    };
+    int result;
+    while ((result = run_view(&output, view, context)) == 0) {
+        int ready;
+        while ((ready = poll(fds, 2, -1)) < 0 && errno == EINTR) {
+        }
+        if (ready < 0) {
+            result = -1;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            struct signalfd_siginfo info;
+            if (read(signal_fd, &info, sizeof(info)) < 0) {
+                // ya consumida: solo importa que llegó
+            }
+            break;
+        }
+        ticker_wait(ticker);   // si la vista tardó más que el intervalo, los ticks vencidos se funden
+    }
+
+    ticker_close(ticker);
+    close(signal_fd);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    return result < 0 && !output.failed ? -1 : 0;
+}
@@ -0,0 +1,489 @@
+#define _GNU_SOURCE
+#include "probe.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/icmp6.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+// Etiquetas de los eventos de epoll (el índice del destino va en los 32 bits bajos)
+#define TAG_TIMER 0ULL
+#define TAG_ICMP4 1ULL
+#define TAG_ICMP6 2ULL
+#define TAG_TCP 3ULL
+
+#define PROBE_EVENTS 256
+#define PROBE_PACKET 256
+
+#define NS_PER_MS 1000000ULL
+
+// Carga útil del eco: permite reconocer la respuesta aunque el kernel reescriba el id
+typedef struct {
+    uint32_t index;
+    uint32_t round;
+} ProbePayload;
+
+void probe_default_config(ProbeConfig* config) {
+    config->interval_ms = PROBE_DEFAULT_INTERVAL_MS;
+    config->timeout_ms = PROBE_DEFAULT_TIMEOUT_MS;
+    config->rounds = PROBE_DEFAULT_ROUNDS;
+    config->max_in_flight = PROBE_HTTP_MAX_IN_FLIGHT;
+}
+
+const char* probe_type_name(int type) {
+    return type == PROBE_TCP ? "TCP" : "ICMP";
+}
+
+const char* probe_engine_error(const ProbeEngine* engine) {
+    return engine->error;
+}
+
+// ============================================================================
+// CICLO DE VIDA Y DESTINOS
+// ============================================================================
+
+int probe_engine_init(ProbeEngine* engine, const ProbeConfig* config) {
+    memset(engine, 0, sizeof(ProbeEngine));
+    engine->config = *config;
+    engine->icmp_fd[0] = -1;
+    engine->icmp_fd[1] = -1;
+    engine->echo_id = (uint16_t)getpid();
+
+    engine->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    engine->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (engine->epoll_fd < 0 || engine->timer_fd < 0) {
+        snprintf(engine->error, sizeof(engine->error), "epoll/timerfd: %s", strerror(errno));
+        probe_engine_free(engine);
+        return -1;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data.u64 = TAG_TIMER << 32 };
+    epoll_ctl(engine->epoll_fd, EPOLL_CTL_ADD, engine->timer_fd, &event);
+    return 0;
+}
+
+void probe_engine_free(ProbeEngine* engine) {
+    for (int i = 0; i < engine->count; i++) {
+        if (engine->targets[i].fd >= 0) {
+            close(engine->targets[i].fd);
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (engine->icmp_fd[i] >= 0) {
+            close(engine->icmp_fd[i]);
+        }
+    }
+    if (engine->timer_fd > 0) close(engine->timer_fd);
+    if (engine->epoll_fd > 0) close(engine->epoll_fd);
+    free(engine->targets);
+    engine->targets = NULL;
+    engine->count = 0;
+    engine->capacity = 0;
+    engine->epoll_fd = -1;
+    engine->timer_fd = -1;
+}
+
+// Separar "host", "host:puerto" y "[ipv6]:puerto". Devuelve el puerto o 0 si no hay
+static int split_spec(const char* spec, char* host, size_t size) {
+    const char* port = NULL;
+
+    if (spec[0] == '[') {
+        const char* end = strchr(spec, ']');
+        if (!end) return -1;
+        snprintf(host, size, "%.*s", (int)(end - spec - 1), spec + 1);
+        port = end[1] == ':' ? end + 2 : NULL;
+    } else {
+        const char* colon = strchr(spec, ':');
+        // Más de un ':' sin corchetes es una IPv6 sin puerto
+        if (colon && !strchr(colon + 1, ':')) {
+            snprintf(host, size, "%.*s", (int)(colon - spec), spec);
+            port = colon + 1;
+        } else {
+            snprintf(host, size, "%s", spec);
+        }
+    }
+
+    if (!port) {
+        return 0;
+    }
+    int value = atoi(port);
+    return value > 0 && value < 65536 ? value : -1;
+}
+
+int probe_engine_add(ProbeEngine* engine, const char* spec) {
+    char host[256];
+    int port = split_spec(spec, host, sizeof(host));
+    if (port < 0 || host[0] == '\0') {
+        snprintf(engine->error, sizeof(engine->error), "destino no válido: %s", spec);
+        return -1;
+    }
+    if (engine->count == PROBE_MAX_TARGETS) {
+        snprintf(engine->error, sizeof(engine->error), "demasiados destinos (máximo %d)", PROBE_MAX_TARGETS);
+        return -1;
+    }
+
+    struct addrinfo hints;
+    struct addrinfo* result = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int status = getaddrinfo(host, NULL, &hints, &result);
+    if (status != 0 || !result) {
+        snprintf(engine->error, sizeof(engine->error), "%.200s: %s", host, gai_strerror(status));
+        return -1;
+    }
+
+    if (engine->count == engine->capacity) {
+        int capacity = engine->capacity > 0 ? engine->capacity * 2 : 16;
+        ProbeTarget* targets = realloc(engine->targets, capacity * sizeof(ProbeTarget));
+        if (!targets) {
+            freeaddrinfo(result);
+            snprintf(engine->error, sizeof(engine->error), "sin memoria");
+            return -1;
+        }
+        engine->targets = targets;
+        engine->capacity = capacity;
+    }
+
+    ProbeTarget* target = &engine->targets[engine->count];
+    memset(target, 0, sizeof(ProbeTarget));
+    snprintf(target->name, MAX_SERVER_NAME, "%s", spec);
+    target->type = port > 0 ? PROBE_TCP : PROBE_ICMP;
+    target->fd = -1;
+    memcpy(&target->addr, result->ai_addr, result->ai_addrlen);
+    target->addr_len = result->ai_addrlen;
+    if (port > 0) {
+        if (target->addr.ss_family == AF_INET) {
+            ((struct sockaddr_in*)&target->addr)->sin_port = htons(port);
+        } else {
+            ((struct sockaddr_in6*)&target->addr)->sin6_port = htons(port);
+        }
+    }
+    freeaddrinfo(result);
+
+    return engine->count++;
+}
+
+// ============================================================================
+// RESULTADOS
+// ============================================================================
+
+static void finish_probe(ProbeEngine* engine, ProbeTarget* target, int status, int error, uint64_t now) {
+    if (target->fd >= 0) {
+        epoll_ctl(engine->epoll_fd, EPOLL_CTL_DEL, target->fd, NULL);
+        close(target->fd);
+        target->fd = -1;
+    }
+    target->in_flight = 0;
+    target->status = status;
+    target->error = error;
+
+    if (status == PROBE_OK) {
+        double rtt = (double)(now - target->sent_ns) / NS_PER_MS;
+        target->last_ms = rtt;
+        target->total_ms += rtt;
+        if (target->received == 0 || rtt < target->min_ms) target->min_ms = rtt;
+        if (rtt > target->max_ms) target->max_ms = rtt;
+        histogram_record(&target->histogram, rtt);
+        target->received++;
+    } else if (status == PROBE_TIMEOUT) {
+        target->timeouts++;
+    } else {
+        target->errors++;
+    }
+}
+
+// ============================================================================
+// ICMP
+// ============================================================================
+
+static uint16_t icmp_checksum(const void* data, size_t length) {
+    const uint16_t* words = data;
+    uint32_t sum = 0;
+
+    for (; length > 1; length -= 2) {
+        sum += *words++;
+    }
+    if (length == 1) {
+        sum += *(const uint8_t*)words;
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+// Socket de eco de una familia: primero el de ping sin privilegios (net.ipv4.ping_group_range),
+// después uno raw si el proceso tiene CAP_NET_RAW
+static int icmp_socket(ProbeEngine* engine, int family) {
+    int slot = family == AF_INET6 ? 1 : 0;
+    if (engine->icmp_fd[slot] != -1) {
+        return engine->icmp_fd[slot];
+    }
+
+    int protocol = family == AF_INET6 ? IPPROTO_ICMPV6 : IPPROTO_ICMP;
+    int fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+    if (fd < 0) {
+        fd = socket(family, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+        engine->icmp_raw[slot] = 1;
+    }
+    if (fd < 0) {
+        engine->icmp_fd[slot] = -2;
+        return -2;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data.u64 = (slot ? TAG_ICMP6 : TAG_ICMP4) << 32 };
+    epoll_ctl(engine->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    engine->icmp_fd[slot] = fd;
+    return fd;
+}
+
+static int send_echo(ProbeEngine* engine, ProbeTarget* target, int index) {
+    int family = target->addr.ss_family;
+    int fd = icmp_socket(engine, family);
+    if (fd < 0) {
+        return EPERM;
+    }
+
+    // Cabecera de 8 bytes común a ICMP e ICMPv6 seguida de la carga útil
+    struct {
+        uint8_t type;
+        uint8_t code;
+        uint16_t checksum;
+        uint16_t id;
+        uint16_t sequence;
+        ProbePayload payload;
+    } packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.type = family == AF_INET6 ? ICMP6_ECHO_REQUEST : ICMP_ECHO;
+    packet.id = htons(engine->echo_id);
+    packet.sequence = htons((uint16_t)target->round);
+    packet.payload.index = (uint32_t)index;
+    packet.payload.round = target->round;
+    if (family == AF_INET) {
+        packet.checksum = icmp_checksum(&packet, sizeof(packet));   // ICMPv6 lo calcula el kernel
+    }
+
+    if (sendto(fd, &packet, sizeof(packet), 0, (struct sockaddr*)&target->addr, target->addr_len) < 0) {
+        return errno;
+    }
+    return 0;
+}
+
+static void receive_echoes(ProbeEngine* engine, int slot) {
+    uint8_t buffer[PROBE_PACKET];
+    int fd = engine->icmp_fd[slot];
+
+    while (1) {
+        ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+        uint64_t now = monotonic_ns();
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        // Los sockets raw de IPv4 entregan también la cabecera IP
+        const uint8_t* icmp = buffer;
+        if (slot == 0 && engine->icmp_raw[0]) {
+            size_t header = (size_t)(buffer[0] & 0x0f) * 4;
+            if ((size_t)length < header) continue;
+            icmp += header;
+            length -= header;
+        }
+        if ((size_t)length < 8 + sizeof(ProbePayload)) {
+            continue;
+        }
+
+        uint8_t reply = slot ? ICMP6_ECHO_REPLY : ICMP_ECHOREPLY;
+        uint16_t id;
+        memcpy(&id, icmp + 4, sizeof(id));
+        if (icmp[0] != reply || (engine->icmp_raw[slot] && ntohs(id) != engine->echo_id)) {
+            continue;   // otro tráfico ICMP (solo llega a los sockets raw)
+        }
+
+        ProbePayload payload;
+        memcpy(&payload, icmp + 8, sizeof(payload));
+        if (payload.index >= (uint32_t)engine->count) {
+            continue;
+        }
+        ProbeTarget* target = &engine->targets[payload.index];
+        if (target->type == PROBE_ICMP && target->in_flight && target->round == payload.round) {
+            finish_probe(engine, target, PROBE_OK, 0, now);
+        }
+    }
+}
+
+// ============================================================================
+// TCP
+// ============================================================================
+
+static int start_connect(ProbeEngine* engine, ProbeTarget* target, int index) {
+    int fd = socket(target->addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return errno;
+    }
+
+    target->fd = fd;
+    if (connect(fd, (struct sockaddr*)&target->addr, target->addr_len) == 0) {
+        finish_probe(engine, target, PROBE_OK, 0, monotonic_ns());
+        return 0;
+    }
+    if (errno != EINPROGRESS) {
+        return errno;
+    }
+
+    struct epoll_event event = { .events = EPOLLOUT, .data.u64 = (TAG_TCP << 32) | (uint32_t)index };
+    if (epoll_ctl(engine->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        return errno;
+    }
+    return 0;
+}
+
+static void complete_connect(ProbeEngine* engine, uint32_t index) {
+    uint64_t now = monotonic_ns();
+    if (index >= (uint32_t)engine->count) {
+        return;
+    }
+
+    ProbeTarget* target = &engine->targets[index];
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (!target->in_flight || target->fd < 0) {
+        return;
+    }
+    getsockopt(target->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+    finish_probe(engine, target, error == 0 ? PROBE_OK : PROBE_ERROR, error, now);
+}
+
+// ============================================================================
+// BUCLE
+// ============================================================================
+
+static void send_probe(ProbeEngine* engine, int index, uint64_t now) {
+    ProbeTarget* target = &engine->targets[index];
+
+    target->round++;
+    target->sent++;
+    target->in_flight = 1;
+    target->sent_ns = now;
+    target->deadline_ns = now + (uint64_t)engine->config.timeout_ms * NS_PER_MS;
+    target->next_send_ns += (uint64_t)engine->config.interval_ms * NS_PER_MS;
+    if (target->next_send_ns < now) {
+        target->next_send_ns = now;   // el bucle se retrasó: no encadenar envíos atrasados
+    }
+
+    int error = target->type == PROBE_TCP ? start_connect(engine, target, index)
+                                          : send_echo(engine, target, index);
+    if (error != 0) {
+        finish_probe(engine, target, PROBE_ERROR, error, now);
+    }
+}
+
+static int rounds_left(const ProbeEngine* engine, const ProbeTarget* target) {
+    return engine->config.rounds <= 0 || target->sent < (uint64_t)engine->config.rounds;
+}
+
+// Enviar lo vencido, cerrar los sondeos caducados y devolver el siguiente instante
+// de interés (0 = no queda nada por hacer)
+static uint64_t service_targets(ProbeEngine* engine, uint64_t now) {
+    uint64_t next = UINT64_MAX;
+    int pending = 0;
+
+    for (int i = 0; i < engine->count; i++) {
+        ProbeTarget* target = &engine->targets[i];
+
+        if (target->in_flight && target->deadline_ns <= now) {
+            finish_probe(engine, target, PROBE_TIMEOUT, ETIMEDOUT, now);
+        }
+        if (!target->in_flight && rounds_left(engine, target) && target->next_send_ns <= now) {
+            send_probe(engine, i, now);
+        }
+
+        if (target->in_flight) {
+            pending = 1;
+            if (target->deadline_ns < next) next = target->deadline_ns;
+        } else if (rounds_left(engine, target)) {
+            pending = 1;
+            if (target->next_send_ns < next) next = target->next_send_ns;
+        }
+    }
+
+    return pending ? next : 0;
+}
+
+static int run_loop(ProbeEngine* engine) {
+    struct epoll_event events[PROBE_EVENTS];
+
+    while (1) {
+        uint64_t next = service_targets(engine, monotonic_ns());
+        if (next == 0) {
+            break;
+        }
+
+        struct itimerspec spec;
+        memset(&spec, 0, sizeof(spec));
+        spec.it_value.tv_sec = next / NS_PER_SECOND;
+        spec.it_value.tv_nsec = next % NS_PER_SECOND;
+        timerfd_settime(engine->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+        int ready = epoll_wait(engine->epoll_fd, events, PROBE_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            snprintf(engine->error, sizeof(engine->error), "epoll_wait: %s", strerror(errno));
+            return -1;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            uint64_t tag = events[i].data.u64 >> 32;
+            if (tag == TAG_TIMER) {
+                uint64_t expirations;
+                ssize_t ignored = read(engine->timer_fd, &expirations, sizeof(expirations));
+                (void)ignored;
+            } else if (tag == TAG_ICMP4 || tag == TAG_ICMP6) {
+                receive_echoes(engine, tag == TAG_ICMP6);
+            } else {
+                complete_connect(engine, (uint32_t)events[i].data.u64);
+            }
+        }
+    }
+
+    return 0;
+}
+
+int probe_engine_run(ProbeEngine* engine) {
+    uint64_t start = monotonic_ns();
+
+    // Repartir los primeros envíos a lo largo de un intervalo para no mandar ráfagas
+    for (int i = 0; i < engine->count; i++) {
+        ProbeTarget* target = &engine->targets[i];
+        target->next_send_ns = start + (uint64_t)engine->config.interval_ms * NS_PER_MS * i / engine->count;
+        if (engine->config.rounds == 1) {
+            target->next_send_ns = start;   // una sola ronda: todo a la vez
+        }
+    }
+
+    return run_loop(engine);
+}
+
+int probe_engine_round(ProbeEngine* engine) {
+    uint64_t start = monotonic_ns();
+    uint64_t sent = 0;
+
+    for (int i = 0; i < engine->count; i++) {
+        ProbeTarget* target = &engine->targets[i];
+        if (target->sent > sent) sent = target->sent;
+        target->next_send_ns = start;
+    }
+
+    // rounds_left deja pasar exactamente un sondeo más por destino
+    engine->config.rounds = (int)sent + 1;
+    return run_loop(engine);
+}
@@ -0,0 +1,259 @@
+#define _GNU_SOURCE
+#include "probe.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <curl/curl.h>
+
+#define NS_PER_MS 1000000ULL
+#define US_PER_MS 1000.0
+
+// Tiempo máximo entre dos vueltas del bucle aunque no haya actividad
+#define HTTP_POLL_MAX_MS 100
+
+const char* http_phase_name(int phase) {
+    static const char* names[HTTP_PHASES] = {"DNS", "TCP", "TLS", "Primer byte", "Total"};
+    return phase >= 0 && phase < HTTP_PHASES ? names[phase] : "?";
+}
+
+// El cuerpo de la respuesta no interesa: solo los tiempos
+static size_t discard_body(char* data, size_t size, size_t count, void* context) {
+    (void)data;
+    (void)context;
+    return size * count;
+}
+
+// ============================================================================
+// CICLO DE VIDA Y DESTINOS
+// ============================================================================
+
+int http_probe_init(HttpProbeEngine* engine, const ProbeConfig* config) {
+    memset(engine, 0, sizeof(HttpProbeEngine));
+    engine->config = *config;
+    if (engine->config.max_in_flight < 1) {
+        engine->config.max_in_flight = 1;
+    }
+
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+        snprintf(engine->error, sizeof(engine->error), "curl_global_init falló");
+        return -1;
+    }
+
+    engine->multi = curl_multi_init();
+    if (!engine->multi) {
+        snprintf(engine->error, sizeof(engine->error), "curl_multi_init falló");
+        curl_global_cleanup();
+        return -1;
+    }
+
+    return 0;
+}
+
+void http_probe_free(HttpProbeEngine* engine) {
+    for (int i = 0; i < engine->count; i++) {
+        HttpTarget* target = &engine->targets[i];
+        if (target->in_flight) {
+            curl_multi_remove_handle(engine->multi, target->handle);
+        }
+        curl_easy_cleanup(target->handle);
+    }
+    if (engine->multi) {
+        curl_multi_cleanup(engine->multi);
+        curl_global_cleanup();
+    }
+    free(engine->targets);
+    memset(engine, 0, sizeof(HttpProbeEngine));
+}
+
+int http_probe_add(HttpProbeEngine* engine, const char* url) {
+    if (strlen(url) >= sizeof(((HttpTarget*)0)->url)) {
+        snprintf(engine->error, sizeof(engine->error), "URL demasiado larga");
+        return -1;
+    }
+    if (engine->count == PROBE_MAX_TARGETS) {
+        snprintf(engine->error, sizeof(engine->error), "demasiados destinos (máximo %d)", PROBE_MAX_TARGETS);
+        return -1;
+    }
+
+    if (engine->count == engine->capacity) {
+        int capacity = engine->capacity > 0 ? engine->capacity * 2 : 16;
+        HttpTarget* targets = realloc(engine->targets, capacity * sizeof(HttpTarget));
+        if (!targets) {
+            snprintf(engine->error, sizeof(engine->error), "sin memoria");
+            return -1;
+        }
+        engine->targets = targets;
+        engine->capacity = capacity;
+
+        // CURLOPT_PRIVATE guarda el índice, así que mover el array no invalida nada
+    }
+
+    CURL* handle = curl_easy_init();
+    if (!handle) {
+        snprintf(engine->error, sizeof(engine->error), "curl_easy_init falló");
+        return -1;
+    }
+
+    int index = engine->count;
+    HttpTarget* target = &engine->targets[index];
+    memset(target, 0, sizeof(HttpTarget));
+    snprintf(target->url, sizeof(target->url), "%s", url);
+    target->handle = handle;
+
+    curl_easy_setopt(handle, CURLOPT_URL, target->url);
+    curl_easy_setopt(handle, CURLOPT_PRIVATE, (void*)(intptr_t)index);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, discard_body);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, (long)engine->config.timeout_ms);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, "nx-latency");
+
+    // Que el caché de conexiones de multi pueda conservar una por destino entre rondas
+    curl_multi_setopt(engine->multi, CURLMOPT_MAXCONNECTS, (long)(engine->count + 1));
+
+    return engine->count++;
+}
+
+// ============================================================================
+// BUCLE
+// ============================================================================
+
+// Las marcas de libcurl son acumuladas desde el inicio de la petición, en µs
+static void record_phases(HttpTarget* target) {
+    curl_off_t dns = 0, connect = 0, tls = 0, first_byte = 0, total = 0;
+    long connects = 0;
+
+    curl_easy_getinfo(target->handle, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(target->handle, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(target->handle, CURLINFO_APPCONNECT_TIME_T, &tls);
+    curl_easy_getinfo(target->handle, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+    curl_easy_getinfo(target->handle, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(target->handle, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(target->handle, CURLINFO_RESPONSE_CODE, &target->http_code);
+
+    // Con la conexión reutilizada no hay DNS, TCP ni TLS: esas fases valen 0
+    curl_off_t ready = tls > 0 ? tls : connect;
+    double* last = target->last_ms;
+    last[HTTP_PHASE_DNS] = dns / US_PER_MS;
+    last[HTTP_PHASE_CONNECT] = connect > dns ? (connect - dns) / US_PER_MS : 0.0;
+    last[HTTP_PHASE_TLS] = tls > connect ? (tls - connect) / US_PER_MS : 0.0;
+    last[HTTP_PHASE_FIRST_BYTE] = first_byte > ready ? (first_byte - ready) / US_PER_MS : 0.0;
+    last[HTTP_PHASE_TOTAL] = total / US_PER_MS;
+
+    for (int i = 0; i < HTTP_PHASES; i++) {
+        target->total_ms[i] += last[i];
+    }
+    target->connections += connects;
+    histogram_record(&target->histogram, last[HTTP_PHASE_TOTAL]);
+}
+
+static void finish_request(HttpProbeEngine* engine, CURL* handle, CURLcode result) {
+    void* private_data = NULL;
+    curl_easy_getinfo(handle, CURLINFO_PRIVATE, (char**)&private_data);
+    HttpTarget* target = &engine->targets[(intptr_t)private_data];
+
+    curl_multi_remove_handle(engine->multi, handle);
+    target->in_flight = 0;
+    engine->in_flight--;
+
+    if (result == CURLE_OK) {
+        target->status = PROBE_OK;
+        target->received++;
+        target->error[0] = '\0';
+        record_phases(target);
+    } else {
+        target->status = result == CURLE_OPERATION_TIMEDOUT ? PROBE_TIMEOUT : PROBE_ERROR;
+        if (target->status == PROBE_TIMEOUT) {
+            target->timeouts++;
+        } else {
+            target->errors++;
+        }
+        snprintf(target->error, sizeof(target->error), "%s", curl_easy_strerror(result));
+    }
+}
+
+static int rounds_left(const HttpProbeEngine* engine, const HttpTarget* target) {
+    return engine->config.rounds <= 0 || target->sent < (uint64_t)engine->config.rounds;
+}
+
+// Lanzar las peticiones vencidas sin pasar del tope y devolver los ms hasta el
+// siguiente envío (-1 = no queda nada por hacer)
+static long start_due(HttpProbeEngine* engine, uint64_t now) {
+    uint64_t next = UINT64_MAX;
+    int pending = engine->in_flight > 0;
+
+    for (int i = 0; i < engine->count; i++) {
+        HttpTarget* target = &engine->targets[i];
+        if (target->in_flight || !rounds_left(engine, target)) {
+            continue;
+        }
+        pending = 1;
+
+        if (target->next_send_ns <= now && engine->in_flight < engine->config.max_in_flight) {
+            if (curl_multi_add_handle(engine->multi, target->handle) == CURLM_OK) {
+                target->in_flight = 1;
+                target->sent++;
+                engine->in_flight++;
+            }
+            target->next_send_ns += (uint64_t)engine->config.interval_ms * NS_PER_MS;
+            if (target->next_send_ns < now) {
+                target->next_send_ns = now;   // tope alcanzado o bucle retrasado
+            }
+            continue;
+        }
+        if (target->next_send_ns < next) {
+            next = target->next_send_ns;
+        }
+    }
+
+    if (!pending) {
+        return -1;
+    }
+    if (next == UINT64_MAX || next <= now) {
+        return 0;
+    }
+    return (long)((next - now + NS_PER_MS - 1) / NS_PER_MS);
+}
+
+int http_probe_run(HttpProbeEngine* engine) {
+    uint64_t start = monotonic_ns();
+
+    // Repartir los primeros envíos a lo largo de un intervalo, como los sondeos ICMP/TCP
+    for (int i = 0; i < engine->count; i++) {
+        engine->targets[i].next_send_ns = engine->config.rounds == 1
+            ? start
+            : start + (uint64_t)engine->config.interval_ms * NS_PER_MS * i / engine->count;
+    }
+
+    while (1) {
+        long wait_ms = start_due(engine, monotonic_ns());
+        if (wait_ms < 0) {
+            break;
+        }
+
+        int running;
+        CURLMcode code = curl_multi_perform(engine->multi, &running);
+        if (code != CURLM_OK) {
+            snprintf(engine->error, sizeof(engine->error), "curl_multi_perform: %s", curl_multi_strerror(code));
+            return -1;
+        }
+
+        CURLMsg* message;
+        int queued;
+        while ((message = curl_multi_info_read(engine->multi, &queued)) != NULL) {
+            if (message->msg == CURLMSG_DONE) {
+                finish_request(engine, message->easy_handle, message->data.result);
+            }
+        }
+
+        // curl_multi_poll vuelve antes si hay actividad o vence un temporizador de libcurl
+        if (wait_ms == 0 && engine->in_flight == 0) {
+            continue;
+        }
+        if (wait_ms == 0 || wait_ms > HTTP_POLL_MAX_MS) {
+            wait_ms = HTTP_POLL_MAX_MS;
+        }
+        curl_multi_poll(engine->multi, NULL, 0, (int)wait_ms, NULL);
+    }
+
+    return 0;
+}
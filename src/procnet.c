@@ -0,0 +1,401 @@
+#define _GNU_SOURCE
+#include "procnet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <netinet/in.h>
+
+// ============================================================================
+// RAÍZ DE /proc
+// ============================================================================
+
+static char root[PROC_ROOT_MAX];
+static int root_ready = 0;
+
+// Sin barra final, para poder anteponerla a "/proc/..."
+static void set_root(const char* value) {
+    snprintf(root, sizeof(root), "%s", value ? value : "");
+    size_t length = strlen(root);
+    while (length > 0 && root[length - 1] == '/') {
+        root[--length] = '\0';
+    }
+    root_ready = 1;
+}
+
+const char* proc_root(void) {
+    if (!root_ready) {
+        set_root(getenv("NX_PROC_ROOT"));
+    }
+    return root;
+}
+
+void proc_set_root(const char* value) {
+    set_root(value);
+    proc_registry_free(proc_registry_shared());   // sus fds apuntan a la raíz anterior
+}
+
+const char* proc_path(const char* path, char* buffer, size_t size) {
+    if (!proc_root()[0]) {
+        return path;
+    }
+    snprintf(buffer, size, "%s%s", root, path);
+    return buffer;
+}
+
+// ============================================================================
+// LECTURA DE FICHEROS
+// ============================================================================
+
+// Mantener siempre al menos un bloque libre para la siguiente lectura
+static int reserve_chunk(ProcBuffer* buffer) {
+    if (buffer->capacity - buffer->length >= PROC_BUFFER_CHUNK) {
+        return 0;
+    }
+
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity * 2 : PROC_BUFFER_CHUNK * 2;
+    char* data = realloc(buffer->data, capacity);
+    if (!data) {
+        return -1;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+// Leer desde el offset 0 hasta el final con pread, sumando las llamadas en syscalls
+static int read_from_start(ProcBuffer* buffer, int fd, uint64_t* syscalls) {
+    buffer->length = 0;
+    while (1) {
+        if (reserve_chunk(buffer) < 0) {
+            return -1;
+        }
+
+        ssize_t bytes = pread(fd, buffer->data + buffer->length,
+                              buffer->capacity - buffer->length - 1, buffer->length);
+        (*syscalls)++;
+        if (bytes < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (bytes == 0) {
+            break;
+        }
+        buffer->length += bytes;
+    }
+
+    buffer->data[buffer->length] = '\0';
+    return 0;
+}
+
+int proc_buffer_read(ProcBuffer* buffer, const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    uint64_t syscalls = 0;
+    int result = read_from_start(buffer, fd, &syscalls);
+    close(fd);
+    return result < 0 ? -1 : (int)buffer->length;
+}
+
+void proc_buffer_free(ProcBuffer* buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(ProcBuffer));
+}
+
+// ============================================================================
+// REGISTRO DE FUENTES ABIERTAS
+// ============================================================================
+
+static ProcRegistry shared_registry;
+
+ProcRegistry* proc_registry_shared(void) {
+    return &shared_registry;
+}
+
+static void close_source(ProcRegistry* registry, ProcSource* source) {
+    if (source->fd >= 0) {
+        close(source->fd);
+        registry->syscalls++;
+        source->fd = -1;
+    }
+}
+
+// Buscar la fuente de una ruta o reservar una, reciclando la menos usada si no caben más
+static ProcSource* find_source(ProcRegistry* registry, const char* path) {
+    ProcSource* oldest = NULL;
+
+    for (int i = 0; i < registry->count; i++) {
+        ProcSource* source = &registry->sources[i];
+        if (strcmp(source->path, path) == 0) {
+            return source;
+        }
+        if (!oldest || source->last_used < oldest->last_used) {
+            oldest = source;
+        }
+    }
+
+    if (strlen(path) >= PROC_SOURCE_PATH) {
+        return NULL;
+    }
+
+    ProcSource* source = registry->count < PROC_SOURCE_MAX ? &registry->sources[registry->count++] : oldest;
+    if (source == oldest) {
+        close_source(registry, source);
+    }
+    snprintf(source->path, PROC_SOURCE_PATH, "%s", path);
+    source->fd = -1;
+    return source;
+}
+
+const char* proc_registry_read(ProcRegistry* registry, const char* path, size_t* length) {
+    ProcSource* source = find_source(registry, path);
+    if (!source) {
+        return NULL;
+    }
+    source->last_used = ++registry->clock;
+
+    // Un fd abierto puede haber quedado huérfano (ENODEV, ESRCH): reabrir una vez
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int reopened = source->fd < 0;
+        if (reopened) {
+            char rooted[PROC_PATH_MAX];
+            source->fd = open(proc_path(path, rooted, sizeof(rooted)), O_RDONLY | O_CLOEXEC);
+            registry->syscalls++;
+            if (source->fd < 0) {
+                return NULL;
+            }
+        }
+
+        if (read_from_start(&registry->buffer, source->fd, &registry->syscalls) == 0) {
+            if (length) *length = registry->buffer.length;
+            return registry->buffer.data;
+        }
+
+        close_source(registry, source);
+        if (reopened) {
+            return NULL;
+        }
+        registry->reopens++;
+    }
+
+    return NULL;
+}
+
+void proc_registry_forget(ProcRegistry* registry, const char* path) {
+    for (int i = 0; i < registry->count; i++) {
+        if (strcmp(registry->sources[i].path, path) == 0) {
+            close_source(registry, &registry->sources[i]);
+            registry->sources[i] = registry->sources[--registry->count];
+            return;
+        }
+    }
+}
+
+void proc_registry_free(ProcRegistry* registry) {
+    for (int i = 0; i < registry->count; i++) {
+        close_source(registry, &registry->sources[i]);
+    }
+    proc_buffer_free(&registry->buffer);
+    memset(registry, 0, sizeof(ProcRegistry));
+}
+
+// ============================================================================
+// PARSEO A MANO DE CAMPOS
+// ============================================================================
+
+// Tabla de valores hexadecimales (-1 = no hexadecimal)
+static signed char hex_value[256];
+static int hex_ready = 0;
+
+static void init_hex_table(void) {
+    memset(hex_value, -1, sizeof(hex_value));
+    for (int i = 0; i < 10; i++) hex_value['0' + i] = i;
+    for (int i = 0; i < 6; i++) {
+        hex_value['a' + i] = 10 + i;
+        hex_value['A' + i] = 10 + i;
+    }
+    hex_ready = 1;
+}
+
+static const char* skip_spaces(const char* p, const char* end) {
+    while (p < end && *p == ' ') p++;
+    return p;
+}
+
+static const char* skip_field(const char* p, const char* end) {
+    while (p < end && *p != ' ' && *p != '\n') p++;
+    return skip_spaces(p, end);
+}
+
+// Leer un número hexadecimal de longitud variable
+static const char* parse_hex(const char* p, const char* end, uint32_t* value) {
+    uint32_t result = 0;
+    int digit;
+    while (p < end && (digit = hex_value[(unsigned char)*p]) >= 0) {
+        result = (result << 4) | digit;
+        p++;
+    }
+    *value = result;
+    return p;
+}
+
+// Leer un número decimal
+static const char* parse_decimal(const char* p, const char* end, uint64_t* value) {
+    uint64_t result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (*p - '0');
+        p++;
+    }
+    *value = result;
+    return p;
+}
+
+// Leer una dirección "HHHHHHHH[...]:PPPP". El kernel imprime cada palabra de 32 bits
+// en orden de host, así que se copia tal cual a la dirección binaria
+static const char* parse_address(const char* p, const char* end, int words, uint8_t* addr, uint16_t* port) {
+    for (int w = 0; w < words; w++) {
+        if (end - p < 8) return NULL;
+        uint32_t word = 0;
+        for (int i = 0; i < 8; i++) {
+            int digit = hex_value[(unsigned char)p[i]];
+            if (digit < 0) return NULL;
+            word = (word << 4) | digit;
+        }
+        memcpy(addr + w * 4, &word, 4);
+        p += 8;
+    }
+
+    if (p >= end || *p != ':') return NULL;
+
+    uint32_t value;
+    p = parse_hex(p + 1, end, &value);
+    *port = (uint16_t)value;
+    return skip_spaces(p, end);
+}
+
+// ============================================================================
+// PARSEO DE /proc/net
+// ============================================================================
+
+int procnet_parse(const char* data, size_t length, int family, int protocol,
+                  uint32_t states, uint64_t timestamp_ns, ConnectionList* list) {
+    const char* end = data + length;
+    const char* line = memchr(data, '\n', length);   // saltar encabezado
+    int words = family == AF_INET6 ? 4 : 1;
+    int added = 0;
+
+    if (!hex_ready) {
+        init_hex_table();
+    }
+
+    while (line && ++line < end) {
+        const char* next = memchr(line, '\n', end - line);
+        const char* line_end = next ? next : end;
+        Connection row;
+        uint32_t state;
+        uint64_t uid, inode;
+
+        // sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid timeout inode
+        const char* p = skip_spaces(line, line_end);
+        p = skip_field(p, line_end);
+        p = parse_address(p, line_end, words, row.local_addr, &row.local_port);
+        if (p) p = parse_address(p, line_end, words, row.remote_addr, &row.remote_port);
+        if (!p) {
+            line = next;
+            continue;
+        }
+
+        p = parse_hex(p, line_end, &state);
+        p = skip_spaces(p, line_end);
+        p = skip_field(p, line_end);   // tx_queue:rx_queue
+        p = skip_field(p, line_end);   // tr:tm->when
+        p = skip_field(p, line_end);   // retrnsmt
+        p = parse_decimal(p, line_end, &uid);
+        p = skip_spaces(p, line_end);
+        p = skip_field(p, line_end);   // timeout
+        parse_decimal(p, line_end, &inode);
+
+        if (state < 32 && (states & (1u << state))) {
+            Connection* conn = connection_list_append(list);
+            if (!conn) {
+                return -1;
+            }
+
+            memcpy(conn->local_addr, row.local_addr, words * 4);
+            memcpy(conn->remote_addr, row.remote_addr, words * 4);
+            conn->family = family;
+            conn->protocol = protocol;
+            conn->state = state;
+            conn->local_port = row.local_port;
+            conn->remote_port = row.remote_port;
+            conn->uid = (uint32_t)uid;
+            conn->inode = inode;
+            conn->process[0] = '\0';
+            conn->pid = 0;
+            conn->timestamp_ns = timestamp_ns;
+            added++;
+        }
+
+        line = next;
+    }
+
+    return added;
+}
+
+int procnet_collect(ProcRegistry* registry, uint32_t states, ConnectionList* list) {
+    static const struct {
+        const char* path;
+        int family;
+        int protocol;
+    } sources[] = {
+        {"/proc/net/tcp", AF_INET, IPPROTO_TCP},
+        {"/proc/net/tcp6", AF_INET6, IPPROTO_TCP},
+        {"/proc/net/udp", AF_INET, IPPROTO_UDP},
+        {"/proc/net/udp6", AF_INET6, IPPROTO_UDP},
+    };
+    int total = 0;
+    int readable = 0;
+
+    for (int i = 0; i < 4; i++) {
+        // Los ficheros IPv6 no existen si el kernel no tiene IPv6
+        size_t length;
+        const char* data = proc_registry_read(registry, sources[i].path, &length);
+        if (!data) {
+            continue;
+        }
+        readable++;
+
+        int added = procnet_parse(data, length, sources[i].family,
+                                  sources[i].protocol, states, monotonic_ns(), list);
+        if (added < 0) {
+            return -1;
+        }
+        total += added;
+    }
+
+    return readable > 0 ? total : -1;
+}
+
+int procnet_count(ProcRegistry* registry, const char* path) {
+    size_t length;
+    const char* data = proc_registry_read(registry, path, &length);
+    if (!data) {
+        return -1;
+    }
+
+    int lines = 0;
+    const char* p = data;
+    const char* end = data + length;
+    while ((p = memchr(p, '\n', end - p)) != NULL) {
+        lines++;
+        p++;
+    }
+
+    // Descontar el encabezado
+    return lines > 0 ? lines - 1 : 0;
+}
@@ -236,41 +236,61 @@ void draw_progress_bar_advanced(int y, int x, int width, double percentage,
     mvprintw(y, x + strlen(label) + 3 + bar_width, " %s", value);
 }
 
-void draw_latency_bars(int y, int x, const char* servers[], double latencies[], int count) {
-    draw_box_advanced(y, x, count + 2, 50, "Latencia", 0);
+// Bandas de percentiles por servidor: '#' hasta p50, '=' hasta p99 y '-' hasta p99.9,
+// todas en la escala del p99.9 más alto
+void draw_latency_bars(int y, int x, int width, const LatencyTest tests[], int count) {
+    draw_box_advanced(y, x, count + 2, width, "Latencia p50/p99/p99.9", 0);
+    
+    int bar_width = width - 2 - 16 - 24;
+    if (bar_width < 4) bar_width = 4;
+    
+    double max_latency = 1.0;
+    for (int i = 0; i < count; i++) {
+        if (tests[i].p999 > max_latency) max_latency = tests[i].p999;
+    }
     
     for (int i = 0; i < count; i++) {
+        const LatencyTest* test = &tests[i];
         int bar_y = y + 1 + i;
-        int bar_width = 30;
         
         // Nombre del servidor
-        mvprintw(bar_y, x + 1, "%-15s", servers[i]);
+        mvprintw(bar_y, x + 1, "%-15.15s", test->server);
+        
+        if (test->samples == 0) {
+            attron(COLOR_PAIR(COLOR_ERROR));
+            mvprintw(bar_y, x + 17, "%s", test->status == 1 ? "timeout" : "sin respuesta");
+            attroff(COLOR_PAIR(COLOR_ERROR));
+            continue;
+        }
         
-        // Barra de latencia
-        double max_latency = 100.0; // 100ms máximo
-        int filled_width = latencies[i] > max_latency ? bar_width : 
-                          (int)((latencies[i] / max_latency) * bar_width);
+        int p50_width = (int)(test->p50 / max_latency * bar_width);
+        int p99_width = (int)(test->p99 / max_latency * bar_width);
+        int p999_width = (int)(test->p999 / max_latency * bar_width);
         
-        // Color según latencia
-        if (latencies[i] < 20) {
+        // Color según la cola (p99)
+        if (test->p99 < 20) {
             attron(COLOR_PAIR(COLOR_SUCCESS));
-        } else if (latencies[i] < 50) {
+        } else if (test->p99 < 50) {
             attron(COLOR_PAIR(COLOR_INFO));
         } else {
             attron(COLOR_PAIR(COLOR_WARNING));
         }
         
         for (int j = 0; j < bar_width; j++) {
-            if (j < filled_width) {
-                mvaddch(bar_y, x + 16 + j, '#');
-            } else {
-                mvaddch(bar_y, x + 16 + j, ' ');
+            char c = ' ';
+            if (j <= p50_width) {
+                c = '#';
+            } else if (j <= p99_width) {
+                c = '=';
+            } else if (j <= p999_width) {
+                c = '-';
             }
+            mvaddch(bar_y, x + 17 + j, c);
         }
         attroff(COLOR_PAIR(COLOR_SUCCESS) | COLOR_PAIR(COLOR_INFO) | COLOR_PAIR(COLOR_WARNING));
         
-        // Valor de latencia
-        mvprintw(bar_y, x + 47, "%.1fms", latencies[i]);
+        // Valores de los percentiles
+        mvprintw(bar_y, x + 18 + bar_width, "%.1f/%.1f/%.1f ms", test->p50, test->p99, test->p999);
     }
 }
 
@@ -0,0 +1,116 @@
+#define _GNU_SOURCE
+#include "rollup.h"
+#include "utils.h"
+#include <string.h>
+
+static const uint64_t resolutions_s[ROLLUP_TIERS] = { 1, 10, 60, 3600 };
+
+const char* rollup_tier_name(int tier) {
+    static const char* names[ROLLUP_TIERS] = { "1 s", "10 s", "1 min", "1 h" };
+    return tier >= 0 && tier < ROLLUP_TIERS ? names[tier] : "?";
+}
+
+void rollup_init(Rollup* rollup) {
+    memset(rollup, 0, sizeof(Rollup));
+    for (int i = 0; i < ROLLUP_TIERS; i++) {
+        rollup->tiers[i].resolution_ns = resolutions_s[i] * NS_PER_SECOND;
+    }
+}
+
+// Avanzar el anillo hasta el cubo time, vaciando los cubos sin muestras intermedios
+static void advance(RollupTier* tier, uint64_t time) {
+    if (tier->filled == 0) {
+        tier->current = time;
+        tier->head = 0;
+        tier->filled = 1;
+        memset(&tier->buckets[0], 0, sizeof(RollupBucket));
+        return;
+    }
+    if (time <= tier->current) {
+        return;
+    }
+
+    uint64_t steps = time - tier->current;
+    if (steps > ROLLUP_SLOTS) {
+        steps = ROLLUP_SLOTS;
+    }
+    for (uint64_t i = 0; i < steps; i++) {
+        tier->head = (tier->head + 1) % ROLLUP_SLOTS;
+        memset(&tier->buckets[tier->head], 0, sizeof(RollupBucket));
+    }
+    tier->filled = tier->filled + (int)steps > ROLLUP_SLOTS ? ROLLUP_SLOTS : tier->filled + (int)steps;
+    tier->current = time;
+
+    // Los candidatos que ya no caben en el anillo no pueden ser máximo de ninguna ventana
+    while (tier->peak_count > 0 && tier->peaks[tier->peak_first].time + ROLLUP_SLOTS <= time) {
+        tier->peak_first = (tier->peak_first + 1) % ROLLUP_SLOTS;
+        tier->peak_count--;
+    }
+}
+
+static void push_peak(RollupTier* tier, uint64_t time, double value) {
+    // Un candidato más antiguo que no supera al nuevo ya no será máximo de ninguna ventana
+    while (tier->peak_count > 0) {
+        RollupPeak* back = &tier->peaks[(tier->peak_first + tier->peak_count - 1) % ROLLUP_SLOTS];
+        if (back->value > value) {
+            if (back->time == time) {
+                return;   // el cubo actual ya tiene un máximo mayor
+            }
+            break;
+        }
+        tier->peak_count--;
+    }
+
+    RollupPeak* peak = &tier->peaks[(tier->peak_first + tier->peak_count) % ROLLUP_SLOTS];
+    peak->time = time;
+    peak->value = value;
+    tier->peak_count++;
+}
+
+void rollup_add(Rollup* rollup, uint64_t timestamp_ns, double value) {
+    for (int i = 0; i < ROLLUP_TIERS; i++) {
+        RollupTier* tier = &rollup->tiers[i];
+        uint64_t time = timestamp_ns / tier->resolution_ns;
+
+        advance(tier, time);
+
+        RollupBucket* bucket = &tier->buckets[tier->head];
+        if (bucket->count == 0 || value < bucket->min) bucket->min = value;
+        if (bucket->count == 0 || value > bucket->max) bucket->max = value;
+        bucket->sum += value;
+        bucket->last = value;
+        bucket->count++;
+
+        push_peak(tier, tier->current, value);
+    }
+    rollup->samples++;
+}
+
+const RollupBucket* rollup_bucket(const Rollup* rollup, int tier, int age) {
+    const RollupTier* level = &rollup->tiers[tier];
+    if (age < 0 || age >= level->filled) {
+        return NULL;
+    }
+    return &level->buckets[(level->head - age + ROLLUP_SLOTS) % ROLLUP_SLOTS];
+}
+
+double rollup_window_max(const Rollup* rollup, int tier, int buckets) {
+    const RollupTier* level = &rollup->tiers[tier];
+    if (level->peak_count == 0 || buckets <= 0) {
+        return 0.0;
+    }
+
+    // Los candidatos están ordenados por tiempo: buscar el primero dentro de la ventana
+    uint64_t cutoff = level->current + 1 >= (uint64_t)buckets ? level->current + 1 - buckets : 0;
+    int low = 0;
+    int high = level->peak_count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (level->peaks[(level->peak_first + middle) % ROLLUP_SLOTS].time < cutoff) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < level->peak_count ? level->peaks[(level->peak_first + low) % ROLLUP_SLOTS].value : 0.0;
+}
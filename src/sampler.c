@@ -0,0 +1,561 @@
+#define _GNU_SOURCE
+#include "sampler.h"
+#include "collector.h"
+#include "procnet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+// El historial tiene que poder llevar abierta una serie por cada interfaz de la lista
+#if TSDB_MAX_SERIES < SAMPLER_MAX_INTERFACES
+#error "TSDB_MAX_SERIES debe ser al menos SAMPLER_MAX_INTERFACES"
+#endif
+
+const double sampler_latency_bounds_ms[SAMPLER_LATENCY_BOUNDS] = {
+    0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500
+};
+
+// ============================================================================
+// RECOLECTORES (solo el hilo de muestreo; escriben en sampler->current)
+// ============================================================================
+
+// Contadores de cada interfaz de la lista, del último volcado de enlaces (lee memoria)
+static void copy_interface_stats(Snapshot* snapshot) {
+    for (int i = 0; i < snapshot->interface_count; i++) {
+        snapshot->interface_stats[i] = collect_network_stats(snapshot->interfaces[i]);
+    }
+}
+
+static int collect_interfaces(void* context) {
+    Sampler* sampler = context;
+    Snapshot* snapshot = &sampler->current;
+
+    // La tabla de enlaces se mantiene al día con notificaciones: esto lee memoria
+    snapshot->interface_count = list_interfaces(snapshot->interfaces, snapshot->interface_active,
+                                                SAMPLER_MAX_INTERFACES);
+    copy_interface_stats(snapshot);   // alineados con la lista aunque esta cambie
+
+    // Conservar la interfaz principal mientras siga activa
+    int keep = 0;
+    for (int i = 0; snapshot->has_interface && i < snapshot->interface_count; i++) {
+        if (snapshot->interface_active[i] && strcmp(snapshot->interfaces[i], snapshot->interface) == 0) {
+            keep = 1;
+            break;
+        }
+    }
+    if (!keep) {
+        snapshot->has_interface = 0;
+        snapshot->has_speeds = 0;
+        snapshot->interface_ip[0] = '\0';
+        sampler->has_previous = 0;   // interfaz nueva: sin referencia para velocidades
+        for (int i = 0; i < snapshot->interface_count; i++) {
+            if (snapshot->interface_active[i]) {
+                memcpy(snapshot->interface, snapshot->interfaces[i], MAX_INTERFACE_NAME);
+                snapshot->has_interface = 1;
+                break;
+            }
+        }
+
+        // La dirección cacheada era de otra interfaz: releerla ya
+        sampler->scheduler.collectors[SAMPLE_ADDRESS].next_due_ns = 0;
+    }
+
+    snapshot->collected_ns[SAMPLE_INTERFACES] = monotonic_ns();
+    return 0;
+}
+
+// Guardar en el historial los contadores de cada interfaz de la última lectura, la
+// principal primero. Los fallos se cuentan en la muestra en vez de perderse
+static void record_history(Sampler* sampler) {
+    Snapshot* snapshot = &sampler->current;
+    uint64_t now = tsdb_now_ms();
+
+    if (snapshot->has_interface) {
+        TsdbSample sample = { now, snapshot->stats.rx_bytes, snapshot->stats.tx_bytes };
+        if (tsdb_append(&sampler->history, snapshot->interface, &sample) < 0) {
+            snapshot->history_errors++;
+        }
+    }
+    for (int i = 0; i < snapshot->interface_count; i++) {
+        if (snapshot->has_interface && strcmp(snapshot->interfaces[i], snapshot->interface) == 0) {
+            continue;
+        }
+        const NetworkStats* stats = &snapshot->interface_stats[i];
+        TsdbSample sample = { now, stats->rx_bytes, stats->tx_bytes };
+        if (tsdb_append(&sampler->history, snapshot->interfaces[i], &sample) < 0) {
+            snapshot->history_errors++;
+        }
+    }
+}
+
+static int collect_links(void* context) {
+    Sampler* sampler = context;
+    Snapshot* snapshot = &sampler->current;
+
+    if (!snapshot->has_interface) {
+        return 0;
+    }
+
+    // Las velocidades usan las marcas monotónicas tomadas junto a cada lectura de contadores.
+    // Un volcado trae todos los enlaces: se guardan los de cada interfaz de la lista
+    refresh_network_stats();
+    copy_interface_stats(snapshot);
+    snapshot->stats = collect_network_stats(snapshot->interface);
+    snapshot->has_speeds = sampler->has_previous;
+    if (snapshot->has_speeds) {
+        calculate_speeds(&snapshot->stats, &sampler->previous);
+    }
+    sampler->previous = snapshot->stats;
+    sampler->has_previous = 1;
+    if (sampler->history_ready) {
+        record_history(sampler);
+    }
+
+    snapshot->collected_ns[SAMPLE_LINKS] = snapshot->stats.timestamp_ns;
+    return 0;
+}
+
+static int collect_address(void* context) {
+    Sampler* sampler = context;
+    Snapshot* snapshot = &sampler->current;
+
+    if (!snapshot->has_interface) {
+        return 0;
+    }
+
+    if (get_interface_address(snapshot->interface, snapshot->interface_ip, MAX_IP_ADDRESS) < 0) {
+        snprintf(snapshot->interface_ip, MAX_IP_ADDRESS, "No disponible");
+    }
+
+    snapshot->collected_ns[SAMPLE_ADDRESS] = monotonic_ns();
+    return 0;
+}
+
+static int collect_sockets(void* context) {
+    Sampler* sampler = context;
+    Snapshot* snapshot = &sampler->current;
+    int count;
+    Connection* connections = collect_connections(&count);
+
+    if (!connections) {
+        return -1;
+    }
+
+    // El total TCP sale de la misma lectura en lugar de releer /proc/net/tcp*
+    snapshot->connection_count = 0;
+    snapshot->tcp_connections = 0;
+    snapshot->udp_sockets = 0;
+    memset(snapshot->tcp_states, 0, sizeof(snapshot->tcp_states));
+    for (int i = 0; i < count; i++) {
+        if (snapshot->connection_count < SAMPLER_MAX_CONNECTIONS) {
+            snapshot->connections[snapshot->connection_count++] = connections[i];
+        }
+        if (connections[i].protocol == IPPROTO_TCP) {
+            snapshot->tcp_connections++;
+            if (connections[i].state < SAMPLER_TCP_STATES) {
+                snapshot->tcp_states[connections[i].state]++;
+            }
+        } else {
+            snapshot->udp_sockets++;
+        }
+    }
+    snapshot->connection_total = count;
+    free(connections);
+
+    snapshot->collected_ns[SAMPLE_SOCKETS] = monotonic_ns();
+    return 0;
+}
+
+static int collect_processes(void* context) {
+    Sampler* sampler = context;
+
+    sampler->current.processes = get_active_processes();
+    sampler->current.collected_ns[SAMPLE_PROCESSES] = monotonic_ns();
+    return 0;
+}
+
+// Copiar la última ronda del hilo de latencia (solo memoria: nunca espera a la red)
+static int collect_latency(void* context) {
+    Sampler* sampler = context;
+    Snapshot* snapshot = &sampler->current;
+    const SamplerLatency* result = &sampler->latency_result;
+
+    pthread_mutex_lock(&sampler->latency_lock);
+    if (result->collected_ns == 0 || result->collected_ns == snapshot->collected_ns[SAMPLE_LATENCY]) {
+        pthread_mutex_unlock(&sampler->latency_lock);
+        return 0;
+    }
+    memcpy(snapshot->latency, result->latency, sizeof(snapshot->latency));
+    snapshot->latency_count = result->latency_count;
+    memcpy(snapshot->latency_distribution, result->latency_distribution, sizeof(snapshot->latency_distribution));
+    snapshot->latency_bins = result->latency_bins;
+    snapshot->latency_max_ms = result->latency_max_ms;
+    memcpy(snapshot->latency_buckets, result->latency_buckets, sizeof(snapshot->latency_buckets));
+    memcpy(snapshot->latency_sum_ms, result->latency_sum_ms, sizeof(snapshot->latency_sum_ms));
+    snapshot->collected_ns[SAMPLE_LATENCY] = result->collected_ns;
+    pthread_mutex_unlock(&sampler->latency_lock);
+    return 0;
+}
+
+// ============================================================================
+// HILO DE LATENCIA (escribe en sampler->latency_round y publica en latency_result)
+// ============================================================================
+
+static int latency_stopping(Sampler* sampler) {
+    return __atomic_load_n(&sampler->stopping, __ATOMIC_ACQUIRE);
+}
+
+// Abrir el motor y resolver los destinos (getaddrinfo bloquea: por eso este hilo)
+static int open_latency(Sampler* sampler) {
+    static const char* servers[] = { PROBE_DEFAULT_TARGETS };
+    SamplerLatency* round = &sampler->latency_round;
+    ProbeConfig config;
+
+    probe_default_config(&config);
+    config.timeout_ms = SAMPLER_LATENCY_TIMEOUT_MS;
+    if (probe_engine_init(&sampler->latency_engine, &config) < 0) {
+        return -1;
+    }
+
+    round->latency_count = 0;
+    for (int i = 0; i < (int)(sizeof(servers) / sizeof(servers[0])) && i < SAMPLER_LATENCY_TARGETS; i++) {
+        if (latency_stopping(sampler)) {
+            break;
+        }
+        LatencyTest* test = &round->latency[round->latency_count];
+        memset(test, 0, sizeof(LatencyTest));
+        snprintf(test->server, MAX_SERVER_NAME, "%s", servers[i]);
+        test->status = PROBE_ERROR;
+        latency_test_percentiles(test, NULL);
+        sampler->latency_targets[round->latency_count++] = probe_engine_add(&sampler->latency_engine, servers[i]);
+    }
+
+    sampler->latency_window_ns = monotonic_ns();
+    return 0;
+}
+
+// Una ronda de ecos y los percentiles de las últimas ventanas
+static void run_latency_round(Sampler* sampler) {
+    SamplerLatency* round = &sampler->latency_round;
+
+    probe_engine_round(&sampler->latency_engine);
+    uint64_t now = monotonic_ns();
+
+    // Rotar la ventana: la más antigua se vacía y pasa a ser la actual
+    if (now - sampler->latency_window_ns >= (uint64_t)SAMPLER_LATENCY_WINDOW_MS * 1000000ULL) {
+        sampler->latency_window = (sampler->latency_window + 1) % SAMPLER_LATENCY_WINDOWS;
+        for (int i = 0; i < SAMPLER_LATENCY_TARGETS; i++) {
+            histogram_init(&sampler->latency_windows[sampler->latency_window][i]);
+        }
+        sampler->latency_window_ns = now;
+    }
+
+    LatencyHistogram merged;
+    LatencyHistogram all;
+    histogram_init(&all);
+    for (int i = 0; i < round->latency_count; i++) {
+        LatencyTest* test = &round->latency[i];
+        test->timestamp = get_current_timestamp();
+
+        if (sampler->latency_targets[i] >= 0) {
+            const ProbeTarget* target = &sampler->latency_engine.targets[sampler->latency_targets[i]];
+            test->status = target->status;
+            test->latency = target->status == PROBE_OK ? target->last_ms : -1.0;
+            if (target->status == PROBE_OK) {
+                histogram_record(&sampler->latency_windows[sampler->latency_window][i], target->last_ms);
+            }
+        }
+
+        histogram_init(&merged);
+        for (int window = 0; window < SAMPLER_LATENCY_WINDOWS; window++) {
+            histogram_merge(&merged, &sampler->latency_windows[window][i]);
+        }
+        latency_test_percentiles(test, &merged);
+        histogram_cumulative(&merged, sampler_latency_bounds_ms, round->latency_buckets[i],
+                             SAMPLER_LATENCY_BOUNDS);
+        round->latency_sum_ms[i] = (double)merged.sum_us / 1000.0;
+        histogram_merge(&all, &merged);
+    }
+    round->latency_bins = histogram_distribution(&all, round->latency_distribution,
+                                                 SAMPLER_LATENCY_BINS, &round->latency_max_ms);
+    round->collected_ns = now;
+}
+
+static void* latency_main(void* arg) {
+    Sampler* sampler = arg;
+
+    sampler->latency_ready = open_latency(sampler) < 0 ? -1 : 1;
+    if (sampler->latency_ready < 0) {
+        return NULL;
+    }
+
+    while (!latency_stopping(sampler)) {
+        run_latency_round(sampler);
+
+        pthread_mutex_lock(&sampler->latency_lock);
+        sampler->latency_result = sampler->latency_round;
+        pthread_mutex_unlock(&sampler->latency_lock);
+
+        // Avisar al hilo de muestreo para que la publique sin esperar a su periodo
+        uint64_t one = 1;
+        ssize_t ignored = write(sampler->latency_fd, &one, sizeof(one));
+        (void)ignored;
+
+        // Esperar a la siguiente ronda o a sampler_stop
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += SAMPLER_LATENCY_PERIOD_MS / 1000;
+        deadline.tv_nsec += (long)(SAMPLER_LATENCY_PERIOD_MS % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&sampler->latency_lock);
+        while (!latency_stopping(sampler) &&
+               pthread_cond_timedwait(&sampler->latency_wake, &sampler->latency_lock, &deadline) != ETIMEDOUT) {
+        }
+        pthread_mutex_unlock(&sampler->latency_lock);
+    }
+    return NULL;
+}
+
+// ============================================================================
+// PUBLICACIÓN
+// ============================================================================
+
+// Una ranura que no está publicada ni marcada por el lector (siempre hay una de tres)
+static int free_slot(Sampler* sampler) {
+    int published = __atomic_load_n(&sampler->published, __ATOMIC_SEQ_CST);
+    int reading = __atomic_load_n(&sampler->reading, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < SAMPLER_SLOTS; i++) {
+        if (i != published && i != reading) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+static void publish(Sampler* sampler) {
+    Snapshot* current = &sampler->current;
+    int slot = free_slot(sampler);
+
+    current->sequence++;
+    for (int i = 0; i < SAMPLE_SECTIONS; i++) {
+        current->cost_ms[i] = (double)sampler->scheduler.collectors[i].last_cost_ns / 1e6;
+    }
+
+    memcpy(&sampler->slots[slot], current, sizeof(Snapshot));
+    __atomic_store_n(&sampler->published, slot, __ATOMIC_SEQ_CST);
+
+    // Despertar al lector que espera en poll (el contador acumula publicaciones)
+    uint64_t one = 1;
+    ssize_t ignored = write(sampler->publish_fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+// Armar el timerfd (una sola vez, en tiempo absoluto) para el siguiente recolector vencido
+static void arm_timer(Sampler* sampler) {
+    uint64_t due = scheduler_next_due(&sampler->scheduler);
+    struct itimerspec spec;
+
+    memset(&spec, 0, sizeof(spec));
+    if (due == 0) {
+        due = 1;   // 0 desarmaría el temporizador; cualquier instante pasado vence ya
+    }
+    spec.it_value.tv_sec = due / NS_PER_SECOND;
+    spec.it_value.tv_nsec = due % NS_PER_SECOND;
+    timerfd_settime(sampler->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+static void* sampler_main(void* arg) {
+    Sampler* sampler = arg;
+    struct pollfd fds[3] = {
+        { sampler->timer_fd, POLLIN, 0 },
+        { sampler->wake_fd, POLLIN, 0 },
+        { sampler->latency_fd, POLLIN, 0 },
+    };
+
+    // Cada recolector corre a su propio ritmo; el hilo solo despierta cuando vence alguno
+    while (!__atomic_load_n(&sampler->stopping, __ATOMIC_ACQUIRE)) {
+        uint64_t now = monotonic_ns();
+        uint64_t syscalls = proc_registry_shared()->syscalls;
+        int ran = __atomic_exchange_n(&sampler->refresh_requested, 0, __ATOMIC_ACQ_REL)
+                      ? scheduler_run_all(&sampler->scheduler, now)
+                      : scheduler_run_due(&sampler->scheduler, now);
+        if (ran > 0) {
+            sampler->current.proc_syscalls = proc_registry_shared()->syscalls - syscalls;
+            publish(sampler);
+        }
+
+        arm_timer(sampler);
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            ticker_wait(sampler->timer_fd);
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            ssize_t ignored = read(sampler->wake_fd, &value, sizeof(value));
+            (void)ignored;
+        }
+        if (fds[2].revents & POLLIN) {
+            uint64_t value;
+            ssize_t ignored = read(sampler->latency_fd, &value, sizeof(value));
+            (void)ignored;
+            scheduler_trigger(&sampler->scheduler, SAMPLE_LATENCY, monotonic_ns());
+        }
+    }
+
+    return NULL;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+int sampler_start(Sampler* sampler, int links_period_ms) {
+    memset(sampler, 0, sizeof(Sampler));
+    sampler->published = -1;
+    sampler->reading = -1;
+    if (links_period_ms < SAMPLER_MIN_PERIOD_MS) {
+        links_period_ms = SAMPLER_MIN_PERIOD_MS;
+    }
+
+    // Registrados en el orden de SAMPLE_*: el índice de cada recolector es su sección
+    scheduler_init(&sampler->scheduler);
+    scheduler_register(&sampler->scheduler, "interfaces", collect_interfaces, sampler,
+                       SAMPLER_INTERFACES_PERIOD_MS, SAMPLER_INTERFACES_BUDGET_MS);
+    scheduler_register(&sampler->scheduler, "enlaces", collect_links, sampler,
+                       links_period_ms, SAMPLER_LINKS_BUDGET_MS);
+    scheduler_register(&sampler->scheduler, "dirección", collect_address, sampler,
+                       SAMPLER_ADDRESS_PERIOD_MS, SAMPLER_ADDRESS_BUDGET_MS);
+    scheduler_register(&sampler->scheduler, "sockets", collect_sockets, sampler,
+                       SAMPLER_SOCKETS_PERIOD_MS, SAMPLER_SOCKETS_BUDGET_MS);
+    scheduler_register(&sampler->scheduler, "procesos", collect_processes, sampler,
+                       SAMPLER_PROCESSES_PERIOD_MS, SAMPLER_PROCESSES_BUDGET_MS);
+    scheduler_register(&sampler->scheduler, "latencia", collect_latency, sampler,
+                       SAMPLER_LATENCY_PERIOD_MS, SAMPLER_LATENCY_BUDGET_MS);
+
+    // Sin historial se sigue muestreando igual (p. ej. si otra instancia ya lo graba)
+    char history_path[512];
+    sampler->history_ready = tsdb_default_path(history_path, sizeof(history_path)) == 0 &&
+                             tsdb_open(&sampler->history, history_path, 1, TSDB_DEFAULT_BLOCKS) == 0;
+
+    // La espera entre rondas de latencia usa el mismo reloj que el resto (CLOCK_MONOTONIC)
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&sampler->latency_wake, &attributes);
+    pthread_condattr_destroy(&attributes);
+    pthread_mutex_init(&sampler->latency_lock, NULL);
+
+    sampler->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    sampler->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    sampler->publish_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    sampler->latency_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (sampler->timer_fd < 0 || sampler->wake_fd < 0 || sampler->publish_fd < 0 || sampler->latency_fd < 0 ||
+        pthread_create(&sampler->thread, NULL, sampler_main, sampler) != 0) {
+        ticker_close(sampler->timer_fd);
+        if (sampler->wake_fd >= 0) close(sampler->wake_fd);
+        if (sampler->publish_fd >= 0) close(sampler->publish_fd);
+        if (sampler->latency_fd >= 0) close(sampler->latency_fd);
+        if (sampler->history_ready) tsdb_close(&sampler->history);
+        pthread_mutex_destroy(&sampler->latency_lock);
+        pthread_cond_destroy(&sampler->latency_wake);
+        return -1;
+    }
+
+    // Sin hilo de latencia la sección se queda sin datos, pero el resto sigue
+    sampler->latency_started = pthread_create(&sampler->latency_thread, NULL, latency_main, sampler) == 0;
+
+    sampler->running = 1;
+    return 0;
+}
+
+static void wake_sampler(Sampler* sampler) {
+    uint64_t one = 1;
+    ssize_t ignored = write(sampler->wake_fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void sampler_stop(Sampler* sampler) {
+    if (!sampler->running) {
+        return;
+    }
+
+    __atomic_store_n(&sampler->stopping, 1, __ATOMIC_RELEASE);
+    wake_sampler(sampler);
+    pthread_mutex_lock(&sampler->latency_lock);
+    pthread_cond_signal(&sampler->latency_wake);
+    pthread_mutex_unlock(&sampler->latency_lock);
+    pthread_join(sampler->thread, NULL);
+
+    // Como mucho espera a la ronda en curso (SAMPLER_LATENCY_TIMEOUT_MS) o a la
+    // resolución del destino que se esté añadiendo
+    if (sampler->latency_started) {
+        pthread_join(sampler->latency_thread, NULL);
+    }
+
+    ticker_close(sampler->timer_fd);
+    close(sampler->wake_fd);
+    close(sampler->publish_fd);
+    close(sampler->latency_fd);
+    if (sampler->latency_ready > 0) {
+        probe_engine_free(&sampler->latency_engine);
+    }
+    pthread_mutex_destroy(&sampler->latency_lock);
+    pthread_cond_destroy(&sampler->latency_wake);
+    if (sampler->history_ready) {
+        tsdb_close(&sampler->history);
+    }
+    sampler->running = 0;
+}
+
+void sampler_refresh(Sampler* sampler) {
+    __atomic_store_n(&sampler->refresh_requested, 1, __ATOMIC_RELEASE);
+    wake_sampler(sampler);
+}
+
+int sampler_publish_fd(const Sampler* sampler) {
+    return sampler->publish_fd;
+}
+
+void sampler_drain(Sampler* sampler) {
+    uint64_t value;
+    ssize_t ignored = read(sampler->publish_fd, &value, sizeof(value));
+    (void)ignored;
+}
+
+// Marcar la ranura publicada y comprobar que sigue publicada: si el hilo de muestreo
+// publicó otra entre medias, la marca pudo llegar tarde y hay que repetir
+const Snapshot* sampler_acquire(Sampler* sampler) {
+    while (1) {
+        int slot = __atomic_load_n(&sampler->published, __ATOMIC_SEQ_CST);
+        if (slot < 0) {
+            return NULL;
+        }
+        __atomic_store_n(&sampler->reading, slot, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&sampler->published, __ATOMIC_SEQ_CST) == slot) {
+            return &sampler->slots[slot];
+        }
+    }
+}
+
+void sampler_release(Sampler* sampler) {
+    __atomic_store_n(&sampler->reading, -1, __ATOMIC_SEQ_CST);
+}
+
+double snapshot_age(const Snapshot* snapshot, int section) {
+    if (section < 0 || section >= SAMPLE_SECTIONS || snapshot->collected_ns[section] == 0) {
+        return -1.0;
+    }
+    return elapsed_seconds(snapshot->collected_ns[section], monotonic_ns());
+}
@@ -0,0 +1,100 @@
+#define _GNU_SOURCE
+#include "scheduler.h"
+#include "utils.h"
+#include <string.h>
+
+#define NS_PER_MS 1000000ULL
+
+void scheduler_init(Scheduler* scheduler) {
+    memset(scheduler, 0, sizeof(Scheduler));
+}
+
+int scheduler_register(Scheduler* scheduler, const char* name, CollectorFunction collect,
+                       void* context, int period_ms, int budget_ms) {
+    if (scheduler->count == SCHEDULER_MAX_COLLECTORS || period_ms <= 0) {
+        return -1;
+    }
+
+    ScheduledCollector* collector = &scheduler->collectors[scheduler->count];
+    memset(collector, 0, sizeof(ScheduledCollector));
+    collector->name = name;
+    collector->collect = collect;
+    collector->context = context;
+    collector->period_ns = (uint64_t)period_ms * NS_PER_MS;
+    collector->budget_ns = budget_ms > 0 ? (uint64_t)budget_ms * NS_PER_MS : 0;
+    collector->next_due_ns = 0;   // primera ejecución inmediata
+
+    return scheduler->count++;
+}
+
+// Periodo efectivo: si la última ejecución superó el presupuesto, espaciar en proporción
+static uint64_t effective_period(const ScheduledCollector* collector) {
+    if (collector->budget_ns == 0 || collector->last_cost_ns <= collector->budget_ns) {
+        return collector->period_ns;
+    }
+
+    uint64_t scale = (collector->last_cost_ns + collector->budget_ns - 1) / collector->budget_ns;
+    if (scale > SCHEDULER_MAX_BACKOFF) {
+        scale = SCHEDULER_MAX_BACKOFF;
+    }
+    return collector->period_ns * scale;
+}
+
+static void run_collector(ScheduledCollector* collector, uint64_t now_ns) {
+    uint64_t start = monotonic_ns();
+    int result = collector->collect(collector->context);
+    uint64_t end = monotonic_ns();
+
+    collector->last_cost_ns = end - start;
+    collector->total_cost_ns += collector->last_cost_ns;
+    collector->runs++;
+    if (result < 0) {
+        collector->failures++;
+    } else {
+        collector->last_run_ns = end;
+    }
+    if (collector->budget_ns > 0 && collector->last_cost_ns > collector->budget_ns) {
+        collector->over_budget++;
+    }
+
+    // Mantener la cadencia respecto al instante previsto; tras un retraso largo,
+    // reanudar desde ahora en lugar de encadenar ejecuciones atrasadas
+    uint64_t period = effective_period(collector);
+    uint64_t next = collector->next_due_ns + period;
+    collector->next_due_ns = next > now_ns ? next : now_ns + period;
+}
+
+int scheduler_run_due(Scheduler* scheduler, uint64_t now_ns) {
+    int ran = 0;
+    for (int i = 0; i < scheduler->count; i++) {
+        ScheduledCollector* collector = &scheduler->collectors[i];
+        if (collector->next_due_ns <= now_ns) {
+            run_collector(collector, now_ns);
+            ran++;
+        }
+    }
+    return ran;
+}
+
+int scheduler_run_all(Scheduler* scheduler, uint64_t now_ns) {
+    for (int i = 0; i < scheduler->count; i++) {
+        scheduler->collectors[i].next_due_ns = now_ns;
+    }
+    return scheduler_run_due(scheduler, now_ns);
+}
+
+void scheduler_trigger(Scheduler* scheduler, int index, uint64_t now_ns) {
+    if (index >= 0 && index < scheduler->count && scheduler->collectors[index].next_due_ns > now_ns) {
+        scheduler->collectors[index].next_due_ns = now_ns;
+    }
+}
+
+uint64_t scheduler_next_due(const Scheduler* scheduler) {
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < scheduler->count; i++) {
+        if (scheduler->collectors[i].next_due_ns < next) {
+            next = scheduler->collectors[i].next_due_ns;
+        }
+    }
+    return next;
+}
@@ -0,0 +1,176 @@
+#define _GNU_SOURCE
+#include "shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int shared_default_name(char* buffer, size_t size) {
+    const char* name = getenv("NX_SHM");
+    if (!name || !*name) {
+        name = SHARED_DEFAULT_NAME;
+    }
+    return snprintf(buffer, size, "%s%s", name[0] == '/' ? "" : "/", name) < (int)size ? 0 : -1;
+}
+
+static int fail(SharedSnapshot* shared, const char* what) {
+    snprintf(shared->error, sizeof(shared->error), "%s %.60s: %s", what, shared->name, strerror(errno));
+    if (shared->segment) munmap(shared->segment, sizeof(SharedSegment));
+    if (shared->fd >= 0) close(shared->fd);
+    shared->segment = NULL;
+    shared->fd = -1;
+    return -1;
+}
+
+static int open_segment(SharedSnapshot* shared, const char* name, int writable) {
+    memset(shared, 0, sizeof(SharedSnapshot));
+    shared->fd = -1;
+    shared->writable = writable;
+    snprintf(shared->name, sizeof(shared->name), "%s", name);
+
+    shared->fd = shm_open(name, writable ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+    if (shared->fd < 0) {
+        return fail(shared, writable ? "no se pudo crear" : "no hay daemon publicando en");
+    }
+    return 0;
+}
+
+int shared_create(SharedSnapshot* shared, const char* name) {
+    if (open_segment(shared, name, 1) < 0) {
+        return -1;
+    }
+
+    // Un solo daemon: el flock dura lo que el descriptor, así que una caída lo suelta
+    if (flock(shared->fd, LOCK_EX | LOCK_NB) < 0) {
+        if (errno == EWOULDBLOCK) errno = EBUSY;
+        return fail(shared, "ya hay un daemon publicando en");
+    }
+    if (ftruncate(shared->fd, sizeof(SharedSegment)) < 0) {
+        return fail(shared, "ftruncate");
+    }
+
+    shared->segment = mmap(NULL, sizeof(SharedSegment), PROT_READ | PROT_WRITE, MAP_SHARED, shared->fd, 0);
+    if (shared->segment == MAP_FAILED) {
+        shared->segment = NULL;
+        return fail(shared, "mmap");
+    }
+
+    // Reutilizar el segmento de un daemon caído: los visores que aún lo tienen
+    // proyectado siguen viendo muestras. La secuencia continúa (par) para que
+    // ninguno confunda la primera muestra nueva con la última que copió
+    SharedSegment* segment = shared->segment;
+    uint64_t sequence = segment->sequence;
+    if (memcmp(segment->magic, SHARED_MAGIC, 4) != 0 || segment->version != SHARED_VERSION ||
+        segment->size != sizeof(SharedSegment)) {
+        memset(segment, 0, sizeof(SharedSegment));
+        sequence = 0;
+    }
+    __atomic_store_n(&segment->sequence, (sequence + 1) & ~1ULL, __ATOMIC_RELEASE);
+    segment->pid = getpid();
+    segment->closed = 0;
+    segment->size = sizeof(SharedSegment);
+    segment->version = SHARED_VERSION;
+    memcpy(segment->magic, SHARED_MAGIC, 4);
+    return 0;
+}
+
+int shared_attach(SharedSnapshot* shared, const char* name) {
+    struct stat st;
+
+    if (open_segment(shared, name, 0) < 0) {
+        return -1;
+    }
+    if (fstat(shared->fd, &st) < 0) {
+        return fail(shared, "fstat");
+    }
+    if ((size_t)st.st_size != sizeof(SharedSegment)) {
+        errno = EINVAL;
+        return fail(shared, "tamaño no reconocido en");
+    }
+
+    shared->segment = mmap(NULL, sizeof(SharedSegment), PROT_READ, MAP_SHARED, shared->fd, 0);
+    if (shared->segment == MAP_FAILED) {
+        shared->segment = NULL;
+        return fail(shared, "mmap");
+    }
+    if (memcmp(shared->segment->magic, SHARED_MAGIC, 4) != 0 || shared->segment->version != SHARED_VERSION ||
+        shared->segment->size != sizeof(SharedSegment)) {
+        errno = EINVAL;
+        return fail(shared, "formato no reconocido en");
+    }
+    if (!shared_alive(shared)) {
+        errno = ESRCH;
+        return fail(shared, "el daemon terminó en");
+    }
+
+    // El descriptor ya no hace falta: la proyección se mantiene sola
+    close(shared->fd);
+    shared->fd = -1;
+    return 0;
+}
+
+void shared_close(SharedSnapshot* shared) {
+    if (shared->segment && shared->writable) {
+        __atomic_store_n(&shared->segment->closed, 1, __ATOMIC_RELEASE);
+        shm_unlink(shared->name);
+    }
+    if (shared->segment) {
+        munmap(shared->segment, sizeof(SharedSegment));
+    }
+    if (shared->fd >= 0) {
+        close(shared->fd);   // suelta también el flock del daemon
+    }
+    shared->segment = NULL;
+    shared->fd = -1;
+}
+
+// Escritor del seqlock: impar durante la copia, par al terminar. Los visores no
+// escriben nada en el segmento, así que su número no cambia el coste del daemon
+void shared_publish(SharedSnapshot* shared, const Snapshot* snapshot) {
+    SharedSegment* segment = shared->segment;
+    uint64_t sequence = segment->sequence;
+
+    __atomic_store_n(&segment->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&segment->snapshot, snapshot, sizeof(Snapshot));
+    __atomic_store_n(&segment->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// Lector del seqlock: copiar y comprobar que la secuencia no cambió entre medias
+int shared_read(SharedSnapshot* shared, Snapshot* snapshot) {
+    const SharedSegment* segment = shared->segment;
+
+    for (int attempt = 0; attempt < SHARED_READ_RETRIES; attempt++) {
+        uint64_t begin = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+        if (begin == shared->copied || begin == 0) {
+            return 0;
+        }
+        if (begin & 1) {
+            sched_yield();   // el daemon está copiando: tarda microsegundos
+            continue;
+        }
+
+        memcpy(snapshot, &segment->snapshot, sizeof(Snapshot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) == begin) {
+            shared->copied = begin;
+            return snapshot->sequence != 0;
+        }
+    }
+    return 0;
+}
+
+int shared_alive(const SharedSnapshot* shared) {
+    const SharedSegment* segment = shared->segment;
+    if (!segment || __atomic_load_n(&segment->closed, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    return kill(segment->pid, 0) == 0 || errno == EPERM;
+}
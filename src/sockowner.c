@@ -0,0 +1,391 @@
+#define _GNU_SOURCE
+#include "sockowner.h"
+#include "procnet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// ============================================================================
+// ESCANEO DE UN PID
+// ============================================================================
+
+static void push_inode(PidEntry* entry, uint64_t inode) {
+    if (entry->inode_count == entry->inode_capacity) {
+        int capacity = entry->inode_capacity > 0 ? entry->inode_capacity * 2 : 16;
+        uint64_t* inodes = realloc(entry->inodes, capacity * sizeof(uint64_t));
+        if (!inodes) return;
+        entry->inodes = inodes;
+        entry->inode_capacity = capacity;
+    }
+    entry->inodes[entry->inode_count++] = inode;
+}
+
+// Leer /proc/<pid>/comm
+static void read_comm(PidEntry* entry) {
+    char path[PROC_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/proc/%d/comm", proc_root(), entry->owner.pid);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    ssize_t bytes = fd >= 0 ? read(fd, entry->owner.comm, SOCK_OWNER_COMM_LEN - 1) : -1;
+    if (fd >= 0) close(fd);
+
+    if (bytes <= 0) {
+        snprintf(entry->owner.comm, SOCK_OWNER_COMM_LEN, "unknown");
+        return;
+    }
+    entry->owner.comm[bytes] = '\0';
+    entry->owner.comm[strcspn(entry->owner.comm, "\n")] = '\0';
+}
+
+// Recorrer /proc/<pid>/fd y guardar los inodos de los sockets
+static void scan_entry(PidEntry* entry) {
+    char path[PROC_PATH_MAX];
+    char link[64];
+
+    entry->inode_count = 0;
+
+    snprintf(path, sizeof(path), "%s/proc/%d/fd", proc_root(), entry->owner.pid);
+    int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        return;   // proceso terminado o sin permisos
+    }
+
+    DIR* dir = fdopendir(dir_fd);
+    if (!dir) {
+        close(dir_fd);
+        return;
+    }
+
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') {
+            continue;
+        }
+
+        ssize_t length = readlinkat(dir_fd, ent->d_name, link, sizeof(link) - 1);
+        if (length < 10 || memcmp(link, "socket:[", 8) != 0) {
+            continue;
+        }
+        link[length] = '\0';
+        push_inode(entry, strtoull(link + 8, NULL, 10));
+    }
+
+    closedir(dir);
+    read_comm(entry);
+}
+
+// Revisar una entrada: reescanear si es nueva o si cambió su número de fds
+static void check_entry(SocketOwnerIndex* index, PidEntry* entry) {
+    char path[PROC_PATH_MAX];
+    struct stat st;
+    long long signature = 0;
+
+    snprintf(path, sizeof(path), "%s/proc/%d/fd", proc_root(), entry->owner.pid);
+    if (stat(path, &st) == 0) {
+        signature = (long long)st.st_size;   // número de fds abiertos (Linux >= 6.2)
+    }
+
+    if (entry->needs_scan || index->full_scan || signature != entry->fd_signature) {
+        scan_entry(entry);
+        __atomic_fetch_add(&index->scanned_last, 1, __ATOMIC_RELAXED);
+    }
+
+    entry->fd_signature = signature;
+    entry->needs_scan = 0;
+}
+
+// ============================================================================
+// POOL DE HILOS
+// ============================================================================
+
+// Consumir entradas de la cola hasta vaciarla
+static void run_queue(SocketOwnerIndex* index) {
+    while (1) {
+        int i = __atomic_fetch_add(&index->queue_next, 1, __ATOMIC_RELAXED);
+        if (i >= index->queue_length) {
+            break;
+        }
+        check_entry(index, &index->entries[i]);
+    }
+}
+
+static void* worker_main(void* arg) {
+    SocketOwnerIndex* index = arg;
+    int seen_job = 0;
+
+    pthread_mutex_lock(&index->lock);
+    while (1) {
+        while (!index->stopping && index->job_id == seen_job) {
+            pthread_cond_wait(&index->work_ready, &index->lock);
+        }
+        if (index->stopping) {
+            break;
+        }
+
+        seen_job = index->job_id;
+        index->workers_busy++;
+        pthread_mutex_unlock(&index->lock);
+
+        run_queue(index);
+
+        pthread_mutex_lock(&index->lock);
+        if (--index->workers_busy == 0) {
+            pthread_cond_broadcast(&index->work_done);
+        }
+    }
+    pthread_mutex_unlock(&index->lock);
+
+    return NULL;
+}
+
+// Repartir todas las entradas entre los hilos y esperar a que terminen
+static void dispatch(SocketOwnerIndex* index) {
+    pthread_mutex_lock(&index->lock);
+    index->queue_length = index->entry_count;
+    index->queue_next = 0;
+    index->job_id++;
+    pthread_cond_broadcast(&index->work_ready);
+    pthread_mutex_unlock(&index->lock);
+
+    // El hilo llamador también trabaja
+    run_queue(index);
+
+    pthread_mutex_lock(&index->lock);
+    while (index->workers_busy > 0) {
+        pthread_cond_wait(&index->work_done, &index->lock);
+    }
+    pthread_mutex_unlock(&index->lock);
+}
+
+// ============================================================================
+// ÍNDICE INODO -> PROPIETARIO
+// ============================================================================
+
+static uint32_t hash_inode(uint64_t inode) {
+    inode ^= inode >> 33;
+    inode *= 0xff51afd7ed558ccdULL;
+    inode ^= inode >> 33;
+    return (uint32_t)inode;
+}
+
+// Reconstruir la tabla hash a partir de las entradas
+static void rebuild_slots(SocketOwnerIndex* index) {
+    int sockets = 0;
+    for (int i = 0; i < index->entry_count; i++) {
+        sockets += index->entries[i].inode_count;
+    }
+
+    int slot_count = 1024;
+    while (slot_count < sockets * 2) {
+        slot_count *= 2;
+    }
+
+    if (slot_count != index->slot_count) {
+        int* slots = realloc(index->slots, slot_count * sizeof(int));
+        uint64_t* keys = realloc(index->keys, slot_count * sizeof(uint64_t));
+        if (slots) index->slots = slots;
+        if (keys) index->keys = keys;
+        if (!slots || !keys) return;
+        index->slot_count = slot_count;
+    }
+    memset(index->slots, 0, index->slot_count * sizeof(int));
+
+    uint32_t mask = index->slot_count - 1;
+    for (int i = 0; i < index->entry_count; i++) {
+        PidEntry* entry = &index->entries[i];
+        for (int j = 0; j < entry->inode_count; j++) {
+            uint64_t inode = entry->inodes[j];
+            uint32_t slot = hash_inode(inode) & mask;
+            while (index->slots[slot] != 0 && index->keys[slot] != inode) {
+                slot = (slot + 1) & mask;
+            }
+            // Un socket heredado por fork se atribuye al primer PID que lo tiene
+            if (index->slots[slot] == 0) {
+                index->slots[slot] = i + 1;
+                index->keys[slot] = inode;
+            }
+        }
+    }
+
+    index->socket_count = sockets;
+}
+
+const SocketOwner* sock_owner_lookup(const SocketOwnerIndex* index, uint64_t inode) {
+    if (index->slot_count == 0 || inode == 0) {
+        return NULL;
+    }
+
+    uint32_t mask = index->slot_count - 1;
+    uint32_t slot = hash_inode(inode) & mask;
+    while (index->slots[slot] != 0) {
+        if (index->keys[slot] == inode) {
+            return &index->entries[index->slots[slot] - 1].owner;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+void sock_owner_resolve(const SocketOwnerIndex* index, Connection* connections, int count) {
+    for (int i = 0; i < count; i++) {
+        const SocketOwner* owner = sock_owner_lookup(index, connections[i].inode);
+        if (owner) {
+            connections[i].pid = owner->pid;
+            memcpy(connections[i].process, owner->comm, SOCK_OWNER_COMM_LEN);
+        } else {
+            connections[i].pid = 0;
+            connections[i].process[0] = '\0';
+        }
+    }
+}
+
+// ============================================================================
+// CICLO DE VIDA Y REFRESCO
+// ============================================================================
+
+int sock_owner_init(SocketOwnerIndex* index, int threads) {
+    memset(index, 0, sizeof(SocketOwnerIndex));
+
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SOCK_OWNER_MAX_THREADS) threads = SOCK_OWNER_MAX_THREADS;
+
+    pthread_mutex_init(&index->lock, NULL);
+    pthread_cond_init(&index->work_ready, NULL);
+    pthread_cond_init(&index->work_done, NULL);
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&index->threads[i], NULL, worker_main, index) != 0) {
+            break;
+        }
+        index->thread_count++;
+    }
+
+    return 0;
+}
+
+void sock_owner_free(SocketOwnerIndex* index) {
+    pthread_mutex_lock(&index->lock);
+    index->stopping = 1;
+    pthread_cond_broadcast(&index->work_ready);
+    pthread_mutex_unlock(&index->lock);
+
+    for (int i = 0; i < index->thread_count; i++) {
+        pthread_join(index->threads[i], NULL);
+    }
+
+    for (int i = 0; i < index->entry_count; i++) {
+        free(index->entries[i].inodes);
+    }
+    free(index->entries);
+    free(index->slots);
+    free(index->keys);
+
+    pthread_mutex_destroy(&index->lock);
+    pthread_cond_destroy(&index->work_ready);
+    pthread_cond_destroy(&index->work_done);
+    memset(index, 0, sizeof(SocketOwnerIndex));
+}
+
+void sock_owner_invalidate(SocketOwnerIndex* index) {
+    for (int i = 0; i < index->entry_count; i++) {
+        index->entries[i].needs_scan = 1;
+    }
+}
+
+static int compare_pids(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Listar los PIDs actuales ordenados
+static int* list_pids(int* count) {
+    char path[PROC_PATH_MAX];
+    DIR* dir = opendir(proc_path("/proc", path, sizeof(path)));
+    int capacity = 1024;
+    int* pids = malloc(capacity * sizeof(int));
+    struct dirent* entry;
+
+    *count = 0;
+    if (!dir || !pids) {
+        if (dir) closedir(dir);
+        free(pids);
+        return NULL;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') {
+            continue;
+        }
+        if (*count == capacity) {
+            int* grown = realloc(pids, capacity * 2 * sizeof(int));
+            if (!grown) break;
+            pids = grown;
+            capacity *= 2;
+        }
+        pids[(*count)++] = atoi(entry->d_name);
+    }
+
+    closedir(dir);
+    qsort(pids, *count, sizeof(int), compare_pids);
+    return pids;
+}
+
+int sock_owner_refresh(SocketOwnerIndex* index) {
+    int pid_count;
+    int* pids = list_pids(&pid_count);
+    if (!pids) {
+        return -1;
+    }
+
+    PidEntry* entries = malloc((pid_count > 0 ? pid_count : 1) * sizeof(PidEntry));
+    if (!entries) {
+        free(pids);
+        return -1;
+    }
+
+    // Fusionar la lista anterior (ordenada) con la nueva conservando lo ya escaneado
+    int old = 0;
+    int removed = 0;
+    for (int i = 0; i < pid_count; i++) {
+        while (old < index->entry_count && index->entries[old].owner.pid < pids[i]) {
+            free(index->entries[old++].inodes);   // proceso terminado
+            removed++;
+        }
+
+        if (old < index->entry_count && index->entries[old].owner.pid == pids[i]) {
+            entries[i] = index->entries[old++];
+        } else {
+            memset(&entries[i], 0, sizeof(PidEntry));
+            entries[i].owner.pid = pids[i];
+            entries[i].needs_scan = 1;
+        }
+    }
+    while (old < index->entry_count) {
+        free(index->entries[old++].inodes);
+        removed++;
+    }
+
+    free(index->entries);
+    free(pids);
+    index->entries = entries;
+    index->entry_count = pid_count;
+    index->entry_capacity = pid_count;
+
+    index->full_scan = (index->refreshes % SOCK_OWNER_FULL_EVERY) == 0;
+    index->scanned_last = 0;
+    dispatch(index);
+    index->refreshes++;
+
+    if (index->scanned_last > 0 || removed > 0 || index->slot_count == 0) {
+        rebuild_slots(index);
+    }
+
+    return index->socket_count;
+}
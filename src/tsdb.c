@@ -0,0 +1,483 @@
+#define _GNU_SOURCE
+#include "tsdb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TSDB_DATA_BITS ((uint32_t)(TSDB_BLOCK_DATA * 8))
+
+// Peor caso de una muestra: delta de deltas de 32 bits y dos XOR con ventana nueva
+#define TSDB_MAX_SAMPLE_BITS (4 + 32 + 2 * (2 + 5 + 6 + 64))
+
+// Muestras que caben como mucho en un bloque (3 bits por muestra repetida)
+#define TSDB_MAX_BLOCK_SAMPLES (1 + (TSDB_DATA_BITS - 128) / 3)
+
+// ============================================================================
+// BITS
+// ============================================================================
+
+// Escribir los count bits bajos de value, del más significativo al menos; los
+// bytes del bloque se ponen a cero al abrirlo
+static void put_bits(uint8_t* data, uint32_t* position, uint64_t value, int count) {
+    while (count > 0) {
+        int offset = *position & 7;
+        int take = 8 - offset < count ? 8 - offset : count;
+        uint8_t chunk = (uint8_t)((value >> (count - take)) & ((1u << take) - 1));
+        data[*position >> 3] |= (uint8_t)(chunk << (8 - offset - take));
+        *position += take;
+        count -= take;
+    }
+}
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t position;
+    int overflow;               // se pidió leer más allá del bloque
+} BitReader;
+
+static uint64_t get_bits(BitReader* reader, int count) {
+    uint64_t value = 0;
+
+    if (reader->position + count > TSDB_DATA_BITS) {
+        reader->overflow = 1;
+        return 0;
+    }
+    while (count > 0) {
+        int offset = reader->position & 7;
+        int take = 8 - offset < count ? 8 - offset : count;
+        uint8_t byte = reader->data[reader->position >> 3];
+        value = (value << take) | ((byte >> (8 - offset - take)) & ((1u << take) - 1));
+        reader->position += take;
+        count -= take;
+    }
+    return value;
+}
+
+// ============================================================================
+// CODIFICACIÓN (marcas de tiempo con delta de deltas, valores con XOR)
+// ============================================================================
+
+static void encode_timestamp(uint8_t* data, uint32_t* position, int64_t dod) {
+    if (dod == 0) {
+        put_bits(data, position, 0x0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        put_bits(data, position, 0x2, 2);
+        put_bits(data, position, (uint64_t)(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        put_bits(data, position, 0x6, 3);
+        put_bits(data, position, (uint64_t)(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        put_bits(data, position, 0xe, 4);
+        put_bits(data, position, (uint64_t)(dod + 2047), 12);
+    } else {
+        put_bits(data, position, 0xf, 4);
+        put_bits(data, position, (uint32_t)(int32_t)dod, 32);
+    }
+}
+
+static int64_t decode_timestamp(BitReader* reader) {
+    if (get_bits(reader, 1) == 0) return 0;
+    if (get_bits(reader, 1) == 0) return (int64_t)get_bits(reader, 7) - 63;
+    if (get_bits(reader, 1) == 0) return (int64_t)get_bits(reader, 9) - 255;
+    if (get_bits(reader, 1) == 0) return (int64_t)get_bits(reader, 12) - 2047;
+    return (int32_t)(uint32_t)get_bits(reader, 32);
+}
+
+// '0' si no cambió; '10' + bits dentro de la ventana anterior; '11' + 5 bits de ceros
+// iniciales + 6 bits de longitud - 1 + bits significativos si la ventana no vale
+static void encode_value(uint8_t* data, uint32_t* position, uint64_t x, int* leading, int* trailing) {
+    if (x == 0) {
+        put_bits(data, position, 0x0, 1);
+        return;
+    }
+
+    int lead = __builtin_clzll(x);
+    int trail = __builtin_ctzll(x);
+    if (lead > 31) lead = 31;
+
+    if (*leading >= 0 && lead >= *leading && trail >= *trailing) {
+        put_bits(data, position, 0x2, 2);
+        put_bits(data, position, x >> *trailing, 64 - *leading - *trailing);
+        return;
+    }
+
+    int significant = 64 - lead - trail;
+    put_bits(data, position, 0x3, 2);
+    put_bits(data, position, (uint64_t)lead, 5);
+    put_bits(data, position, (uint64_t)(significant - 1), 6);
+    put_bits(data, position, x >> trail, significant);
+    *leading = lead;
+    *trailing = trail;
+}
+
+static uint64_t decode_value(BitReader* reader, int* leading, int* trailing) {
+    if (get_bits(reader, 1) == 0) {
+        return 0;
+    }
+    if (get_bits(reader, 1) == 1) {
+        *leading = (int)get_bits(reader, 5);
+        int significant = (int)get_bits(reader, 6) + 1;
+        *trailing = 64 - *leading - significant;
+        if (*trailing < 0) {
+            reader->overflow = 1;   // bloque corrupto o a medio reciclar
+            return 0;
+        }
+    }
+    return get_bits(reader, 64 - *leading - *trailing) << *trailing;
+}
+
+// ============================================================================
+// FICHERO
+// ============================================================================
+
+int tsdb_default_path(char* buffer, size_t size) {
+    const char* path = getenv("NX_HISTORY");
+    if (path && *path) {
+        return snprintf(buffer, size, "%s", path) < (int)size ? 0 : -1;
+    }
+
+    const char* home = getenv("HOME");
+    if (!home || !*home) {
+        return -1;
+    }
+    return snprintf(buffer, size, "%s/%s", home, TSDB_DEFAULT_FILE) < (int)size ? 0 : -1;
+}
+
+static int fail(Tsdb* db, const char* path, const char* what) {
+    snprintf(db->error, sizeof(db->error), "%s %.200s: %s", what, path, strerror(errno));
+    if (db->fd >= 0) close(db->fd);
+    db->fd = -1;
+    return -1;
+}
+
+int tsdb_open(Tsdb* db, const char* path, int writable, int blocks) {
+    struct stat st;
+
+    memset(db, 0, sizeof(Tsdb));
+    db->writable = writable;
+    db->fd = open(path, writable ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+    if (db->fd < 0) {
+        return fail(db, path, "no se pudo abrir");
+    }
+
+    // Un solo escritor: otro proceso que ya graba el historial se queda con él
+    if (writable && flock(db->fd, LOCK_EX | LOCK_NB) < 0) {
+        if (errno == EWOULDBLOCK) errno = EBUSY;
+        return fail(db, path, "otro proceso está grabando");
+    }
+
+    if (fstat(db->fd, &st) < 0) {
+        return fail(db, path, "fstat");
+    }
+    int created = st.st_size == 0;
+    if (created) {
+        if (!writable) {
+            errno = ENODATA;
+            return fail(db, path, "historial vacío");
+        }
+        if (blocks < 1) blocks = TSDB_DEFAULT_BLOCKS;
+        st.st_size = (off_t)TSDB_BLOCK_SIZE * (blocks + 1);
+        if (ftruncate(db->fd, st.st_size) < 0) {
+            return fail(db, path, "ftruncate");
+        }
+    }
+
+    db->size = (size_t)st.st_size;
+    db->base = mmap(NULL, db->size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, db->fd, 0);
+    if (db->base == MAP_FAILED) {
+        db->base = NULL;
+        return fail(db, path, "mmap");
+    }
+    db->header = (TsdbFileHeader*)db->base;
+    db->blocks = (TsdbBlock*)(db->base + TSDB_BLOCK_SIZE);
+
+    if (created) {
+        memcpy(db->header->magic, TSDB_MAGIC, 4);
+        db->header->version = TSDB_VERSION;
+        db->header->block_size = TSDB_BLOCK_SIZE;
+        db->header->block_count = (uint32_t)blocks;
+    }
+
+    if (memcmp(db->header->magic, TSDB_MAGIC, 4) != 0 || db->header->version != TSDB_VERSION ||
+        db->header->block_size != TSDB_BLOCK_SIZE || db->header->block_count == 0 ||
+        db->header->next_block >= db->header->block_count ||
+        (uint64_t)TSDB_BLOCK_SIZE * (db->header->block_count + 1) > db->size) {
+        munmap(db->base, db->size);
+        db->base = NULL;
+        errno = EINVAL;
+        return fail(db, path, "formato no reconocido en");
+    }
+
+    for (int i = 0; i < TSDB_MAX_SERIES; i++) {
+        db->series[i].block = -1;
+    }
+    return 0;
+}
+
+void tsdb_close(Tsdb* db) {
+    if (db->base) {
+        munmap(db->base, db->size);
+    }
+    if (db->fd >= 0) {
+        close(db->fd);   // suelta también el flock del escritor
+    }
+    memset(db, 0, sizeof(Tsdb));
+    db->fd = -1;
+}
+
+// ============================================================================
+// ESCRITURA
+// ============================================================================
+
+// Serie del escritor con ese nombre; la crea si no existe
+static TsdbSeries* find_series(Tsdb* db, const char* name) {
+    for (int i = 0; i < db->series_count; i++) {
+        if (strcmp(db->series[i].series, name) == 0) {
+            return &db->series[i];
+        }
+    }
+
+    // Tabla llena: se cierra la serie que lleva más tiempo sin muestras (p. ej. una
+    // interfaz que desapareció). Sus bloques siguen en el anillo; si vuelve, abre otro
+    TsdbSeries* series;
+    if (db->series_count == TSDB_MAX_SERIES) {
+        series = &db->series[0];
+        for (int i = 1; i < db->series_count; i++) {
+            if (db->series[i].last_ms < series->last_ms) {
+                series = &db->series[i];
+            }
+        }
+    } else {
+        series = &db->series[db->series_count++];
+    }
+    memset(series, 0, sizeof(TsdbSeries));
+    snprintf(series->series, sizeof(series->series), "%s", name);
+    series->block = -1;
+    return series;
+}
+
+// Reciclar el bloque más antiguo del anillo y escribir en él la primera muestra sin comprimir
+static void open_block(Tsdb* db, TsdbSeries* series, const TsdbSample* sample) {
+    uint32_t index = db->header->next_block;
+    TsdbBlock* block = &db->blocks[index];
+    db->header->next_block = (index + 1) % db->header->block_count;
+
+    // Otra serie podía seguir escribiendo en él si el anillo es muy pequeño
+    for (int i = 0; i < db->series_count; i++) {
+        if (db->series[i].block == (int)index) {
+            db->series[i].block = -1;
+        }
+    }
+
+    // Secuencia a 0 primero: un lector que lo esté recorriendo descartará lo leído
+    // (la barrera impide que las escrituras de abajo se adelanten a ese 0)
+    __atomic_store_n(&block->header.sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memset(block->data, 0, sizeof(block->data));
+    memcpy(block->header.series, series->series, MAX_INTERFACE_NAME);
+    block->header.first_ms = sample->timestamp_ms;
+    block->header.last_ms = sample->timestamp_ms;
+
+    uint32_t position = 0;
+    put_bits(block->data, &position, sample->rx_bytes, 64);
+    put_bits(block->data, &position, sample->tx_bytes, 64);
+    block->header.bits = position;
+    block->header.count = 1;
+    __atomic_store_n(&block->header.sequence, ++db->header->sequence, __ATOMIC_RELEASE);
+
+    series->block = (int)index;
+    series->last_ms = sample->timestamp_ms;
+    series->last_delta = 0;
+    series->last_values[0] = sample->rx_bytes;
+    series->last_values[1] = sample->tx_bytes;
+    series->leading[0] = series->leading[1] = -1;
+    series->trailing[0] = series->trailing[1] = 0;
+}
+
+int tsdb_append(Tsdb* db, const char* name, const TsdbSample* sample) {
+    if (!db->writable) {
+        snprintf(db->error, sizeof(db->error), "historial abierto solo para lectura");
+        return -1;
+    }
+
+    TsdbSeries* series = find_series(db, name);
+
+    TsdbBlock* block = series->block >= 0 ? &db->blocks[series->block] : NULL;
+    int64_t delta = (int64_t)(sample->timestamp_ms - series->last_ms);
+    int64_t dod = delta - series->last_delta;
+
+    // Bloque nuevo si no hay, si no cabe el peor caso o si el tiempo retrocede o salta demasiado
+    if (!block || sample->timestamp_ms < series->last_ms || dod > INT32_MAX || dod < INT32_MIN ||
+        block->header.bits + TSDB_MAX_SAMPLE_BITS > TSDB_DATA_BITS) {
+        open_block(db, series, sample);
+        return 0;
+    }
+
+    uint32_t position = block->header.bits;
+    encode_timestamp(block->data, &position, dod);
+    const uint64_t values[2] = { sample->rx_bytes, sample->tx_bytes };
+    for (int i = 0; i < 2; i++) {
+        encode_value(block->data, &position, values[i] ^ series->last_values[i],
+                     &series->leading[i], &series->trailing[i]);
+        series->last_values[i] = values[i];
+    }
+    series->last_delta = delta;
+    series->last_ms = sample->timestamp_ms;
+
+    // La cuenta se publica la última: el lector nunca decodifica bits a medio escribir
+    block->header.bits = position;
+    block->header.last_ms = sample->timestamp_ms;
+    __atomic_store_n(&block->header.count, block->header.count + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// ============================================================================
+// LECTURA
+// ============================================================================
+
+typedef struct {
+    uint64_t sequence;
+    uint32_t index;
+} BlockRef;
+
+static int compare_blocks(const void* a, const void* b) {
+    uint64_t x = ((const BlockRef*)a)->sequence;
+    uint64_t y = ((const BlockRef*)b)->sequence;
+    return x < y ? -1 : x > y;
+}
+
+// Decodificar las count primeras muestras de un bloque; -1 si los bits no cuadran
+static int decode_block(const TsdbBlock* block, uint32_t count, TsdbSample* samples) {
+    BitReader reader = { block->data, 0, 0 };
+    int leading[2] = { -1, -1 };
+    int trailing[2] = { 0, 0 };
+    int64_t delta = 0;
+
+    if (count == 0 || count > TSDB_MAX_BLOCK_SAMPLES) {
+        return -1;
+    }
+
+    samples[0].timestamp_ms = block->header.first_ms;
+    samples[0].rx_bytes = get_bits(&reader, 64);
+    samples[0].tx_bytes = get_bits(&reader, 64);
+
+    for (uint32_t i = 1; i < count && !reader.overflow; i++) {
+        delta += decode_timestamp(&reader);
+        samples[i].timestamp_ms = samples[i - 1].timestamp_ms + delta;
+        samples[i].rx_bytes = samples[i - 1].rx_bytes ^ decode_value(&reader, &leading[0], &trailing[0]);
+        samples[i].tx_bytes = samples[i - 1].tx_bytes ^ decode_value(&reader, &leading[1], &trailing[1]);
+    }
+    return reader.overflow ? -1 : 0;
+}
+
+int tsdb_scan(Tsdb* db, const char* name, uint64_t from_ms, uint64_t to_ms,
+              TsdbVisitor visit, void* context) {
+    uint32_t block_count = db->header->block_count;
+    BlockRef* refs = malloc(block_count * sizeof(BlockRef));
+    TsdbSample* samples = malloc(TSDB_MAX_BLOCK_SAMPLES * sizeof(TsdbSample));
+    int refs_count = 0;
+    int visited = 0;
+
+    if (!refs || !samples) {
+        free(refs);
+        free(samples);
+        return -1;
+    }
+
+    // Solo las cabeceras: los bloques de otras series o fuera del rango no se tocan
+    for (uint32_t i = 0; i < block_count; i++) {
+        const TsdbBlockHeader* header = &db->blocks[i].header;
+        uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (sequence == 0 || header->first_ms > to_ms || header->last_ms < from_ms ||
+            strncmp(header->series, name, MAX_INTERFACE_NAME) != 0) {
+            continue;
+        }
+        refs[refs_count].sequence = sequence;
+        refs[refs_count].index = i;
+        refs_count++;
+    }
+    qsort(refs, refs_count, sizeof(BlockRef), compare_blocks);
+
+    for (int i = 0; i < refs_count; i++) {
+        const TsdbBlock* block = &db->blocks[refs[i].index];
+        uint32_t count = __atomic_load_n(&block->header.count, __ATOMIC_ACQUIRE);
+        int result = decode_block(block, count, samples);
+
+        // Si el escritor lo recicló mientras tanto, lo leído no vale. La barrera ordena
+        // las lecturas del bloque antes de volver a leer la secuencia
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (result < 0 || __atomic_load_n(&block->header.sequence, __ATOMIC_RELAXED) != refs[i].sequence) {
+            continue;
+        }
+        for (uint32_t j = 0; j < count; j++) {
+            if (samples[j].timestamp_ms >= from_ms && samples[j].timestamp_ms <= to_ms) {
+                visit(&samples[j], context);
+                visited++;
+            }
+        }
+    }
+
+    free(refs);
+    free(samples);
+    return visited;
+}
+
+// ============================================================================
+// TIEMPO
+// ============================================================================
+
+uint64_t tsdb_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+int tsdb_parse_time(const char* text, uint64_t now_ms, uint64_t* result_ms) {
+    static const char* formats[] = { "%Y-%m-%d %H:%M:%S", "%Y-%m-%dT%H:%M:%S", "%Y-%m-%d %H:%M",
+                                     "%Y-%m-%dT%H:%M", "%Y-%m-%d" };
+    char* end;
+
+    if (strcmp(text, "now") == 0) {
+        *result_ms = now_ms;
+        return 0;
+    }
+
+    // Relativo: -30s, -15m, -2h, -1d
+    if (text[0] == '-') {
+        unsigned long amount = strtoul(text + 1, &end, 10);
+        uint64_t unit = *end == 's' ? 1000ULL : *end == 'm' ? 60000ULL :
+                        *end == 'h' ? 3600000ULL : *end == 'd' ? 86400000ULL : 0;
+        if (end == text + 1 || unit == 0 || end[1] != '\0' || amount * unit > now_ms) {
+            return -1;
+        }
+        *result_ms = now_ms - amount * unit;
+        return 0;
+    }
+
+    // Segundos Unix
+    unsigned long long seconds = strtoull(text, &end, 10);
+    if (end != text && *end == '\0') {
+        *result_ms = seconds * 1000ULL;
+        return 0;
+    }
+
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        end = strptime(text, formats[i], &tm);
+        if (end && *end == '\0') {
+            tm.tm_isdst = -1;
+            time_t t = mktime(&tm);
+            if (t < 0) return -1;
+            *result_ms = (uint64_t)t * 1000ULL;
+            return 0;
+        }
+    }
+    return -1;
+}
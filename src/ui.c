@@ -1,23 +1,58 @@
+#define _GNU_SOURCE
 #include "ui.h"
 #include "collector.h"
 #include "renderer.h"
+#include "sampler.h"
+#include "rollup.h"
+#include "shared.h"
 #include <ncurses.h>
 #include <string.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
 
-// Variables globales para datos
-static NetworkStats current_stats = {0};
-static NetworkStats previous_stats = {0};
-static char* current_interface = NULL;
-static int connections_count = 0;
-static int processes_count = 0;
+// Datos: el hilo de muestreo recolecta y la TUI solo lee la última muestra publicada.
+// Con `nx daemon` en marcha no hay hilo propio: se copia la muestra del daemon
+static Sampler sampler;
+static SharedSnapshot shared;
+static Snapshot shared_copy;
+static int attached = 0;
+static const Snapshot* snapshot = NULL;     // válida durante un fotograma
+static uint64_t graphed_ns = 0;             // lectura de contadores ya añadida al gráfico
+static double frame_ms = 0.0;               // tiempo del último fotograma
 
-// Variables globales para gráficos
-static GraphData bandwidth_graph;
+// Estado de dibujo por sección: huella de los valores que mostró la última vez. El
+// marco (cajas, cabeceras, pie) se dibuja una vez y otra tras cambiar de tamaño
+#define UI_GRAPH 0
+#define UI_INFO 1
+#define UI_CONNECTIONS 2
+#define UI_INTERFACES 3
+#define UI_LATENCY 4
+#define UI_STATUS 5
+#define UI_SECTIONS 6
+#define HASH_SEED 14695981039346656037ULL
+static uint64_t drawn_hash[UI_SECTIONS];
+static int drawn_valid[UI_SECTIONS];
+static int sections_drawn = 0;              // secciones redibujadas en el fotograma
+
+// Variables globales para gráficos: agregados de 1 s a 1 h y nivel mostrado
+static Rollup bandwidth_rollup;
+static int graph_tier = 0;
 static TableData connections_table;
 static int graph_initialized = 0;
 
+// El panel de latencia comparte fila con las interfaces si la terminal es ancha
+#define LATENCY_MIN_COLS 100
+#define LATENCY_HISTOGRAM_MIN_LINES 44
+#define CONNECTION_ROWS 5
+
 // Inicializar ncurses
 void init_ui(void) {
     initscr();              // Inicializar pantalla
@@ -35,8 +70,7 @@ void init_ui(void) {
     setup_colors();
     
     // Inicializar gráficos
-    init_bandwidth_graph(&bandwidth_graph, "Ancho de Banda");
-    bandwidth_graph.max_values = 200; // Aumentar capacidad para más datos
+    rollup_init(&bandwidth_rollup);
     init_connections_table(&connections_table);
     graph_initialized = 1;
 }
@@ -50,6 +84,10 @@ void setup_colors(void) {
         init_pair(COLOR_ERROR, COLOR_RED, COLOR_BLACK);
         init_pair(COLOR_SUCCESS, COLOR_GREEN, COLOR_BLACK);
         init_pair(COLOR_INFO, COLOR_CYAN, COLOR_BLACK);
+        
+        // Fondo con el par normal: volver de un color al texto normal es un cambio de
+        // par y no un reinicio completo de atributos (menos bytes por celda coloreada)
+        bkgdset(COLOR_PAIR(COLOR_NORMAL));
     }
 }
 
@@ -156,7 +194,7 @@ void draw_footer(void) {
     attron(COLOR_PAIR(COLOR_INFO));
     
     // Calcular posición centrada para los comandos
-    const char* commands = "[Q] Salir  [R] Actualizar  [1] Ancho de banda  [2] Conexiones  [3] Interfaces";
+    const char* commands = "[Q] Salir  [R] Actualizar  [+/-] Zoom  [1] Ancho  [2] Conexiones  [3] Interfaces";
     int commands_len = strlen(commands);
     int start_x = (COLS - commands_len) / 2;
     
@@ -168,217 +206,255 @@ void draw_footer(void) {
     attroff(COLOR_PAIR(COLOR_INFO));
 }
 
+// Huella FNV-1a de los valores que muestra una sección
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Decidir si una sección se redibuja: solo si cambió lo que mostró la última vez
+static int section_dirty(int section, uint64_t hash) {
+    if (drawn_valid[section] && drawn_hash[section] == hash) {
+        return 0;
+    }
+    drawn_hash[section] = hash;
+    drawn_valid[section] = 1;
+    sections_drawn++;
+    return 1;
+}
+
+// Borrar el contenido de una zona sin tocar el marco que la rodea
+static void clear_area(int y, int x, int height, int width) {
+    for (int i = 0; i < height; i++) {
+        mvhline(y + i, x, ' ', width);
+    }
+}
+
+// Marco estático: cabecera, pie, cajas y cabeceras de tabla. Se dibuja en el primer
+// fotograma y al cambiar el tamaño de la terminal; invalida todas las secciones
+void draw_chrome(void) {
+    werase(stdscr);
+    draw_header();
+    draw_footer();
+
+    attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
+    mvprintw(1, 2, "=== MONITOREO DE RED ===");
+    attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
+
+    draw_box(2, 2, 8, COLS - 4, "Ancho de Banda en Tiempo Real");
+    draw_box(11, 2, 7, COLS - 4, "Información de Interfaz");
+    draw_box(18, 2, 10, COLS - 4, "Conexiones Activas");
+
+    // Headers de la tabla
+    attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
+    mvprintw(19, 4, "Puerto");
+    mvprintw(19, 12, "Estado");
+    mvprintw(19, 25, "Proceso");
+    mvprintw(19, 42, "IP Remota");
+    mvprintw(19, 66, "PID");
+    attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
+
+    // Línea separadora
+    for (int i = 4; i < COLS - 6; i++) {
+        mvaddch(20, i, '-');
+    }
+
+    int iface_width = COLS >= LATENCY_MIN_COLS ? COLS / 2 - 3 : COLS - 4;
+    draw_box(28, 2, 7, iface_width, "Interfaces de Red");
+
+    memset(drawn_valid, 0, sizeof(drawn_valid));
+}
+
 // Dibujar sección de ancho de banda
 void draw_bandwidth_section(void) {
-    // Obtener interfaz si no está definida
-    if (!current_interface) {
-        int interface_count;
-        char** interfaces = get_available_interfaces(&interface_count);
-        if (interfaces && interface_count > 0) {
-            for (int i = 0; i < interface_count; i++) {
-                if (is_interface_active(interfaces[i])) {
-                    current_interface = malloc(strlen(interfaces[i]) + 1);
-                    strcpy(current_interface, interfaces[i]);
-                    break;
-                }
-            }
-            // Liberar memoria
-            for (int i = 0; i < interface_count; i++) {
-                free(interfaces[i]);
-            }
-            free(interfaces);
+    int graph_width = COLS - 4; // Todo el ancho menos los bordes
+
+    if (!snapshot) {
+        if (section_dirty(UI_GRAPH, 0)) {
+            mvprintw(3, 4, "Recopilando datos...");
         }
+        return;
     }
-    
-    if (current_interface) {
-        // Obtener estadísticas actuales
-        previous_stats = current_stats;
-        current_stats = collect_network_stats(current_interface);
-        
-        // Calcular velocidades si tenemos datos previos
-        if (previous_stats.timestamp > 0) {
-            double time_diff = 1.0; // Asumimos 1 segundo entre actualizaciones
-            calculate_speeds(&current_stats, &previous_stats, time_diff);
-            
-            // Agregar datos al gráfico
-            if (graph_initialized) {
-                add_bandwidth_data(&bandwidth_graph, current_stats.total_speed);
+
+    if (!snapshot->has_interface) {
+        if (section_dirty(UI_GRAPH, 1)) {
+            clear_area(3, 3, 6, graph_width - 2);
+            mvprintw(3, 4, "No se encontró interfaz activa");
+        }
+        if (section_dirty(UI_INFO, 1)) {
+            clear_area(12, 3, 5, graph_width - 2);
+        }
+        return;
+    }
+
+    const NetworkStats* current_stats = &snapshot->stats;
+
+    // Agregar cada lectura de contadores al gráfico una sola vez (las muestras
+    // también se publican cuando solo cambian otras secciones)
+    if (graph_initialized && snapshot->has_speeds && current_stats->timestamp_ns != graphed_ns) {
+        rollup_add(&bandwidth_rollup, current_stats->timestamp_ns, current_stats->total_speed);
+    }
+    graphed_ns = current_stats->timestamp_ns;
+
+    // ========================================
+    // SECCIÓN SUPERIOR: GRÁFICOS
+    // ========================================
+
+    // El gráfico solo cambia con una muestra nueva o con el zoom
+    uint64_t hash = hash_bytes(HASH_SEED, &bandwidth_rollup.samples, sizeof(bandwidth_rollup.samples));
+    hash = hash_bytes(hash, &graph_tier, sizeof(graph_tier));
+    if (graph_initialized && section_dirty(UI_GRAPH, hash)) {
+        clear_area(3, 3, 6, graph_width - 2);
+
+        // Una columna por cubo del nivel elegido, el más reciente a la derecha
+        int bars_width = graph_width - 4; // Ancho menos los bordes internos
+        int graph_height = 4;
+        if (bars_width > ROLLUP_SLOTS) bars_width = ROLLUP_SLOTS;
+
+        // Escala: máximo de la ventana visible (baja cuando el pico sale de pantalla)
+        double max_speed = rollup_window_max(&bandwidth_rollup, graph_tier, bars_width);
+        if (max_speed <= 0) max_speed = 1.0;
+
+        // Dibujar barras del gráfico (media del cubo; '.' marca su máximo)
+        for (int i = 0; i < bars_width; i++) {
+            const RollupBucket* bucket = rollup_bucket(&bandwidth_rollup, graph_tier, bars_width - 1 - i);
+            if (!bucket || bucket->count == 0) {
+                continue;
             }
-        } else {
-            // Si no hay datos previos, agregar algunos datos de ejemplo para que se vea el gráfico
-            if (graph_initialized) {
-                add_bandwidth_data(&bandwidth_graph, 2.5); // 2.5 MB/s de ejemplo
-                add_bandwidth_data(&bandwidth_graph, 1.8);
-                add_bandwidth_data(&bandwidth_graph, 3.2);
-                add_bandwidth_data(&bandwidth_graph, 2.1);
-                add_bandwidth_data(&bandwidth_graph, 4.0);
+            double value = bucket->sum / bucket->count;
+
+            if (graph_tier > 0 && bucket->max > value) {
+                int peak_height = (int)((bucket->max / max_speed) * graph_height);
+                if (peak_height > graph_height) peak_height = graph_height;
+                if (peak_height > 0) mvaddch(7 - peak_height, 4 + i, '.');
             }
-        }
-        
-        // ========================================
-        // SECCIÓN SUPERIOR: GRÁFICOS
-        // ========================================
-        
-        // Título de la sección
-        attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-        mvprintw(1, 2, "=== MONITOREO DE RED ===");
-        attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-        
-        // Gráfico de ancho de banda (lado izquierdo)
-        if (graph_initialized) {
-            // Dibujar caja del gráfico usando todo el ancho disponible
-            int graph_width = COLS - 4; // Todo el ancho menos los bordes
-            draw_box(2, 2, 8, graph_width, "Ancho de Banda en Tiempo Real");
-            
-            // Dibujar gráfico simple de barras
-            int bars_width = graph_width - 4; // Ancho menos los bordes internos
-            int graph_height = 4;
-            double max_speed = bandwidth_graph.max_value > 0 ? bandwidth_graph.max_value : 10.0;
-            
-            // Dibujar barras del gráfico
-            for (int i = 0; i < bars_width; i++) {
-                int data_index = (bandwidth_graph.current_index - bars_width + i + bandwidth_graph.max_values) % bandwidth_graph.max_values;
-                double value = bandwidth_graph.values[data_index];
-                
-                if (max_speed > 0) {
-                    int bar_height = (int)((value / max_speed) * graph_height);
-                    if (bar_height > graph_height) bar_height = graph_height;
-                    
-                    // Color según el valor
-                    if (value > max_speed * 0.8) {
-                        attron(COLOR_PAIR(COLOR_ERROR));
-                    } else if (value > max_speed * 0.5) {
-                        attron(COLOR_PAIR(COLOR_WARNING));
-                    } else {
-                        attron(COLOR_PAIR(COLOR_SUCCESS));
-                    }
-                    
-                    // Dibujar barra
-                    for (int j = 0; j < bar_height; j++) {
-                        mvaddch(6 - j, 4 + i, '#');
-                    }
-                    attroff(COLOR_PAIR(COLOR_ERROR) | COLOR_PAIR(COLOR_WARNING) | COLOR_PAIR(COLOR_SUCCESS));
-                }
+
+            int bar_height = (int)((value / max_speed) * graph_height);
+            if (bar_height > graph_height) bar_height = graph_height;
+
+            // Color según el valor
+            if (value > max_speed * 0.8) {
+                attron(COLOR_PAIR(COLOR_ERROR));
+            } else if (value > max_speed * 0.5) {
+                attron(COLOR_PAIR(COLOR_WARNING));
+            } else {
+                attron(COLOR_PAIR(COLOR_SUCCESS));
             }
-            
-            // Mostrar valor máximo
-            mvprintw(8, 4, "Max: %.1f MB/s", max_speed);
-        }
-        
-        // ========================================
-        // SECCIÓN MEDIA: INFORMACIÓN DE INTERFAZ
-        // ========================================
-        
-        int info_width = COLS - 4; // Todo el ancho menos los bordes
-        draw_box(11, 2, 6, info_width, "Información de Interfaz");
-        
-        // Información de la interfaz
-        attron(COLOR_PAIR(COLOR_INFO));
-        mvprintw(12, 4, "Interfaz: %s", current_interface);
-        attroff(COLOR_PAIR(COLOR_INFO));
-        
-        // IP local con color rojo
-        char* interface_ip = get_interface_ip(current_interface);
-        if (interface_ip) {
-            attron(COLOR_PAIR(COLOR_ERROR) | A_BOLD);
-            mvprintw(12, 35, "IP Local: %s", interface_ip);
-            attroff(COLOR_PAIR(COLOR_ERROR) | A_BOLD);
-            free(interface_ip);
+
+            // Dibujar barra
+            for (int j = 0; j < bar_height; j++) {
+                mvaddch(6 - j, 4 + i, '#');
+            }
+            attroff(COLOR_PAIR(COLOR_ERROR) | COLOR_PAIR(COLOR_WARNING) | COLOR_PAIR(COLOR_SUCCESS));
         }
-        
-        // Bytes totales
-        mvprintw(13, 4, "Bytes recibidos: %s", format_bytes(current_stats.rx_bytes));
-        mvprintw(13, 35, "Bytes enviados: %s", format_bytes(current_stats.tx_bytes));
-        
-        // Paquetes
-        mvprintw(14, 4, "Paquetes recibidos: %lu", current_stats.rx_packets);
-        mvprintw(14, 35, "Paquetes enviados: %lu", current_stats.tx_packets);
-        
-        // Velocidades actuales destacadas
-        attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-        mvprintw(15, 4, "Velocidad de DESCARGA actual: %s", format_speed(current_stats.rx_speed));
-        attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-        
-        attron(COLOR_PAIR(COLOR_SUCCESS) | A_BOLD);
-        mvprintw(16, 4, "Velocidad de SUBIDA actual:   %s", format_speed(current_stats.tx_speed));
-        attroff(COLOR_PAIR(COLOR_SUCCESS) | A_BOLD);
-        
-    } else {
-        mvprintw(3, 4, "No se encontró interfaz activa");
+
+        // Mostrar valor máximo y resolución
+        double span = (double)bars_width * bandwidth_rollup.tiers[graph_tier].resolution_ns / NS_PER_SECOND;
+        mvprintw(8, 4, "Max: %.1f MB/s   Zoom [+/-]: %s por columna, últimos %.1f %s", max_speed,
+                 rollup_tier_name(graph_tier),
+                 span >= 86400 ? span / 86400 : span >= 3600 ? span / 3600 : span / 60,
+                 span >= 86400 ? "días" : span >= 3600 ? "h" : "min");
     }
+
+    // ========================================
+    // SECCIÓN MEDIA: INFORMACIÓN DE INTERFAZ
+    // ========================================
+
+    // Solo los valores mostrados: con la interfaz parada no se redibuja nada
+    hash = hash_bytes(HASH_SEED, snapshot->interface, sizeof(snapshot->interface));
+    hash = hash_bytes(hash, snapshot->interface_ip, sizeof(snapshot->interface_ip));
+    hash = hash_bytes(hash, &current_stats->rx_bytes, sizeof(current_stats->rx_bytes));
+    hash = hash_bytes(hash, &current_stats->tx_bytes, sizeof(current_stats->tx_bytes));
+    hash = hash_bytes(hash, &current_stats->rx_packets, sizeof(current_stats->rx_packets));
+    hash = hash_bytes(hash, &current_stats->tx_packets, sizeof(current_stats->tx_packets));
+    hash = hash_bytes(hash, &current_stats->rx_speed, sizeof(current_stats->rx_speed));
+    hash = hash_bytes(hash, &current_stats->tx_speed, sizeof(current_stats->tx_speed));
+    if (!section_dirty(UI_INFO, hash)) {
+        return;
+    }
+    clear_area(12, 3, 5, graph_width - 2);
+
+    // Información de la interfaz
+    attron(COLOR_PAIR(COLOR_INFO));
+    mvprintw(12, 4, "Interfaz: %s", snapshot->interface);
+    attroff(COLOR_PAIR(COLOR_INFO));
+
+    // IP local con color rojo
+    if (snapshot->interface_ip[0]) {
+        attron(COLOR_PAIR(COLOR_ERROR) | A_BOLD);
+        mvprintw(12, 35, "IP Local: %s", snapshot->interface_ip);
+        attroff(COLOR_PAIR(COLOR_ERROR) | A_BOLD);
+    }
+
+    // Bytes totales
+    char formatted[MAX_FORMATTED];
+    mvprintw(13, 4, "Bytes recibidos: %s", format_bytes(current_stats->rx_bytes, formatted, sizeof(formatted)));
+    mvprintw(13, 35, "Bytes enviados: %s", format_bytes(current_stats->tx_bytes, formatted, sizeof(formatted)));
+
+    // Paquetes
+    mvprintw(14, 4, "Paquetes recibidos: %lu", current_stats->rx_packets);
+    mvprintw(14, 35, "Paquetes enviados: %lu", current_stats->tx_packets);
+
+    // Velocidades actuales destacadas
+    attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
+    mvprintw(15, 4, "Velocidad de DESCARGA actual: %s", format_speed(current_stats->rx_speed, formatted, sizeof(formatted)));
+    attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
+
+    attron(COLOR_PAIR(COLOR_SUCCESS) | A_BOLD);
+    mvprintw(16, 4, "Velocidad de SUBIDA actual:   %s", format_speed(current_stats->tx_speed, formatted, sizeof(formatted)));
+    attroff(COLOR_PAIR(COLOR_SUCCESS) | A_BOLD);
 }
 
 // Dibujar sección de conexiones
 void draw_connections_section(void) {
-    connections_count = get_connection_count();
-    processes_count = get_active_processes();
-    
+    if (!snapshot) {
+        return;
+    }
+
     // ========================================
     // SECCIÓN DE CONEXIONES ACTIVAS
     // ========================================
-    
-    int conn_width = COLS - 4; // Todo el ancho menos los bordes
-    draw_box(18, 2, 9, conn_width, "Conexiones Activas");
-    
-    // Headers de la tabla
-    attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-    mvprintw(19, 4, "Puerto");
-    mvprintw(19, 12, "Estado");
-    mvprintw(19, 20, "Proceso");
-    mvprintw(19, 40, "IP Remota");
-    mvprintw(19, 55, "Bytes");
-    attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-    
-    // Línea separadora
-    for (int i = 4; i < COLS - 6; i++) {
-        mvaddch(20, i, '-');
+
+    // Las marcas de tiempo de lectura no se muestran: no cuentan como cambio
+    uint64_t hash = hash_bytes(HASH_SEED, &snapshot->tcp_connections, sizeof(snapshot->tcp_connections));
+    hash = hash_bytes(hash, &snapshot->processes, sizeof(snapshot->processes));
+    int rows = snapshot->connection_count < CONNECTION_ROWS ? snapshot->connection_count : CONNECTION_ROWS;
+    for (int i = 0; i < rows; i++) {
+        hash = hash_bytes(hash, &snapshot->connections[i], offsetof(Connection, timestamp_ns));
     }
-    
-    // Datos de conexiones (ejemplo por ahora)
-    mvprintw(21, 4, "80");
-    mvprintw(21, 12, "LISTEN");
-    attron(COLOR_PAIR(COLOR_SUCCESS));
-    mvprintw(21, 20, "nginx");
-    attroff(COLOR_PAIR(COLOR_SUCCESS));
-    mvprintw(21, 40, "0.0.0.0");
-    mvprintw(21, 55, "2.1M");
-    
-    mvprintw(22, 4, "443");
-    mvprintw(22, 12, "LISTEN");
-    attron(COLOR_PAIR(COLOR_SUCCESS));
-    mvprintw(22, 20, "nginx");
-    attroff(COLOR_PAIR(COLOR_SUCCESS));
-    mvprintw(22, 40, "0.0.0.0");
-    mvprintw(22, 55, "1.8M");
-    
-    mvprintw(23, 4, "8080");
-    mvprintw(23, 12, "ESTAB");
-    attron(COLOR_PAIR(COLOR_INFO));
-    mvprintw(23, 20, "node");
-    attroff(COLOR_PAIR(COLOR_INFO));
-    mvprintw(23, 40, "192.168.1.5");
-    mvprintw(23, 55, "950K");
-    
-    mvprintw(24, 4, "22");
-    mvprintw(24, 12, "ESTAB");
-    attron(COLOR_PAIR(COLOR_WARNING));
-    mvprintw(24, 20, "ssh");
-    attroff(COLOR_PAIR(COLOR_WARNING));
-    mvprintw(24, 40, "192.168.1.10");
-    mvprintw(24, 55, "45K");
-    
-    mvprintw(25, 4, "53");
-    mvprintw(25, 12, "ESTAB");
-    attron(COLOR_PAIR(COLOR_INFO));
-    mvprintw(25, 20, "systemd-resolve");
-    attroff(COLOR_PAIR(COLOR_INFO));
-    mvprintw(25, 40, "8.8.8.8");
-    mvprintw(25, 55, "12K");
-    
+    if (!section_dirty(UI_CONNECTIONS, hash)) {
+        return;
+    }
+    clear_area(21, 3, 6, COLS - 6);
+
+    // Conexiones reales con su proceso propietario
+    for (int i = 0; i < rows; i++) {
+        const Connection* conn = &snapshot->connections[i];
+        char remote_ip[MAX_IP_ADDRESS];
+        int color = conn->state == CONN_STATE_LISTEN ? COLOR_SUCCESS :
+                    (conn->state == CONN_STATE_ESTABLISHED ? COLOR_INFO : COLOR_WARNING);
+
+        mvprintw(21 + i, 4, "%d", conn->local_port);
+        mvprintw(21 + i, 12, "%.12s", conn->protocol == IPPROTO_UDP ? "UDP" : connection_state_name(conn->state));
+        attron(COLOR_PAIR(color));
+        mvprintw(21 + i, 25, "%.16s", conn->pid > 0 ? conn->process : "-");
+        attroff(COLOR_PAIR(color));
+        mvprintw(21 + i, 42, "%.23s", format_ip_address(conn->family, conn->remote_addr, remote_ip, sizeof(remote_ip)));
+        if (conn->pid > 0) {
+            mvprintw(21 + i, 66, "%d", conn->pid);
+        } else {
+            mvprintw(21 + i, 66, "-");
+        }
+    }
+
     // Estadísticas en la parte inferior
     attron(COLOR_PAIR(COLOR_INFO));
-    mvprintw(26, 4, "Total conexiones TCP: %d", connections_count);
-    mvprintw(26, 35, "Procesos activos: %d", processes_count);
+    mvprintw(26, 4, "Total conexiones TCP: %d", snapshot->tcp_connections);
+    mvprintw(26, 35, "Procesos activos: %d", snapshot->processes);
     attroff(COLOR_PAIR(COLOR_INFO));
 }
 
@@ -387,89 +463,276 @@ void draw_interfaces_section(void) {
     // ========================================
     // SECCIÓN DE INTERFACES DE RED
     // ========================================
-    
-    int iface_width = COLS - 4; // Todo el ancho menos los bordes
-    draw_box(28, 2, 6, iface_width, "Interfaces de Red");
-    
-    int interface_count;
-    char** interfaces = get_available_interfaces(&interface_count);
-    
-    if (interfaces && interface_count > 0) {
-        mvprintw(29, 4, "Interfaces encontradas: %d", interface_count);
-        
+
+    if (!snapshot) {
+        return;
+    }
+
+    uint64_t hash = hash_bytes(HASH_SEED, &snapshot->interface_count, sizeof(snapshot->interface_count));
+    for (int i = 0; i < snapshot->interface_count && i < 3; i++) {
+        hash = hash_bytes(hash, snapshot->interfaces[i], sizeof(snapshot->interfaces[i]));
+        hash = hash_bytes(hash, &snapshot->interface_active[i], sizeof(snapshot->interface_active[i]));
+    }
+    if (!section_dirty(UI_INTERFACES, hash)) {
+        return;
+    }
+    int iface_width = COLS >= LATENCY_MIN_COLS ? COLS / 2 - 3 : COLS - 4;
+    clear_area(29, 3, 5, iface_width - 2);
+
+    if (snapshot->interface_count > 0) {
+        mvprintw(29, 4, "Interfaces encontradas: %d", snapshot->interface_count);
+
         // Mostrar interfaces activas
-        int line_count = 0;
-        for (int i = 0; i < interface_count && i < 3; i++) {
-            if (interfaces[i]) {
-                int is_active = is_interface_active(interfaces[i]);
-                if (is_active) {
-                    attron(COLOR_PAIR(COLOR_SUCCESS));
-                    mvprintw(30 + line_count, 4, "* %s = activa", interfaces[i]);
-                    attroff(COLOR_PAIR(COLOR_SUCCESS));
-                } else {
-                    attron(COLOR_PAIR(COLOR_WARNING));
-                    mvprintw(30 + line_count, 4, "o %s = inactiva", interfaces[i]);
-                    attroff(COLOR_PAIR(COLOR_WARNING));
-                }
-                line_count++;
+        for (int i = 0; i < snapshot->interface_count && i < 3; i++) {
+            if (snapshot->interface_active[i]) {
+                attron(COLOR_PAIR(COLOR_SUCCESS));
+                mvprintw(30 + i, 4, "* %s = activa", snapshot->interfaces[i]);
+                attroff(COLOR_PAIR(COLOR_SUCCESS));
+            } else {
+                attron(COLOR_PAIR(COLOR_WARNING));
+                mvprintw(30 + i, 4, "o %s = inactiva", snapshot->interfaces[i]);
+                attroff(COLOR_PAIR(COLOR_WARNING));
             }
         }
-        
+
         // Información adicional
         mvprintw(33, 4, "* = Activa  o = Inactiva");
-        
-        // Liberar memoria
-        for (int i = 0; i < interface_count; i++) {
-            if (interfaces[i]) {
-                free(interfaces[i]);
-            }
-        }
-        free(interfaces);
     } else {
         mvprintw(29, 4, "No se encontraron interfaces de red");
     }
 }
 
+// Dibujar sección de latencia: bandas de percentiles y, si cabe, su distribución
+void draw_latency_section(void) {
+    if (!snapshot || snapshot->latency_count == 0) {
+        return;
+    }
+
+    // Los resultados solo cambian cuando termina una ronda de sondas
+    uint64_t collected = snapshot->collected_ns[SAMPLE_LATENCY];
+    if (!section_dirty(UI_LATENCY, hash_bytes(HASH_SEED, &collected, sizeof(collected)))) {
+        return;
+    }
+
+    if (COLS >= LATENCY_MIN_COLS) {
+        int count = snapshot->latency_count < 4 ? snapshot->latency_count : 4;
+        clear_area(28, COLS / 2, 6, COLS - COLS / 2 - 2);
+        draw_latency_bars(28, COLS / 2, COLS - COLS / 2 - 2, snapshot->latency, count);
+    }
+
+    if (LINES >= LATENCY_HISTOGRAM_MIN_LINES && snapshot->latency_bins > 0) {
+        char title[64];
+        snprintf(title, sizeof(title), "Distribución de latencia (hasta %.1f ms, escala log)",
+                 snapshot->latency_max_ms);
+        clear_area(36, 2, 6, COLS - 4);
+        draw_histogram(36, 2, 4, COLS - 6, (double*)snapshot->latency_distribution,
+                       snapshot->latency_bins, title);
+    }
+}
+
+// Ajustar ncurses al tamaño nuevo de la terminal (SIGWINCH llega por signalfd, así
+// que el manejador de ncurses no se ejecuta y hay que hacerlo aquí)
+static void resize_terminal(void) {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        resizeterm(size.ws_row, size.ws_col);
+    }
+    clearok(curscr, TRUE);   // el contenido de la terminal tras redimensionar no es fiable
+}
+
+// Fuente de la muestra: la copia del segmento del daemon o el triple buffer propio
+static const Snapshot* acquire_snapshot(void) {
+    if (!attached) {
+        return sampler_acquire(&sampler);
+    }
+    shared_read(&shared, &shared_copy);
+    return shared_copy.sequence ? &shared_copy : NULL;
+}
+
+static void release_snapshot(void) {
+    if (!attached) {
+        sampler_release(&sampler);
+    }
+}
+
+// Dibujar un fotograma de la muestra dada (run_tui y bench_proc)
+int draw_frame(const Snapshot* frame, int chrome) {
+    uint64_t start = monotonic_ns();
+    
+    // Sin werase por fotograma: el marco se queda y cada sección se redibuja solo si
+    // cambiaron sus valores
+    snapshot = frame;
+    if (chrome) {
+        draw_chrome();
+    }
+    sections_drawn = 0;
+    draw_bandwidth_section();
+    draw_connections_section();
+    draw_interfaces_section();
+    draw_latency_section();
+    draw_stats_section();
+    
+    // doupdate() solo envía a la terminal las celdas que difieren de la pantalla
+    wnoutrefresh(stdscr);
+    doupdate();
+    
+    frame_ms = elapsed_seconds(start, monotonic_ns()) * 1000.0;
+    return sections_drawn;
+}
+
 // Función principal de la interfaz TUI
 void run_tui(void) {
+    // Bloquear SIGWINCH antes de crear el hilo de muestreo: ningún hilo la recibe por
+    // manejador y el bucle la lee de un signalfd como un evento más
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    
     init_ui();
     
+    // La recolección (netlink, /proc, popen) vive en su propio hilo, salvo que ya la
+    // haga un daemon: entonces solo se lee su segmento compartido
+    char shared_name[64];
+    attached = shared_default_name(shared_name, sizeof(shared_name)) == 0 &&
+               shared_attach(&shared, shared_name) == 0;
+    if (!attached && sampler_start(&sampler, REFRESH_RATE) < 0) {
+        cleanup_ui();
+        fprintf(stderr, "No se pudo iniciar el hilo de muestreo\n");
+        return;
+    }
+    
+    // Un solo poll() sobre todo lo que puede cambiar la pantalla: teclas, muestras
+    // nuevas, el tick de la línea de estado y el cambio de tamaño. Entre eventos el
+    // proceso duerme (0% de CPU) y una tecla se atiende al momento. El daemon no
+    // avisa a sus visores: con él, el tick mira la secuencia cada SHARED_POLL_MS
+    int signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    int tick_fd = ticker_open(attached ? SHARED_POLL_MS : TUI_TICK_MS);
+    struct pollfd fds[4] = {
+        { STDIN_FILENO, POLLIN, 0 },
+        { attached ? -1 : sampler_publish_fd(&sampler), POLLIN, 0 },
+        { tick_fd, POLLIN, 0 },         // poll ignora los descriptores negativos
+        { signal_fd, POLLIN, 0 },
+    };
+    
+    uint64_t drawn_sequence = 0;
+    int redraw = 1;
+    int chrome = 1;
+    int running = 1;
     int ch;
-    while (1) {
-        // Limpiar pantalla de manera más eficiente
-        werase(stdscr);
+    while (running) {
+        snapshot = acquire_snapshot();
+        uint64_t sequence = snapshot ? snapshot->sequence : 0;
         
-        // Dibujar interfaz
-        draw_header();
-        draw_bandwidth_section();
-        draw_connections_section();
-        draw_interfaces_section();
-        draw_footer();
+        // Dibujar solo con muestra nueva, tick o tecla: el fotograma solo lee memoria
+        if (chrome || redraw || sequence != drawn_sequence) {
+            draw_frame(snapshot, chrome);
+            chrome = 0;
+            drawn_sequence = sequence;
+            redraw = 0;
+        }
         
-        // Usar doble buffer para actualización sin parpadeo
-        wnoutrefresh(stdscr);
-        doupdate();
+        release_snapshot();
+        snapshot = NULL;
         
-        // Manejar input
-        ch = getch();
-        if (ch == 'q' || ch == 'Q') {
+        if (poll(fds, 4, -1) < 0) {
+            if (errno == EINTR) continue;
             break;
         }
-        else if (ch == 'r' || ch == 'R') {
-            // Actualizar datos
+        if (fds[1].revents & POLLIN) {
+            sampler_drain(&sampler);
+        }
+        if (fds[2].revents & POLLIN) {
+            ticker_wait(tick_fd);
+            redraw = 1;
+            
+            // Si el daemon termina, seguir con un hilo de muestreo propio
+            if (attached && !shared_alive(&shared) && sampler_start(&sampler, REFRESH_RATE) == 0) {
+                shared_close(&shared);
+                attached = 0;
+                ticker_close(tick_fd);
+                tick_fd = ticker_open(TUI_TICK_MS);
+                fds[1].fd = sampler_publish_fd(&sampler);
+                fds[2].fd = tick_fd;
+            }
+        }
+        if (fds[3].revents & POLLIN) {
+            struct signalfd_siginfo info;
+            while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+                // varias señales seguidas equivalen a un solo cambio de tamaño
+            }
+            resize_terminal();
+            chrome = 1;
+        }
+        if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+            break;   // terminal cerrada
+        }
+        if (!(fds[0].revents & POLLIN)) {
             continue;
         }
         
-        
-        sleep(1);  
+        // Manejar todas las teclas pendientes (getch() no bloquea)
+        while (running && (ch = getch()) != ERR) {
+            if (ch == 'q' || ch == 'Q') {
+                running = 0;
+            }
+            else if ((ch == 'r' || ch == 'R') && !attached) {
+                sampler_refresh(&sampler);
+            }
+            else if (ch == '+' && graph_tier < ROLLUP_TIERS - 1) {
+                graph_tier++;
+            }
+            else if (ch == '-' && graph_tier > 0) {
+                graph_tier--;
+            }
+            else if (ch == KEY_RESIZE) {
+                chrome = 1;
+            }
+            redraw = 1;
+        }
     }
     
+    ticker_close(tick_fd);
+    if (signal_fd >= 0) close(signal_fd);
+    if (attached) {
+        shared_close(&shared);
+        attached = 0;
+    } else {
+        sampler_stop(&sampler);
+    }
     cleanup_ui();
+    pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
 }
 
 // Funciones placeholder para completar la API
 void draw_stats_section(void) {
-    // TODO: Implementar sección de estadísticas
+    if (!snapshot || 35 >= LINES - 2) {
+        return;
+    }
+    
+    // Cada sección tiene su propio periodo: mostrar la antigüedad de lo que se dibuja.
+    // En segundos enteros, para no reescribir la línea con cada muestra publicada; el
+    // resto de campos se actualiza cuando se redibuja alguna otra sección
+    int ages[3] = {
+        (int)snapshot_age(snapshot, SAMPLE_LINKS),
+        (int)snapshot_age(snapshot, SAMPLE_SOCKETS),
+        (int)snapshot_age(snapshot, SAMPLE_PROCESSES)
+    };
+    int others = sections_drawn;
+    if (!section_dirty(UI_STATUS, hash_bytes(HASH_SEED, ages, sizeof(ages))) && others == 0) {
+        return;
+    }
+    
+    // Recortada al ancho: si pasara a la fila siguiente pisaría la distribución de latencia
+    char line[256];
+    snprintf(line, sizeof(line), "%sMuestra #%lu (dibujo %.2f ms, %d secciones, %lu syscalls procfs). Edad: enlaces %d s, sockets %d s, procesos %d s",
+             attached ? "[daemon] " : "", (unsigned long)snapshot->sequence, frame_ms, others, (unsigned long)snapshot->proc_syscalls,
+             ages[0], ages[1], ages[2]);
+    attron(COLOR_PAIR(COLOR_INFO));
+    move(35, 4);
+    clrtoeol();
+    mvaddnstr(35, 4, line, COLS - 6);
+    attroff(COLOR_PAIR(COLOR_INFO));
 }
 
 void update_bandwidth_data(void) {
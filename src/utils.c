@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include "utils.h"
+#include "procnet.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,6 +13,8 @@
 #include <net/if.h>
 #include <sys/ioctl.h>
 #include <sys/wait.h>
+#include <sys/timerfd.h>
+#include <errno.h>
 
 // Definir IFNAMSIZ si no está definido
 #ifndef IFNAMSIZ
@@ -27,36 +30,32 @@ double bytes_to_mbps(uint64_t bytes, double time_diff) {
     return mb / time_diff;
 }
 
-// Formatear velocidad para mostrar
-char* format_speed(double speed) {
-    static char buffer[32];
-    
+// Formatear velocidad (MB/s) en el buffer del llamador
+char* format_speed(double speed, char* buffer, int size) {
     if (speed < 1.0) {
         // Mostrar en KB/s
-        snprintf(buffer, sizeof(buffer), "%.2f KB/s", speed * 1024.0);
+        snprintf(buffer, size, "%.2f KB/s", speed * 1024.0);
     } else if (speed < 1024.0) {
         // Mostrar en MB/s
-        snprintf(buffer, sizeof(buffer), "%.2f MB/s", speed);
+        snprintf(buffer, size, "%.2f MB/s", speed);
     } else {
         // Mostrar en GB/s
-        snprintf(buffer, sizeof(buffer), "%.2f GB/s", speed / 1024.0);
+        snprintf(buffer, size, "%.2f GB/s", speed / 1024.0);
     }
     
     return buffer;
 }
 
-// Formatear bytes para mostrar
-char* format_bytes(uint64_t bytes) {
-    static char buffer[32];
-    
+// Formatear bytes en el buffer del llamador
+char* format_bytes(uint64_t bytes, char* buffer, int size) {
     if (bytes < 1024) {
-        snprintf(buffer, sizeof(buffer), "%lu B", bytes);
+        snprintf(buffer, size, "%lu B", bytes);
     } else if (bytes < 1024 * 1024) {
-        snprintf(buffer, sizeof(buffer), "%.1f KB", (double)bytes / 1024.0);
+        snprintf(buffer, size, "%.1f KB", (double)bytes / 1024.0);
     } else if (bytes < 1024 * 1024 * 1024) {
-        snprintf(buffer, sizeof(buffer), "%.1f MB", (double)bytes / (1024.0 * 1024.0));
+        snprintf(buffer, size, "%.1f MB", (double)bytes / (1024.0 * 1024.0));
     } else {
-        snprintf(buffer, sizeof(buffer), "%.1f GB", (double)bytes / (1024.0 * 1024.0 * 1024.0));
+        snprintf(buffer, size, "%.1f GB", (double)bytes / (1024.0 * 1024.0 * 1024.0));
     }
     
     return buffer;
@@ -66,26 +65,18 @@ char* format_bytes(uint64_t bytes) {
 char* get_process_name(int pid) {
     static char process_name[MAX_PROCESS_NAME];
     char path[256];
-    FILE* file;
     
-    // Construir ruta al archivo comm del proceso
+    // Construir ruta al archivo comm del proceso (se mantiene abierto en el registro)
     snprintf(path, sizeof(path), "/proc/%d/comm", pid);
     
-    file = fopen(path, "r");
-    if (!file) {
+    const char* comm = proc_registry_read(proc_registry_shared(), path, NULL);
+    if (!comm || !*comm) {
         snprintf(process_name, sizeof(process_name), "unknown");
         return process_name;
     }
     
-    // Leer nombre del proceso
-    if (fgets(process_name, sizeof(process_name), file)) {
-        // Eliminar salto de línea
-        process_name[strcspn(process_name, "\n")] = '\0';
-    } else {
-        snprintf(process_name, sizeof(process_name), "unknown");
-    }
-    
-    fclose(file);
+    // Copiar sin el salto de línea
+    snprintf(process_name, sizeof(process_name), "%.*s", (int)strcspn(comm, "\n"), comm);
     return process_name;
 }
 
@@ -100,37 +91,100 @@ char* get_interface_name(void) {
     return interface_name;
 }
 
-// Obtener IP de una interfaz (real, usando comando ip)
-char* get_interface_ip(const char* interface) {
-    char* ip = malloc(32); // Suficiente para una IP
-    if (!ip) return NULL;
-    ip[0] = '\0';
-
-    char command[256];
-    snprintf(command, sizeof(command), "ip -4 addr show %s | grep 'inet ' | awk '{print $2}' | cut -d'/' -f1", interface);
-    FILE* fp = popen(command, "r");
-    if (fp) {
-        if (fgets(ip, 32, fp) != NULL) {
-            ip[strcspn(ip, "\n")] = 0;
-        } else {
-            strcpy(ip, "No disponible");
-        }
-        pclose(fp);
-    } else {
-        strcpy(ip, "No disponible");
-    }
-    return ip;
-}
-
 // Obtener timestamp actual
 time_t get_current_timestamp(void) {
     return time(NULL);
 }
 
-// Dormir por milisegundos
+// Dormir por milisegundos (reanudando si una señal interrumpe la espera)
 void sleep_ms(int milliseconds) {
-   
-    if (milliseconds >= 1000) {
-        sleep(milliseconds / 1000);
+    struct timespec remaining;
+    remaining.tv_sec = milliseconds / 1000;
+    remaining.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+    
+    while (nanosleep(&remaining, &remaining) < 0 && errno == EINTR) {
+    }
+}
+
+uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SECOND + (uint64_t)ts.tv_nsec;
+}
+
+double elapsed_seconds(uint64_t start_ns, uint64_t end_ns) {
+    return end_ns > start_ns ? (double)(end_ns - start_ns) / NS_PER_SECOND : 0.0;
+}
+
+int ticker_open(int period_ms) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = period_ms / 1000;
+    spec.it_interval.tv_nsec = (long)(period_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(fd, 0, &spec, NULL) < 0) {
+        close(fd);
+        return -1;
     }
-} 
\ No newline at end of file
+    return fd;
+}
+
+uint64_t ticker_wait(int fd) {
+    uint64_t expirations = 0;
+    while (read(fd, &expirations, sizeof(expirations)) < 0) {
+        if (errno != EINTR) {
+            return 0;
+        }
+    }
+    return expirations;
+}
+
+void ticker_close(int fd) {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Reservar una entrada nueva al final de la lista, duplicando la capacidad si hace falta
+Connection* connection_list_append(ConnectionList* list) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 1024;
+        Connection* items = realloc(list->items, capacity * sizeof(Connection));
+        if (!items) return NULL;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    return &list->items[list->count++];
+}
+
+// Nombre de un estado TCP del kernel
+const char* connection_state_name(int state) {
+    static const char* names[] = {
+        "UNKNOWN", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2",
+        "TIME_WAIT", "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING", "SYN_RECV"
+    };
+    if (state < 0 || state >= (int)(sizeof(names) / sizeof(names[0]))) {
+        return "UNKNOWN";
+    }
+    return names[state];
+}
+
+// Nombre del protocolo de una conexión (tcp, tcp6, udp, udp6)
+const char* connection_protocol_name(const Connection* conn) {
+    if (conn->protocol == IPPROTO_UDP) {
+        return conn->family == AF_INET6 ? "udp6" : "udp";
+    }
+    return conn->family == AF_INET6 ? "tcp6" : "tcp";
+}
+
+// Formatear una dirección binaria en el buffer del llamador
+char* format_ip_address(int family, const uint8_t* addr, char* buffer, int size) {
+    if (!inet_ntop(family, addr, buffer, size)) {
+        snprintf(buffer, size, "?");
+    }
+    return buffer;
+}
\ No newline at end of file